@@ -21,6 +21,22 @@
 
 #include "SDL4Cpp_main.h"
 #include "SDL4Cpp_video.h"
+#include "SDL4Cpp_indexed.h"
+#include "SDL4Cpp_cache.h"
+#include "SDL4Cpp_mapped.h"
+#include "SDL4Cpp_pack.h"
+#include "SDL4Cpp_record.h"
+#include "SDL4Cpp_draw.h"
+#include "SDL4Cpp_sprite.h"
+#include "SDL4Cpp_render.h"
+#include "SDL4Cpp_compositor.h"
+#include "SDL4Cpp_scroll.h"
+#include "SDL4Cpp_collide.h"
+#include "SDL4Cpp_filter.h"
+#include "SDL4Cpp_color.h"
+#include "SDL4Cpp_mipmap.h"
+#include "SDL4Cpp_tiled.h"
+#include "SDL4Cpp_texture.h"
 #include "SDL4Cpp_events.h"
 #include "SDL4Cpp_joystick.h"
 #include "SDL4Cpp_mouse.h"
@@ -0,0 +1,255 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SDL4CPP_CACHE_H
+#define SDL4CPP_CACHE_H
+
+#include <list>
+#include <map>
+#include <string>
+#include "SDL4Cpp_video.h"
+
+namespace SDL
+{
+	/*!
+	 * \addtogroup Video
+	 */
+	//@{
+
+	/*!
+	 * \brief Keeps loaded Surfaces around so a file is only decoded once.
+	 *
+	 * Surfaces are looked up by their (normalized) path and the Conversion
+	 * done after loading. A hit hands out the same SDL_Surface again with its
+	 * reference count bumped, so every Surface given out by the cache shares
+	 * the pixels. Treat them as read-only; make a copy to draw on one.
+	 *
+	 * The cache holds on to at most GetBudget() bytes of pixel data. When a
+	 * load goes over the budget the least recently used Surfaces that aren't
+	 * pinned are dropped from the cache. A dropped Surface stays alive for as
+	 * long as anything else still holds it.
+	 *
+	 * \code
+	 * SDL::AssetCache cache(16 * 1024 * 1024);
+	 * SDL::Surface ball;
+	 *
+	 * if(!cache.Load("ball.bmp", ball))
+	 *	cout << SDL::GetError() << endl;
+	 * \endcode
+	 *
+	 * Files are loaded with SDL_LoadBMP unless another loader is set, for
+	 * instance SetLoader(IMG_Load) to go through SDL_image.
+	 *
+	 * \note The cache isn't thread safe.
+	 */
+	class AssetCache
+	{
+		public:
+			/*!
+			 * \brief A function that loads file, like IMG_Load.
+			 *
+			 * \return The new surface, or NULL with the SDL error set.
+			 */
+			typedef SDL_Surface *(*Loader)(const char *file);
+
+			/*!
+			 * \brief Create a cache holding at most budget bytes.
+			 */
+			explicit AssetCache(Uint32 budget = 32 * 1024 * 1024);
+
+			/*!
+			 * \brief Destructor.
+			 *
+			 * Drops every Surface, pinned or not.
+			 */
+			~AssetCache();
+
+			/*!
+			 * \brief Get file into surface, loading it only if needed.
+			 *
+			 * \return True on success, False if the file couldn't be loaded
+			 * or converted.
+			 */
+			bool Load(std::string file, Surface &surface,
+					  Conversion convert = ConvertNone);
+
+			/*!
+			 * \brief Keep file in the cache no matter the budget.
+			 *
+			 * Loads the file if it isn't cached yet. Pins nest, so every
+			 * Pin() needs an Unpin().
+			 *
+			 * \return True on success, False if the file couldn't be loaded.
+			 */
+			bool Pin(std::string file, Conversion convert = ConvertNone);
+
+			/*!
+			 * \brief Undo a Pin().
+			 *
+			 * Once the last pin is gone the Surface can be evicted right
+			 * away if the cache is over budget.
+			 *
+			 * \return False if file wasn't pinned.
+			 */
+			bool Unpin(std::string file, Conversion convert = ConvertNone);
+
+			/*!
+			 * \brief Check if file is cached, without touching the counters.
+			 */
+			bool Contains(std::string file, Conversion convert = ConvertNone);
+
+			/*!
+			 * \brief Drop file from the cache, even if it's pinned.
+			 *
+			 * \return False if it wasn't cached.
+			 */
+			bool Remove(std::string file, Conversion convert = ConvertNone);
+
+			/*!
+			 * \brief Drop every Surface that isn't pinned.
+			 */
+			void Clear();
+
+			/*!
+			 * \brief Change the budget, evicting Surfaces to fit if needed.
+			 */
+			void SetBudget(Uint32 budget);
+
+			/*!
+			 * \return The budget in bytes.
+			 */
+			Uint32 GetBudget();
+
+			/*!
+			 * \return The bytes of pixel data currently held.
+			 */
+			Uint32 GetUsage();
+
+			/*!
+			 * \return The number of cached Surfaces.
+			 */
+			int GetCount();
+
+			/*!
+			 * \brief Set the function used to load files.
+			 *
+			 * Already cached Surfaces are kept. NULL restores SDL_LoadBMP.
+			 */
+			void SetLoader(Loader loader);
+
+			/*!
+			 * \return Loads that were found in the cache.
+			 */
+			Uint32 GetHits();
+
+			/*!
+			 * \return Loads that had to go to disk.
+			 */
+			Uint32 GetMisses();
+
+			/*!
+			 * \return Surfaces dropped to stay under the budget.
+			 */
+			Uint32 GetEvictions();
+
+			/*!
+			 * \brief Set the hit, miss and eviction counters back to 0.
+			 */
+			void ResetCounters();
+
+			/*!
+			 * \brief Normalize a path the way the cache does for lookups.
+			 *
+			 * Backslashes become slashes, and empty, "." and ".." parts
+			 * are folded away where possible. The file system isn't
+			 * touched, so symlinks aren't resolved.
+			 */
+			static std::string NormalizePath(std::string path);
+		protected:
+			/*!
+			 * \brief A cached Surface.
+			 */
+			struct Entry
+			{
+				Entry() : key(), surface(NULL), bytes(0), pins(0)
+				{
+				}
+
+				/*! Copies share surface, which the cache frees once */
+				Entry(const Entry &copy) :
+					key(copy.key), surface(copy.surface), bytes(copy.bytes), pins(copy.pins)
+				{
+				}
+
+				Entry &operator =(const Entry &copy)
+				{
+					key = copy.key;
+					surface = copy.surface;
+					bytes = copy.bytes;
+					pins = copy.pins;
+					return *this;
+				}
+
+				std::string key;
+				SDL_Surface *surface;
+				Uint32 bytes;
+				int pins;
+			};
+
+			typedef std::list<Entry> EntryList;
+			typedef std::map<std::string, EntryList::iterator> EntryMap;
+
+			/*!
+			 * \brief Find or load the entry for file.
+			 *
+			 * \return The entry moved to the front, or m_Entries.end().
+			 */
+			EntryList::iterator Fetch(const std::string &file,
+									  Conversion convert, bool count);
+
+			/*!
+			 * \brief Drop least recently used entries until under budget.
+			 *
+			 * If keepfront is true the front entry, which was just handed
+			 * out, is kept even if the cache stays over budget.
+			 */
+			void Evict(bool keepfront = true);
+
+			/*!
+			 * \brief Drop one entry.
+			 */
+			void Drop(EntryList::iterator entry);
+
+			static std::string MakeKey(const std::string &file,
+									   Conversion convert);
+
+			/*!
+			 * \brief Most recently used first.
+			 */
+			EntryList m_Entries;
+			EntryMap m_Index;
+			Loader m_Loader;
+			Uint32 m_Budget;
+			Uint32 m_Usage;
+			Uint32 m_Hits, m_Misses, m_Evictions;
+		private:
+			AssetCache(const AssetCache &copy);
+			AssetCache &operator =(const AssetCache &copy);
+	};
+	//@}
+}
+
+#endif
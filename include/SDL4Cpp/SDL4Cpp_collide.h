@@ -0,0 +1,211 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SDL4CPP_COLLIDE_H
+#define SDL4CPP_COLLIDE_H
+
+#include <map>
+#include <vector>
+#include "SDL4Cpp_video.h"
+
+namespace SDL
+{
+	/*!
+	 * \addtogroup Video
+	 */
+	//@{
+
+	/*!
+	 * \brief Which pixels of a Surface are solid, for pixel perfect
+	 * collisions.
+	 *
+	 * A pixel is solid unless it's the colorkey or, for surfaces with an
+	 * alpha channel or per-surface alpha, its alpha is below the threshold.
+	 * Each row is packed into 64-bit words, a bit per pixel, so testing two
+	 * masks against each other ANDs 64 pixels at a time instead of reading
+	 * pixels one by one.
+	 *
+	 * \code
+	 * SDL::CollisionMask ship(shipsurface), rock(rocksurface);
+	 *
+	 * if(ship.Collides(rock, rockx - shipx, rocky - shipy))
+	 *	Explode();
+	 * \endcode
+	 *
+	 * The mask is a copy, changing the surface afterwards doesn't change
+	 * it.
+	 */
+	class CollisionMask
+	{
+		public:
+			/*!
+			 * \brief An empty mask, which collides with nothing.
+			 */
+			CollisionMask();
+
+			/*!
+			 * \brief Build the mask of all of surface.
+			 *
+			 * \throws SDL::LogicError if surface is empty.
+			 */
+			explicit CollisionMask(Surface &surface, Uint8 threshold = 128);
+
+			/*!
+			 * \brief Build the mask of the srcrect part of surface, say one
+			 * SpriteSheet frame.
+			 *
+			 * \throws SDL::LogicError if surface is empty.
+			 */
+			CollisionMask(Surface &surface, const Rect &srcrect,
+						  Uint8 threshold = 128);
+
+			/*!
+			 * \brief Rebuild the mask from the srcrect part of surface.
+			 *
+			 * \return False if surface couldn't be locked, leaving the mask
+			 * empty.
+			 *
+			 * \throws SDL::LogicError if surface is empty.
+			 */
+			bool Build(Surface &surface, const Rect &srcrect,
+					   Uint8 threshold = 128);
+
+			int GetWidth() const;
+			int GetHeight() const;
+
+			/*!
+			 * \return True if pixel (x, y) is solid.
+			 */
+			bool Get(int x, int y) const;
+
+			/*!
+			 * \return The number of solid pixels.
+			 */
+			Uint32 GetCount() const;
+
+			/*!
+			 * \return True if any solid pixels overlap with other's upper
+			 * left corner at (dx, dy) in this mask.
+			 */
+			bool Collides(const CollisionMask &other, int dx, int dy) const;
+
+			/*!
+			 * \return The number of solid pixels that overlap with other's
+			 * upper left corner at (dx, dy) in this mask.
+			 */
+			Uint32 Overlap(const CollisionMask &other, int dx, int dy) const;
+		private:
+			/*!
+			 * \brief Walk the rows both masks cover, ANDing other into this
+			 * a word at a time.
+			 *
+			 * \return The overlapping pixels, or 1 at the first one if
+			 * count is false.
+			 */
+			Uint32 Test(const CollisionMask &other, int dx, int dy,
+						bool count) const;
+
+			int m_Width, m_Height;
+			/*! 64-bit words in each row */
+			int m_Words;
+			/*! Row by row, bit x % 64 of word x / 64 is pixel x */
+			std::vector<Uint64> m_Bits;
+	};
+
+	/*!
+	 * \brief Builds each CollisionMask only once.
+	 *
+	 * Masks are looked up by the surface, the part of it and the threshold.
+	 * The cache holds a reference to every surface it has a mask for, so a
+	 * freed surface's memory can't be reused by another one and pick up its
+	 * masks. Remove() the surface after changing its pixels.
+	 *
+	 * \code
+	 * SDL::CollisionMaskCache masks;
+	 *
+	 * const SDL::CollisionMask &a = masks.Get(sheet.GetSurface(), sheet.GetFrame(frame));
+	 * \endcode
+	 *
+	 * \note The cache isn't thread safe.
+	 */
+	class CollisionMaskCache
+	{
+		public:
+			/*!
+			 * \brief Default constructor.
+			 */
+			CollisionMaskCache();
+
+			/*!
+			 * \brief Destructor.
+			 */
+			~CollisionMaskCache();
+
+			/*!
+			 * \return The mask of all of surface, building it if needed.
+			 * It stays valid until it's removed from the cache.
+			 *
+			 * \throws SDL::LogicError if surface is empty.
+			 */
+			const CollisionMask &Get(const Surface &surface,
+									 Uint8 threshold = 128);
+
+			/*!
+			 * \return The mask of the srcrect part of surface, building it if
+			 * needed.
+			 *
+			 * \throws SDL::LogicError if surface is empty.
+			 */
+			const CollisionMask &Get(const Surface &surface,
+									 const Rect &srcrect,
+									 Uint8 threshold = 128);
+
+			/*!
+			 * \brief Drop every mask of surface.
+			 */
+			void Remove(const Surface &surface);
+
+			/*!
+			 * \brief Drop every mask.
+			 */
+			void Clear();
+
+			/*!
+			 * \return The number of masks.
+			 */
+			int GetCount() const;
+		private:
+			CollisionMaskCache(const CollisionMaskCache &copy);
+			CollisionMaskCache &operator =(const CollisionMaskCache &copy);
+
+			struct Key
+			{
+				SDL_Surface *surface;
+				Sint16 x, y;
+				Uint16 w, h;
+				Uint8 threshold;
+
+				bool operator <(const Key &key) const;
+			};
+
+			typedef std::map<Key, CollisionMask> MaskMap;
+
+			MaskMap m_Masks;
+	};
+	//@}
+}
+
+#endif
@@ -0,0 +1,119 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SDL4CPP_COLOR_H
+#define SDL4CPP_COLOR_H
+
+#include "SDL4Cpp_video.h"
+
+namespace SDL
+{
+	/*!
+	 * \addtogroup Video
+	 */
+	//@{
+
+	/*!
+	 * \brief A 4x5 matrix that transforms colors.
+	 *
+	 * Each row makes one of red, green, blue and alpha out of the old
+	 * channels and an offset:
+	 * \code
+	 * r' = m(0, 0) * r + m(0, 1) * g + m(0, 2) * b + m(0, 3) * a + m(0, 4)
+	 * \endcode
+	 * and likewise for g', b' and a' with rows 1 to 3. Channels and offsets
+	 * are from 0 to 255, and results are clamped to that.
+	 *
+	 * \code
+	 * // Flash red when hit, then fade back over a few frames
+	 * sprite.ApplyColorMatrix(SDL::ColorMatrix::Fade(red, 0.5));
+	 *
+	 * // Grayscale and darken in one pass
+	 * screen.ApplyColorMatrix(SDL::ColorMatrix::BrightnessContrast(-0.2, 1.0) *
+	 *						   SDL::ColorMatrix::Grayscale());
+	 * \endcode
+	 *
+	 * \sa Surface::ApplyColorMatrix(), Surface::BlitColorMatrix()
+	 */
+	class ColorMatrix
+	{
+		public:
+			/*!
+			 * \brief The identity matrix, which changes nothing.
+			 */
+			ColorMatrix();
+
+			/*!
+			 * \brief A matrix from 20 values, a row at a time.
+			 */
+			explicit ColorMatrix(const double values[20]);
+
+			/*!
+			 * \return The value at row, column.
+			 */
+			double &operator ()(int row, int column);
+			double operator ()(int row, int column) const;
+
+			/*!
+			 * \return A matrix that does matrix, then this.
+			 */
+			ColorMatrix operator *(const ColorMatrix &matrix) const;
+
+			/*!
+			 * \return True if each channel only depends on itself, so a
+			 * faster path can be taken.
+			 */
+			bool IsDiagonal() const;
+
+			/*!
+			 * \brief Multiply the colors by color, amount of the way.
+			 *
+			 * Tint(color, 1) multiplies each channel by color's / 255, 0
+			 * changes nothing.
+			 */
+			static ColorMatrix Tint(const Color &color, double amount = 1.0);
+
+			/*!
+			 * \brief Scale the colors' distance from the middle gray by
+			 * contrast, then add brightness.
+			 *
+			 * brightness goes from -1 (black) to 1 (white), contrast 1
+			 * changes nothing.
+			 */
+			static ColorMatrix BrightnessContrast(double brightness,
+												  double contrast);
+
+			/*!
+			 * \brief Take out amount of the color, by luma.
+			 */
+			static ColorMatrix Grayscale(double amount = 1.0);
+
+			/*!
+			 * \brief Blend the colors amount of the way to color.
+			 */
+			static ColorMatrix Fade(const Color &color, double amount);
+
+			/*!
+			 * \brief Multiply alpha by opacity.
+			 */
+			static ColorMatrix Opacity(double opacity);
+		private:
+			double m_Values[4][5];
+	};
+	//@}
+}
+
+#endif
@@ -0,0 +1,239 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SDL4CPP_COMPOSITOR_H
+#define SDL4CPP_COMPOSITOR_H
+
+#include <vector>
+#include "SDL4Cpp_video.h"
+
+namespace SDL
+{
+	/*!
+	 * \addtogroup Video
+	 */
+	//@{
+
+	/*!
+	 * \brief What the last Compositor::Compose() did.
+	 */
+	struct CompositorStats
+	{
+		/*! Tiles on the screen */
+		int tiles;
+		/*! Tiles that were redrawn */
+		int dirty;
+		/*! Blits and fills done */
+		int blits;
+		/*! Pixels blitted or filled */
+		Uint32 drawn;
+		/*! Pixels of redrawn tiles that weren't blitted because something
+		 * opaque was on top */
+		Uint32 culled;
+	};
+
+	/*!
+	 * \brief Keeps layers of Surfaces and redraws only what changed and can
+	 * be seen.
+	 *
+	 * Layers are drawn from the lowest z up, and surfaces on a layer in the
+	 * order they were added. The screen is split into square tiles. Only
+	 * tiles touched by something that was added, moved, removed or
+	 * Invalidate()d are redrawn, and only those tiles are passed to
+	 * Screen::UpdateRects().
+	 *
+	 * Every surface has an opaque rectangle, which is the whole surface if
+	 * it has no colorkey or alpha and empty otherwise. SetOpaqueRect()
+	 * changes it, say for a sprite with a solid middle. In each tile nothing
+	 * under the topmost surface whose opaque rectangle covers the whole tile
+	 * is drawn. Tiles nothing opaque covers are filled with the background
+	 * color first.
+	 *
+	 * \code
+	 * SDL::Compositor compositor;
+	 * int world = compositor.AddLayer(0);
+	 * int hud = compositor.AddLayer(10);
+	 * compositor.Add(world, background, 0, 0);
+	 * int cursor = compositor.Add(hud, arrow, 0, 0);
+	 *
+	 * // every frame
+	 * compositor.Move(cursor, mousex, mousey);
+	 * compositor.Compose(screen);
+	 * \endcode
+	 *
+	 * Surfaces are shared, not copied. After changing one's pixels, call
+	 * Invalidate() on it.
+	 *
+	 * \note Double buffered screens always have every tile redrawn and are
+	 * flipped, since the back buffer holds an older frame.
+	 */
+	class Compositor
+	{
+		public:
+			/*!
+			 * \brief Use tilesize x tilesize tiles.
+			 */
+			explicit Compositor(int tilesize = 32);
+
+			/*!
+			 * \brief Destructor.
+			 */
+			~Compositor();
+
+			/*!
+			 * \brief Add a layer, drawn above layers with a lower z.
+			 *
+			 * \return The layer's number.
+			 */
+			int AddLayer(int z);
+
+			/*!
+			 * \brief Remove layer and every surface on it.
+			 */
+			void RemoveLayer(int layer);
+
+			/*!
+			 * \brief Show or hide layer.
+			 */
+			void SetLayerVisible(int layer, bool visible);
+
+			/*!
+			 * \brief Put all of surface on layer with its upper left corner
+			 * at (x, y).
+			 *
+			 * \throws SDL::LogicError if surface is empty.
+			 * \return The item's number.
+			 */
+			int Add(int layer, Surface &surface, Sint16 x, Sint16 y);
+
+			/*!
+			 * \brief Put the srcrect part of surface on layer at (x, y).
+			 *
+			 * \throws SDL::LogicError if surface is empty.
+			 * \return The item's number.
+			 */
+			int Add(int layer, const Rect &srcrect, Surface &surface,
+					Sint16 x, Sint16 y);
+
+			/*!
+			 * \brief Take item off its layer.
+			 */
+			void Remove(int item);
+
+			/*!
+			 * \brief Move item's upper left corner to (x, y).
+			 */
+			void Move(int item, Sint16 x, Sint16 y);
+
+			/*!
+			 * \brief Show a different part of item's surface.
+			 */
+			void SetSource(int item, const Rect &srcrect);
+
+			/*!
+			 * \brief Set the part of item that's opaque, relative to its
+			 * upper left corner. A zero sized rect means none.
+			 */
+			void SetOpaqueRect(int item, const Rect &rect);
+
+			/*!
+			 * \brief Redraw item, after its pixels have changed.
+			 */
+			void Invalidate(int item);
+
+			/*!
+			 * \brief Redraw rect of the screen.
+			 */
+			void Invalidate(const Rect &rect);
+
+			/*!
+			 * \brief Redraw the whole screen.
+			 */
+			void InvalidateAll();
+
+			/*!
+			 * \brief Set the color for tiles nothing opaque covers.
+			 */
+			void SetBackground(Uint32 color);
+
+			/*!
+			 * \brief Redraw what changed on screen and update it.
+			 *
+			 * \throws SDL::LogicError if screen is empty.
+			 * \return False if a blit failed.
+			 */
+			bool Compose(Screen &screen);
+
+			/*!
+			 * \return What the last Compose() did.
+			 */
+			CompositorStats GetStats();
+		private:
+			Compositor(const Compositor &copy);
+			Compositor &operator =(const Compositor &copy);
+
+			struct Layer
+			{
+				explicit Layer(int depth) : z(depth), visible(true), used(true), items()
+				{
+				}
+
+				int z;
+				bool visible;
+				bool used;
+				/*! Items in drawing order */
+				std::vector<int> items;
+			};
+
+			struct Item
+			{
+				SDL_Surface *surface;
+				SDL_Rect src;
+				Sint16 x, y;
+				/*! Relative to x, y */
+				SDL_Rect opaque;
+				int layer;
+			};
+
+			int NewItem(int layer, const SDL_Rect &src, Surface &surface,
+						Sint16 x, Sint16 y);
+			void Damage(const Item &item);
+			void Damage(int x, int y, int w, int h);
+
+			int m_TileSize;
+			int m_Columns, m_Rows;
+			std::vector<Layer> m_Layers;
+			std::vector<Item> m_Items;
+			std::vector<int> m_FreeItems;
+			/*! Screen areas to redraw at the next Compose() */
+			std::vector<SDL_Rect> m_Damage;
+			bool m_All;
+			Uint32 m_Background;
+			std::vector<Uint8> m_Dirty;
+			/*! Per tile, the position in drawing order of the topmost
+			 * item covering it, or -1 */
+			std::vector<int> m_Occluder;
+			std::vector<int> m_Order;
+			std::vector<Rect> m_Updates;
+			/*! Indices in m_Updates of the rects that end at the previous
+			 * row, and of those that end at this one */
+			std::vector<unsigned int> m_Above, m_Current;
+			CompositorStats m_Stats;
+	};
+	//@}
+}
+
+#endif
@@ -0,0 +1,250 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SDL4CPP_DRAW_H
+#define SDL4CPP_DRAW_H
+
+#include <vector>
+#include "SDL4Cpp_video.h"
+
+namespace SDL
+{
+	/*!
+	 * \addtogroup Video
+	 */
+	//@{
+
+	/*!
+	 * \brief A corner of a polygon.
+	 */
+	struct Point
+	{
+		int x, y;
+	};
+
+	/*!
+	 * \brief Drawing lines and shapes on a Surface.
+	 *
+	 * Everything is clipped to the Surface's clip rect and drawn in color,
+	 * blended with alpha (255, the default, is opaque). Filled shapes are
+	 * drawn one horizontal span at a time, and spans on 32-bit surfaces are
+	 * filled and blended with SSE2 or AVX2 when the library is built with
+	 * them.
+	 *
+	 * Shapes never touch a pixel twice, so blended shapes don't get darker
+	 * where their edges meet.
+	 *
+	 * \code
+	 * SDL::Color red = { 255, 0, 0, 0 };
+	 * SDL::Draw::Line(screen, 0, 0, 639, 479, red);
+	 * SDL::Draw::FilledCircle(screen, 320, 240, 50, red, 128);
+	 * \endcode
+	 *
+	 * \note Every function locks and unlocks the surface. Use a DrawList to
+	 * draw many shapes with one lock.
+	 * \throws SDL::LogicError if the Surface is empty.
+	 * \return False if the surface couldn't be locked.
+	 */
+	namespace Draw
+	{
+		/*!
+		 * \brief Set a single pixel.
+		 */
+		bool Pixel(Surface &dst, int x, int y, Color color, Uint8 alpha = 255);
+
+		/*!
+		 * \brief Line from (x1, y1) to (x2, y2), both ends included.
+		 */
+		bool Line(Surface &dst, int x1, int y1, int x2, int y2, Color color,
+				  Uint8 alpha = 255);
+
+		/*!
+		 * \brief Anti-aliased line from (x1, y1) to (x2, y2) using Wu's
+		 * algorithm.
+		 */
+		bool AALine(Surface &dst, int x1, int y1, int x2, int y2, Color color,
+					Uint8 alpha = 255);
+
+		/*!
+		 * \brief The outline of rect.
+		 */
+		bool Rectangle(Surface &dst, Rect &rect, Color color, Uint8 alpha = 255);
+
+		/*!
+		 * \brief Fill rect.
+		 *
+		 * Unlike Surface::FillRect() this blends, and takes a Color.
+		 */
+		bool FilledRect(Surface &dst, Rect &rect, Color color, Uint8 alpha = 255);
+
+		/*!
+		 * \brief Circle of radius r centered on (x, y).
+		 */
+		bool Circle(Surface &dst, int x, int y, int r, Color color,
+					Uint8 alpha = 255);
+
+		/*!
+		 * \brief Filled circle of radius r centered on (x, y).
+		 */
+		bool FilledCircle(Surface &dst, int x, int y, int r, Color color,
+						  Uint8 alpha = 255);
+
+		/*!
+		 * \brief Ellipse with radii rx and ry centered on (x, y).
+		 */
+		bool Ellipse(Surface &dst, int x, int y, int rx, int ry, Color color,
+					 Uint8 alpha = 255);
+
+		/*!
+		 * \brief Filled ellipse with radii rx and ry centered on (x, y).
+		 */
+		bool FilledEllipse(Surface &dst, int x, int y, int rx, int ry,
+						   Color color, Uint8 alpha = 255);
+
+		/*!
+		 * \brief The outline of a triangle.
+		 */
+		bool Triangle(Surface &dst, int x1, int y1, int x2, int y2, int x3,
+					  int y3, Color color, Uint8 alpha = 255);
+
+		/*!
+		 * \brief Filled triangle.
+		 *
+		 * Pixels are filled if their centers are inside, so triangles
+		 * sharing an edge don't overlap or leave gaps.
+		 */
+		bool FilledTriangle(Surface &dst, int x1, int y1, int x2, int y2,
+							int x3, int y3, Color color, Uint8 alpha = 255);
+
+		/*!
+		 * \brief The outline of the polygon with n corners.
+		 */
+		bool Polygon(Surface &dst, const Point *points, int n, Color color,
+					 Uint8 alpha = 255);
+
+		/*!
+		 * \brief Filled polygon with n corners, using the even-odd rule.
+		 *
+		 * The polygon may be concave or cross itself.
+		 */
+		bool FilledPolygon(Surface &dst, const Point *points, int n,
+						   Color color, Uint8 alpha = 255);
+	}
+
+	/*!
+	 * \brief A list of shapes drawn together.
+	 *
+	 * Shapes are recorded by the same names as in SDL::Draw, and Draw()
+	 * draws them all in order with the surface locked once. A list can be
+	 * drawn any number of times, and Clear() keeps its memory so a list
+	 * rebuilt every frame doesn't allocate.
+	 *
+	 * \code
+	 * SDL::DrawList overlay;
+	 * for(int i = 0; i < count; i++)
+	 *	overlay.Rectangle(boxes[i], green);
+	 * overlay.Draw(screen);
+	 * overlay.Clear();
+	 * \endcode
+	 */
+	class DrawList
+	{
+		public:
+			/*!
+			 * \brief Default constructor.
+			 */
+			DrawList();
+
+			/*!
+			 * \brief Remove every shape.
+			 */
+			void Clear();
+
+			/*!
+			 * \return The number of shapes in the list.
+			 */
+			int GetCount();
+
+			void Pixel(int x, int y, Color color, Uint8 alpha = 255);
+			void Line(int x1, int y1, int x2, int y2, Color color,
+					  Uint8 alpha = 255);
+			void AALine(int x1, int y1, int x2, int y2, Color color,
+						Uint8 alpha = 255);
+			void Rectangle(Rect &rect, Color color, Uint8 alpha = 255);
+			void FilledRect(Rect &rect, Color color, Uint8 alpha = 255);
+			void Circle(int x, int y, int r, Color color, Uint8 alpha = 255);
+			void FilledCircle(int x, int y, int r, Color color,
+							  Uint8 alpha = 255);
+			void Ellipse(int x, int y, int rx, int ry, Color color,
+						 Uint8 alpha = 255);
+			void FilledEllipse(int x, int y, int rx, int ry, Color color,
+							   Uint8 alpha = 255);
+			void Triangle(int x1, int y1, int x2, int y2, int x3, int y3,
+						  Color color, Uint8 alpha = 255);
+			void FilledTriangle(int x1, int y1, int x2, int y2, int x3,
+								int y3, Color color, Uint8 alpha = 255);
+
+			/*!
+			 * \brief Record a polygon, points are copied.
+			 */
+			void Polygon(const Point *points, int n, Color color,
+						 Uint8 alpha = 255);
+
+			/*!
+			 * \brief Record a filled polygon, points are copied.
+			 */
+			void FilledPolygon(const Point *points, int n, Color color,
+							   Uint8 alpha = 255);
+
+			/*!
+			 * \brief Draw every shape on dst.
+			 *
+			 * \throws SDL::LogicError if dst is empty.
+			 * \return False if dst couldn't be locked.
+			 */
+			bool Draw(Surface &dst);
+		private:
+			enum Shape
+			{
+				ShapePixel, ShapeLine, ShapeAALine, ShapeRectangle,
+				ShapeFilledRect, ShapeEllipse, ShapeFilledEllipse,
+				ShapePolygon, ShapeFilledPolygon
+			};
+
+			/*!
+			 * \brief One recorded shape, polygons keep their corners in
+			 * m_Points.
+			 */
+			struct Command
+			{
+				Shape shape;
+				Color color;
+				Uint8 alpha;
+				int args[4];
+			};
+
+			void Add(Shape shape, int a, int b, int c, int d, Color color,
+					 Uint8 alpha);
+			void AddPoints(Shape shape, const Point *points, int n,
+						   Color color, Uint8 alpha);
+
+			std::vector<Command> m_Commands;
+			std::vector<Point> m_Points;
+	};
+	//@}
+}
+
+#endif
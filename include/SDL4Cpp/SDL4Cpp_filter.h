@@ -0,0 +1,183 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SDL4CPP_FILTER_H
+#define SDL4CPP_FILTER_H
+
+#include <vector>
+#include "SDL4Cpp_video.h"
+#include "SDL4Cpp_mt.h"
+
+namespace SDL
+{
+	/*!
+	 * \addtogroup Video
+	 */
+	//@{
+
+	/*!
+	 * \brief A one dimensional convolution kernel.
+	 *
+	 * Separable filters run one kernel along the rows and another down the
+	 * columns, which takes 2n reads per pixel instead of n * n. The kernel
+	 * is centered, so it has an odd number of weights. Weights that add up
+	 * to 1 keep the brightness the same.
+	 *
+	 * The filters use the weights in 1.14 fixed point, so each has to be
+	 * between -2 and 2 and the absolute values can add up to at most 4.
+	 */
+	class Kernel
+	{
+		public:
+			/*!
+			 * \brief The identity kernel, which leaves pixels alone.
+			 */
+			Kernel();
+
+			/*!
+			 * \brief A kernel of size weights. An even size gets a 0 added
+			 * to the end.
+			 */
+			Kernel(const double *weights, int size);
+
+			/*!
+			 * \return A Gaussian with standard deviation sigma, 3 sigma
+			 * wide on either side.
+			 */
+			static Kernel Gaussian(double sigma);
+
+			/*!
+			 * \return 2 * radius + 1 equal weights.
+			 */
+			static Kernel Box(int radius);
+
+			/*!
+			 * \return The number of weights either side of the center.
+			 */
+			int GetRadius() const;
+
+			/*!
+			 * \return Weight i, from 0 to 2 * GetRadius().
+			 */
+			double GetWeight(int i) const;
+
+			/*!
+			 * \return The weights in 1.14 fixed point, rounded so they add up
+			 * to the same as the real ones.
+			 */
+			const std::vector<Sint16> &GetFixed() const;
+		private:
+			void SetWeights(const double *weights, int size);
+
+			std::vector<double> m_Weights;
+			std::vector<Sint16> m_Fixed;
+	};
+
+	/*!
+	 * \brief Convolve src with horizontal along the rows and vertical down
+	 * the columns, into dst.
+	 *
+	 * src has to be 32-bit. All four bytes of a pixel are filtered the same
+	 * way, whatever the channel order. To filter an image with an alpha
+	 * channel without dark fringes, Surface::Premultiply() it first. Pixels
+	 * past the edges are taken to be copies of the edge.
+	 *
+	 * If dst is empty or a different size it's created like src. If dst is
+	 * src the filter is done in place, through a copy of src in a scratch
+	 * buffer that's kept for the next call (see FreeFilterScratch()).
+	 *
+	 * The work is done a column strip at a time, sized so the rows the
+	 * vertical kernel reads stay in the L2 cache, using SSE2 when it's
+	 * available. With a pool, bands of rows are run on its threads and
+	 * this waits for the pool to empty.
+	 *
+	 * \return False if src isn't 32-bit or dst doesn't match src, or a
+	 * surface couldn't be locked.
+	 *
+	 * \throws SDL::LogicError if src is empty.
+	 *
+	 * \note The scratch buffers aren't thread safe, so only filter from one
+	 * thread at a time.
+	 */
+	bool Convolve(Surface &dst, Surface &src, const Kernel &horizontal,
+				  const Kernel &vertical, MT::ThreadPool *pool = NULL);
+
+	/*!
+	 * \brief Convolve surface in place.
+	 *
+	 * \sa Convolve(Surface &, Surface &, const Kernel &, const Kernel &, MT::ThreadPool *)
+	 */
+	bool Convolve(Surface &surface, const Kernel &horizontal,
+				  const Kernel &vertical, MT::ThreadPool *pool = NULL);
+
+	/*!
+	 * \brief Blur src into dst with a Gaussian of standard deviation sigma.
+	 *
+	 * \sa Convolve(Surface &, Surface &, const Kernel &, const Kernel &, MT::ThreadPool *)
+	 */
+	bool GaussianBlur(Surface &dst, Surface &src, double sigma,
+					  MT::ThreadPool *pool = NULL);
+
+	/*!
+	 * \brief Blur surface in place with a Gaussian.
+	 */
+	bool GaussianBlur(Surface &surface, double sigma,
+					  MT::ThreadPool *pool = NULL);
+
+	/*!
+	 * \brief Average each pixel of src with those up to radius away, into
+	 * dst.
+	 *
+	 * Keeps running sums down the columns and along the rows, so the cost
+	 * per pixel is the same whatever the radius. radius is kept to at most
+	 * 1023.
+	 *
+	 * \sa Convolve(Surface &, Surface &, const Kernel &, const Kernel &, MT::ThreadPool *)
+	 */
+	bool BoxBlur(Surface &dst, Surface &src, int radius,
+				 MT::ThreadPool *pool = NULL);
+
+	/*!
+	 * \brief Box blur surface in place.
+	 */
+	bool BoxBlur(Surface &surface, int radius, MT::ThreadPool *pool = NULL);
+
+	/*!
+	 * \brief Sharpen src into dst with an unsharp mask.
+	 *
+	 * Each pixel moves away from a Gaussian blur of sigma by amount times
+	 * the difference, so 0 leaves src alone and 1 doubles the detail.
+	 * amount is kept between 0 and 127.
+	 *
+	 * \sa Convolve(Surface &, Surface &, const Kernel &, const Kernel &, MT::ThreadPool *)
+	 */
+	bool Sharpen(Surface &dst, Surface &src, double amount,
+				 double sigma = 1.0, MT::ThreadPool *pool = NULL);
+
+	/*!
+	 * \brief Sharpen surface in place.
+	 */
+	bool Sharpen(Surface &surface, double amount, double sigma = 1.0,
+				 MT::ThreadPool *pool = NULL);
+
+	/*!
+	 * \brief Free the scratch buffers kept between filters.
+	 */
+	void FreeFilterScratch();
+	//@}
+}
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SDL4CPP_INDEXED_H
+#define SDL4CPP_INDEXED_H
+
+#include "SDL4Cpp_video.h"
+
+namespace SDL
+{
+	/*!
+	 * \addtogroup Video
+	 */
+	//@{
+
+	/*!
+	 * \brief An 8-bit palettized Surface with a fast expansion blit.
+	 *
+	 * When SDL blits an 8-bit surface to a 16 or 32-bit surface it builds a
+	 * colour map from the palette, and throws it away again every time the
+	 * palette changes. For palette animation (cycling water, flashing when
+	 * hit, etc.) that means the whole map is rebuilt every frame.
+	 *
+	 * IndexedSurface keeps its own lookup table of palette index to
+	 * destination pixel value. SetColors(), SetPalette() and RotateColors()
+	 * only mark the entries they touched, and the next BlitTo() remaps just
+	 * those entries. The table is rebuilt completely only when blitting to a
+	 * surface with a different pixel format than the last one.
+	 *
+	 * \code
+	 * SDL::IndexedSurface water;
+	 * water.LoadBMP("water.bmp");
+	 * ...
+	 * // every frame
+	 * water.RotateColors(32, 16, 1);
+	 * water.BlitTo(screen, position);
+	 * \endcode
+	 *
+	 * \note Changes made to the palette directly through Get() are not seen.
+	 * Call Invalidate() after doing that.
+	 * \note Surfaces with SDL_SRCALPHA set, or blits to 8 or 24-bit
+	 * surfaces, are handed to SDL's normal blitter.
+	 */
+	class IndexedSurface : public Surface
+	{
+		public:
+			/*!
+			 * \brief Default constructor.
+			 *
+			 * Creates an empty IndexedSurface.
+			 */
+			IndexedSurface();
+
+			/*!
+			 * \brief Create an 8-bit surface of width w and height h.
+			 *
+			 * \throws SDL::RuntimeError if the surface couldn't be created.
+			 */
+			IndexedSurface(int w, int h, Uint32 flags = SDL_SWSURFACE);
+
+			/*!
+			 * \brief Destructor.
+			 */
+			~IndexedSurface();
+
+			/*!
+			 * \brief Create an 8-bit surface of width w and height h.
+			 *
+			 * \return True on success, False on an error.
+			 */
+			bool Create(int w, int h, Uint32 flags = SDL_SWSURFACE);
+
+			/*!
+			 * \brief Load an 8-bit BMP.
+			 *
+			 * \return False if the file couldn't be loaded or isn't 8-bit.
+			 */
+			bool LoadBMP(std::string file);
+
+			/*!
+			 * \brief Sets colors in the palette and marks them as changed.
+			 *
+			 * \see Surface::SetColors()
+			 */
+			int SetColors(Color &colors, int firstcolor, int ncolors);
+
+			/*!
+			 * \brief Sets colors in the palette and marks them as changed.
+			 *
+			 * \see Surface::SetPalette()
+			 */
+			int SetPalette(int flags, Color &colors, int firstcolor,
+						   int ncolors);
+
+			/*!
+			 * \brief Rotate a range of palette entries.
+			 *
+			 * Entries firstcolor to firstcolor + ncolors - 1 are moved shift
+			 * places up (or down for a negative shift), wrapping around
+			 * inside the range. This is the usual palette cycling effect.
+			 *
+			 * \return True on success, False on an error.
+			 */
+			bool RotateColors(int firstcolor, int ncolors, int shift);
+
+			/*!
+			 * \brief Forget the lookup table.
+			 *
+			 * The whole table is rebuilt on the next BlitTo().
+			 */
+			void Invalidate();
+
+			/*!
+			 * \brief Blit this surface to the upper left corner of dest.
+			 *
+			 * \return True if the blit was sucessfull, otherwise false.
+			 * \throws SDL::LogicError if either surface is NULL.
+			 */
+			bool BlitTo(Surface &dest);
+
+			/*!
+			 * \brief Blit this surface to destrect of dest.
+			 *
+			 * Like Surface::Blit() the final blit rectangle is written back
+			 * into destrect.
+			 *
+			 * \return True if the blit was sucessfull, otherwise false.
+			 * \throws SDL::LogicError if either surface is NULL.
+			 */
+			bool BlitTo(Surface &dest, Rect &destrect);
+
+			/*!
+			 * \brief Blit srcrect of this surface to destrect of dest.
+			 *
+			 * \return True if the blit was sucessfull, otherwise false.
+			 * \throws SDL::LogicError if either surface is NULL.
+			 */
+			bool BlitTo(Rect &srcrect, Surface &dest, Rect &destrect);
+
+		protected:
+			/*!
+			 * \brief Bring the lookup table up to date for format.
+			 *
+			 * \return False if format can't use the fast path.
+			 */
+			bool UpdateLUT(PixelFormat &format);
+
+			/*!
+			 * \brief Do the blit, either ourselves or through SDL.
+			 */
+			bool DoBlit(SDL_Rect *srcrect, Surface &dest, SDL_Rect *destrect);
+
+			/*!
+			 * \brief Mark palette entries first to first + count - 1.
+			 */
+			void MarkDirty(int first, int count);
+
+			/*!
+			 * \brief Palette index to destination pixel lookup table.
+			 */
+			Uint32 m_LUT[256];
+
+			/*!
+			 * \brief The destination format m_LUT was built for.
+			 */
+			Uint8 m_LUTBitsPerPixel;
+			Uint32 m_LUTRmask, m_LUTGmask, m_LUTBmask, m_LUTAmask;
+
+			/*!
+			 * \brief Range of palette entries changed since the last blit.
+			 *
+			 * m_DirtyFirst > m_DirtyLast means nothing has changed.
+			 */
+			int m_DirtyFirst, m_DirtyLast;
+	};
+	//@}
+}
+
+#endif
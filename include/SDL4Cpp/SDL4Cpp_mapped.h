@@ -0,0 +1,101 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SDL4CPP_MAPPED_H
+#define SDL4CPP_MAPPED_H
+
+#include <cstddef>
+#include "SDL4Cpp_video.h"
+
+namespace SDL
+{
+	/*!
+	 * \addtogroup Video
+	 */
+	//@{
+
+	/*!
+	 * \brief A Surface whose pixels can live in a memory mapped file.
+	 *
+	 * LoadBMP() maps the file instead of reading it. If the BMP is an
+	 * uncompressed, top-down, 32 bits per pixel image the Surface points
+	 * straight at the pixels in the mapping, so loading costs nothing more
+	 * than the page faults when the pixels are first touched. Outside of x86
+	 * the pixel data also has to start on a 4 byte boundary. Any other BMP
+	 * is decoded from the mapping into a normal Surface and the mapping is
+	 * dropped again.
+	 *
+	 * The file is mapped copy-on-write, so drawing on the Surface is fine and
+	 * never changes the file.
+	 *
+	 * \note The mapping is released by Free() and the destructor. Don't keep
+	 * the SDL_Surface from Get() around longer than the MappedSurface, make a
+	 * copy instead.
+	 */
+	class MappedSurface : public Surface
+	{
+		public:
+			/*!
+			 * \brief Default constructor.
+			 *
+			 * Creates an empty MappedSurface.
+			 */
+			MappedSurface();
+
+			/*!
+			 * \brief Copy constructor.
+			 *
+			 * The copy is a normal in-memory copy of the pixels.
+			 */
+			MappedSurface(const MappedSurface &copy);
+
+			/*!
+			 * \brief Destructor.
+			 */
+			~MappedSurface();
+
+			/*!
+			 * \brief Copy the pixels of copy into this surface.
+			 */
+			MappedSurface &operator =(const MappedSurface &copy);
+
+			/*!
+			 * \brief Load a BMP, using the pixels in place when possible.
+			 *
+			 * \return True on success, False on an error.
+			 */
+			bool LoadBMP(std::string file);
+
+			/*!
+			 * \return True if the pixels are in the mapped file.
+			 */
+			bool IsMapped();
+
+			/*!
+			 * \brief Free the surface and release the mapping.
+			 */
+			void Free();
+		protected:
+			/*!
+			 * \brief The mapped file, or NULL.
+			 */
+			void *m_Map;
+			size_t m_MapSize;
+	};
+	//@}
+}
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SDL4CPP_MIPMAP_H
+#define SDL4CPP_MIPMAP_H
+
+#include <vector>
+#include "SDL4Cpp_video.h"
+
+namespace SDL
+{
+	/*!
+	 * \addtogroup Video
+	 */
+	//@{
+
+	/*!
+	 * \brief A surface and copies of it at half, quarter, eighth... size.
+	 *
+	 * Made by Surface::BuildMipChain(). Level 0 is the surface itself,
+	 * shared and not copied, and each level after it is half the width and
+	 * height of the one before, rounded down, down to 1x1. All the levels
+	 * after 0 are in one block of memory.
+	 *
+	 * Shrinking a big surface a lot with BlitTransformed() skips most of
+	 * its pixels, so it shimmers as it moves, and reads pixels far apart
+	 * in memory. Blit() instead starts from the smallest level that's
+	 * still at least as big as the result, so it never shrinks by more
+	 * than half.
+	 *
+	 * \code
+	 * SDL::MipChain chain;
+	 * map.BuildMipChain(chain);
+	 *
+	 * // every frame
+	 * chain.Blit(screen, 320, 240, zoom);
+	 * \endcode
+	 *
+	 * The levels don't follow changes to the surface's pixels. Call
+	 * Surface::BuildMipChain() again after changing them.
+	 */
+	class MipChain
+	{
+		public:
+			/*!
+			 * \brief Make an empty chain.
+			 */
+			MipChain();
+
+			/*!
+			 * \brief Destructor.
+			 */
+			~MipChain();
+
+			/*!
+			 * \brief Release every level.
+			 */
+			void Free();
+
+			/*!
+			 * \return The number of levels, 0 if the chain is empty.
+			 */
+			int GetLevelCount() const;
+
+			/*!
+			 * \return Level level, 0 being the full sized surface.
+			 *
+			 * \throws SDL::LogicError if there's no such level.
+			 */
+			Surface &GetLevel(int level);
+
+			/*!
+			 * \return How much bigger level is than level 0 along its
+			 * longer side, 0.5 for level 1 unless that side is odd.
+			 */
+			double GetScale(int level) const;
+
+			/*!
+			 * \return The smallest level at least scale times the size of
+			 * level 0.
+			 */
+			int PickLevel(double scale) const;
+
+			/*!
+			 * \brief Blit level 0 rotated and scaled by scale, centered on
+			 * (x, y), starting from the level PickLevel() chooses.
+			 *
+			 * \return True if the blit was sucessfull. otherwise false.
+			 *
+			 * \throws SDL::LogicError if the chain or dst is empty.
+			 *
+			 * \sa Surface::BlitTransformed()
+			 */
+			bool Blit(Surface &dst, int x, int y, double scale,
+					  double angle = 0.0, Filter filter = FilterBilinear);
+		private:
+			MipChain(const MipChain &copy);
+			MipChain &operator =(const MipChain &copy);
+
+			friend class Surface;
+
+			/*!
+			 * \brief Halve source over and over into the chain.
+			 */
+			bool Build(SDL_Surface *source, bool gamma);
+
+			/*! Levels 1 and up */
+			std::vector<Uint8> m_Pixels;
+			std::vector<Surface *> m_Levels;
+	};
+	//@}
+}
+
+#endif
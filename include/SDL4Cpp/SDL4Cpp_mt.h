@@ -17,6 +17,8 @@
 #ifndef SDL4CPP_MT_H
 #define SDL4CPP_MT_H
 
+#include <deque>
+#include <vector>
 #include "SDL_thread.h"
 
 
@@ -433,6 +435,133 @@ namespace SDL
 		 */
 		int CondWaitTimeout(Cond *cond, Mutex *mutex, Uint32 ms);
 
+		/*!
+		 * Get the number of CPUs that are currently online, or 1 if that
+		 * can't be found out on this platform.
+		 */
+		int GetCPUCount(void);
+
+		/*!
+		 * \brief Locks a Mutex for as long as it's in scope.
+		 *
+		 * \code
+		 * {
+		 *	MT::Locker lock(mutex);
+		 *	// Do stuff while mutex is locked
+		 * }
+		 * \endcode
+		 */
+		class Locker
+		{
+			public:
+				/*!
+				 * Locks mutex with MutexP
+				 */
+				explicit Locker(Mutex *mutex);
+				/*!
+				 * Unlocks the mutex with MutexV
+				 */
+				~Locker();
+			private:
+				Locker(const Locker &copy);
+				Locker &operator =(const Locker &copy);
+
+				Mutex *m_Mutex;
+		};
+
+		/*!
+		 * \brief A unit of work for a ThreadPool.
+		 *
+		 * Inherit this and override Run() with the work to do.
+		 */
+		class Task
+		{
+			public:
+				virtual ~Task();
+				/*!
+				 * Called from one of the pool's threads.
+				 */
+				virtual void Run() = 0;
+		};
+
+		/*!
+		 * \brief A fixed number of worker threads that run Tasks.
+		 *
+		 * Tasks are run in the order they're added, by whichever thread is
+		 * free first. The pool owns every Task given to Add() and deletes it
+		 * once Run() returns.
+		 *
+		 * \code
+		 * class Work : public MT::Task
+		 * {
+		 *	public:
+		 *		void Run() { ... }
+		 * };
+		 *
+		 * MT::ThreadPool pool;
+		 * pool.Add(new Work);
+		 * pool.Add(new Work);
+		 * pool.Wait();
+		 * \endcode
+		 *
+		 * \note The same rules as for any thread apply to Tasks: don't touch
+		 * the video or event functions from them unless SDL says it's safe.
+		 */
+		class ThreadPool
+		{
+			public:
+				/*!
+				 * Start threads worker threads, or one per CPU if threads is
+				 * less than 1.
+				 *
+				 * \throws SDL::RuntimeError if the threads couldn't be
+				 * created.
+				 */
+				explicit ThreadPool(int threads = 0);
+				/*!
+				 * Runs any Tasks still queued, then stops the threads.
+				 */
+				~ThreadPool();
+
+				/*!
+				 * Queue task to be run. The pool deletes it after it's run.
+				 */
+				void Add(Task *task);
+				/*!
+				 * Block until every queued Task has finished.
+				 */
+				void Wait();
+				/*!
+				 * \return The number of queued or running Tasks.
+				 */
+				int Pending();
+				/*!
+				 * \return The number of worker threads.
+				 */
+				int GetThreads();
+			private:
+				ThreadPool(const ThreadPool &copy);
+				ThreadPool &operator =(const ThreadPool &copy);
+
+				/*!
+				 * The function each worker thread runs.
+				 */
+				static int Worker(void *data);
+
+				std::vector<Thread *> m_Threads;
+				std::deque<Task *> m_Tasks;
+				Mutex *m_Mutex;
+				/*!
+				 * Signalled when a Task is added or the pool is stopping.
+				 */
+				Cond *m_Work;
+				/*!
+				 * Signalled when the last pending Task finishes.
+				 */
+				Cond *m_Idle;
+				int m_Running;
+				bool m_Quit;
+		};
 	}
 	//@}
 }
@@ -0,0 +1,194 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SDL4CPP_PACK_H
+#define SDL4CPP_PACK_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "SDL4Cpp_video.h"
+
+namespace SDL
+{
+	/*!
+	 * \addtogroup Video
+	 */
+	//@{
+
+	/*!
+	 * \brief A file of many Surfaces stored ready to use.
+	 *
+	 * A pack holds Surfaces in whatever pixel format they were written in,
+	 * normally the display format of the target, so nothing has to be
+	 * decoded or converted when loading them. Packs are made with
+	 * SurfacePackWriter or the sdl4cpp-pack tool.
+	 *
+	 * The file is a 64 byte header followed by an index of 96 byte entries
+	 * (name, size, pixel format, colorkey, alpha, and where the pixels are).
+	 * Every surface's pixels start on a 64 byte boundary, and so does every
+	 * row. Entries can also be stored compressed with LZ4's block format,
+	 * which is quick to unpack but does mean a copy.
+	 *
+	 * The pack is mapped into memory copy-on-write. Uncompressed Surfaces
+	 * from Get() point straight into the mapping.
+	 *
+	 * \code
+	 * SDL::SurfacePack pack;
+	 * SDL::Surface ball;
+	 *
+	 * if(!pack.Open("sprites.pack") || !pack.Get("ball", ball))
+	 *	cout << SDL::GetError() << endl;
+	 * \endcode
+	 *
+	 * \note Packs are only readable on machines with the same byte order as
+	 * the one that wrote them.
+	 * \note Surfaces from Get() must be freed before the pack is closed or
+	 * destroyed.
+	 */
+	class SurfacePack
+	{
+		public:
+			/*!
+			 * \brief Default constructor.
+			 */
+			SurfacePack();
+
+			/*!
+			 * \brief Open file, throwing if it isn't a valid pack.
+			 *
+			 * \throws SDL::RuntimeError if the pack couldn't be opened.
+			 */
+			explicit SurfacePack(std::string file);
+
+			/*!
+			 * \brief Destructor, Close()'s the pack.
+			 */
+			~SurfacePack();
+
+			/*!
+			 * \brief Map file and check its header and index.
+			 *
+			 * \return True on success, False on an error.
+			 */
+			bool Open(std::string file);
+
+			/*!
+			 * \brief Unmap the pack.
+			 */
+			void Close();
+
+			/*!
+			 * \return The number of surfaces in the pack.
+			 */
+			int GetCount();
+
+			/*!
+			 * \return The name of surface index, or an empty string.
+			 */
+			std::string GetName(int index);
+
+			/*!
+			 * \return The index of the surface called name, or -1.
+			 */
+			int Find(std::string name);
+
+			/*!
+			 * \brief Get surface index.
+			 *
+			 * \return True on success, False on an error.
+			 */
+			bool Get(int index, Surface &surface);
+
+			/*!
+			 * \brief Get the surface called name.
+			 *
+			 * \return True on success, False on an error.
+			 */
+			bool Get(std::string name, Surface &surface);
+		private:
+			SurfacePack(const SurfacePack &copy);
+			SurfacePack &operator =(const SurfacePack &copy);
+
+			Uint8 *m_Map;
+			size_t m_MapSize;
+			int m_Count;
+	};
+
+	/*!
+	 * \brief Writes Surfaces to a SurfacePack file.
+	 *
+	 * Surfaces are written in the pixel format they already have. Convert
+	 * them to the format they'll be used in first (usually the display
+	 * format), so loading the pack needs no conversion. Surfaces have to be
+	 * 16, 24 or 32 bits per pixel.
+	 *
+	 * \code
+	 * SDL::SurfacePackWriter writer;
+	 * writer.Add("ball", ball);
+	 * writer.Add("paddle", paddle);
+	 * writer.Save("sprites.pack");
+	 * \endcode
+	 */
+	class SurfacePackWriter
+	{
+		public:
+			/*!
+			 * \brief Default constructor.
+			 */
+			SurfacePackWriter();
+
+			/*!
+			 * \brief Destructor.
+			 */
+			~SurfacePackWriter();
+
+			/*!
+			 * \brief Add surface to the pack as name.
+			 *
+			 * The surface is shared, not copied, until the writer is
+			 * destroyed, so don't change it before Save().
+			 *
+			 * \return False if the name is too long (47 characters at most),
+			 * already used, or the surface isn't 16, 24 or 32-bit.
+			 */
+			bool Add(std::string name, Surface &surface);
+
+			/*!
+			 * \brief Write every added surface to file.
+			 *
+			 * With compress each surface is stored LZ4 compressed, unless
+			 * that doesn't make it smaller.
+			 *
+			 * \return True on success, False on an error.
+			 */
+			bool Save(std::string file, bool compress = false);
+
+			/*!
+			 * \return The number of surfaces added.
+			 */
+			int GetCount();
+		private:
+			SurfacePackWriter(const SurfacePackWriter &copy);
+			SurfacePackWriter &operator =(const SurfacePackWriter &copy);
+
+			std::vector<std::string> m_Names;
+			std::vector<SDL_Surface *> m_Surfaces;
+	};
+	//@}
+}
+
+#endif
@@ -0,0 +1,242 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SDL4CPP_RECORD_H
+#define SDL4CPP_RECORD_H
+
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+#include "SDL4Cpp_video.h"
+#include "SDL4Cpp_mt.h"
+
+namespace SDL
+{
+	/*!
+	 * \addtogroup Video
+	 */
+	//@{
+
+	/*!
+	 * \brief Records the frames shown on the Screen to disk.
+	 *
+	 * Once attached with Screen::SetRecorder(), every Screen::Flip() and
+	 * Screen::UpdateRects() copies the screen into one of a fixed pool of
+	 * buffers and queues it. A writer thread converts and writes the queued
+	 * frames, so the game only pays for a memcpy of the screen.
+	 *
+	 * If the writer falls behind and the queue is full, the DropPolicy
+	 * decides what happens: skip the new frame, replace the oldest queued
+	 * one, or wait for the writer.
+	 *
+	 * \code
+	 * SDL::FrameRecorder recorder;
+	 * recorder.Start("session.y4m", SDL::FrameRecorder::FormatY4M, 30);
+	 * SDL::Screen::SetRecorder(&recorder);
+	 * ...
+	 * SDL::Screen::SetRecorder(NULL);
+	 * recorder.Stop();
+	 * \endcode
+	 *
+	 * \note Raw and Y4M files have one frame size, set by the first frame.
+	 * Frames of another size are counted as dropped.
+	 */
+	class FrameRecorder
+	{
+		public:
+			/*!
+			 * \brief What to write frames as.
+			 */
+			enum Format
+			{
+				/*! Packed 24-bit RGB frames, one after another in one file */
+				FormatRaw,
+				/*! A YUV4MPEG2 stream (4:2:0), which most video tools read */
+				FormatY4M,
+				/*! One binary PPM per frame, path000000.ppm and so on */
+				FormatPPM
+			};
+
+			/*!
+			 * \brief What Capture() does when the queue is full.
+			 */
+			enum DropPolicy
+			{
+				/*! Skip the frame being captured */
+				DropNewest,
+				/*! Throw away the oldest queued frame to make room */
+				DropOldest,
+				/*! Wait for the writer, which slows the game down */
+				DropNone
+			};
+
+			/*!
+			 * \brief Default constructor.
+			 */
+			FrameRecorder();
+
+			/*!
+			 * \brief Destructor, Stop()'s recording.
+			 *
+			 * Also detaches the recorder from the Screen if it's attached.
+			 */
+			~FrameRecorder();
+
+			/*!
+			 * \brief Start recording to path.
+			 *
+			 * For FormatPPM path is the start of each file name, the frame
+			 * number and ".ppm" are added to it.
+			 *
+			 * \param fps is only written in the Y4M header.
+			 * \param depth is the number of frames that can be queued.
+			 *
+			 * \return True on success, False if the file couldn't be created
+			 * or the writer thread couldn't be started.
+			 */
+			bool Start(std::string path, Format format, int fps = 30,
+					   int depth = 8, DropPolicy policy = DropNewest);
+
+			/*!
+			 * \brief Write out the queued frames and stop recording.
+			 */
+			void Stop();
+
+			/*!
+			 * \return True between Start() and Stop().
+			 */
+			bool IsRecording();
+
+			/*!
+			 * \brief Queue a copy of frame for writing.
+			 *
+			 * Called by the Screen for you once it's attached.
+			 */
+			void Capture(Surface &frame);
+
+			/*!
+			 * \return Frames passed to Capture() while recording.
+			 */
+			Uint32 GetCaptured();
+
+			/*!
+			 * \return Frames that were dropped instead of written.
+			 */
+			Uint32 GetDropped();
+
+			/*!
+			 * \return Frames written.
+			 */
+			Uint32 GetEncoded();
+
+			/*!
+			 * \return Frames waiting for the writer.
+			 */
+			int GetQueued();
+
+			/*!
+			 * \return Microseconds from capture until the last frame was
+			 * written.
+			 */
+			Uint32 GetLatency();
+
+			/*!
+			 * \return The longest latency so far, in microseconds.
+			 */
+			Uint32 GetMaxLatency();
+
+			/*!
+			 * \return The average latency, in microseconds.
+			 */
+			Uint32 GetAverageLatency();
+
+			/*!
+			 * \return True if writing failed, the rest of the frames are
+			 * dropped.
+			 */
+			bool HasFailed();
+		protected:
+			/*!
+			 * \brief A captured frame, in the screen's own pixel format.
+			 */
+			struct Frame
+			{
+				Frame() : pixels(), colors(), format(), w(0), h(0), pitch(0), captured(0)
+				{
+				}
+
+				std::vector<Uint8> pixels;
+				std::vector<Color> colors;
+				PixelFormat format;
+				int w, h, pitch;
+				Uint64 captured;
+			};
+
+			/*!
+			 * \brief The writer thread.
+			 */
+			static int Writer(void *data);
+
+			/*!
+			 * \brief Write one frame to the output.
+			 *
+			 * \return False on a write error.
+			 */
+			bool Write(Frame &frame);
+
+			/*!
+			 * \brief Convert row y of frame to packed 24-bit RGB.
+			 */
+			void ToRGB(Frame &frame, int y, Uint8 *rgb);
+
+			void Release();
+
+			MT::Mutex *m_Mutex;
+			/*!
+			 * \brief Signalled when a frame is queued, or on Stop().
+			 */
+			MT::Cond *m_Ready;
+			/*!
+			 * \brief Signalled when the writer frees a buffer.
+			 */
+			MT::Cond *m_Space;
+			MT::Thread *m_Thread;
+
+			std::vector<Frame *> m_Free;
+			std::deque<Frame *> m_Queue;
+			int m_Depth;
+			DropPolicy m_Policy;
+			bool m_Recording, m_Stopping, m_Failed;
+
+			std::string m_Path;
+			Format m_Format;
+			int m_FPS;
+			FILE *m_File;
+			int m_Width, m_Height;
+			std::vector<Uint8> m_Row, m_Planes;
+
+			Uint32 m_Captured, m_Dropped, m_Encoded;
+			Uint32 m_Latency, m_MaxLatency;
+			Uint64 m_TotalLatency;
+		private:
+			FrameRecorder(const FrameRecorder &copy);
+			FrameRecorder &operator =(const FrameRecorder &copy);
+	};
+	//@}
+}
+
+#endif
@@ -0,0 +1,237 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SDL4CPP_RENDER_H
+#define SDL4CPP_RENDER_H
+
+#include <vector>
+#include "SDL4Cpp_video.h"
+#include "SDL4Cpp_mt.h"
+#include "SDL4Cpp_sprite.h"
+
+namespace SDL
+{
+	/*!
+	 * \addtogroup Video
+	 */
+	//@{
+
+	/*!
+	 * \brief How busy a RenderQueue is.
+	 *
+	 * busytime / elapsed is how much of the time the render thread was
+	 * drawing, and stalltime is how long the game thread was held up waiting
+	 * for it.
+	 */
+	struct RenderStats
+	{
+		/*! Command lists the render thread has finished */
+		Uint32 frames;
+		/*! Command lists submitted but not finished yet */
+		int depth;
+		/*! Commands in the last list submitted */
+		int commands;
+		/*! Microseconds the render thread spent running commands */
+		Uint64 busytime;
+		/*! Microseconds Submit() spent waiting for the render thread */
+		Uint64 stalltime;
+		/*! Microseconds since the queue was created */
+		Uint64 elapsed;
+	};
+
+	/*!
+	 * \brief Draws to the Screen from its own thread.
+	 *
+	 * The game thread records blits, fills and updates, then Submit()s them.
+	 * A render thread runs them on the video surface while the game thread
+	 * goes on to record the next frame, so a slow Flip() or vsync doesn't
+	 * hold up the game. There are two command lists: the one being recorded
+	 * and the one being drawn. Submit() only waits if the render thread
+	 * hasn't finished the last frame yet.
+	 *
+	 * \code
+	 * SDL::RenderQueue queue;
+	 *
+	 * // every frame
+	 * queue.Blit(background, 0, 0);
+	 * queue.Draw(sprites.GetDraws());
+	 * queue.Flip();
+	 * queue.Submit();
+	 * \endcode
+	 *
+	 * Surfaces blitted are kept alive until their commands have run, even if
+	 * the Surface they came from is freed. Their pixels aren't copied
+	 * though, so changing a surface that's been recorded has to wait for the
+	 * fence Submit() returned. Blitting from a recorded surface on another
+	 * thread has to wait too, even though it doesn't change the pixels:
+	 * SDL_BlitSurface() sets up the source's blit map, so two blits from
+	 * the same surface at once race.
+	 *
+	 * The render thread's Flip() and UpdateRects() go through the Screen's
+	 * FrameRecorder and damage tracking. Don't call
+	 * Screen::SetRecorder() or Screen::SetDamageTracking() while a queue
+	 * is running; Finish() it first.
+	 *
+	 * \note Once a queue exists, don't touch the Screen from the game thread
+	 * except through it. SDL only lets one thread use the video functions
+	 * at a time, which for most drivers includes the event functions, so
+	 * pumping events while the render thread draws is up to the driver.
+	 */
+	class RenderQueue
+	{
+		public:
+			/*!
+			 * \brief Start the render thread.
+			 *
+			 * \throws SDL::RuntimeError if the thread couldn't be created.
+			 */
+			RenderQueue();
+
+			/*!
+			 * \brief Finish() and stop the render thread.
+			 *
+			 * Commands recorded but not submitted are dropped.
+			 */
+			~RenderQueue();
+
+			/*!
+			 * \brief Blit all of src with its upper left corner at (x, y).
+			 */
+			void Blit(Surface &src, Sint16 x, Sint16 y);
+
+			/*!
+			 * \brief Blit the srcrect part of src to (x, y).
+			 */
+			void Blit(const Rect &srcrect, Surface &src, Sint16 x, Sint16 y);
+
+			/*!
+			 * \brief Blit every record in draws.
+			 */
+			void Draw(const std::vector<SpriteDraw> &draws);
+
+			/*!
+			 * \brief Fill rect with color like Surface::FillRect().
+			 */
+			void FillRect(const Rect &rect, Uint32 color);
+
+			/*!
+			 * \brief Screen::UpdateRects() with rects, which are copied.
+			 */
+			void UpdateRects(int numrects, const Rect *rects);
+
+			/*!
+			 * \brief Screen::Flip().
+			 */
+			void Flip();
+
+			/*!
+			 * \brief Hand everything recorded since the last Submit() to the
+			 * render thread.
+			 *
+			 * Waits for the render thread to finish the previous list first.
+			 *
+			 * \return A fence that's done once these commands have run.
+			 */
+			Uint32 Submit();
+
+			/*!
+			 * \return True if every command up to fence has run.
+			 */
+			bool IsDone(Uint32 fence);
+
+			/*!
+			 * \brief Block until every command up to fence has run.
+			 */
+			void Wait(Uint32 fence);
+
+			/*!
+			 * \brief Block until everything submitted has run.
+			 */
+			void Finish();
+
+			/*!
+			 * \return The statistics so far.
+			 */
+			RenderStats GetStats();
+		private:
+			RenderQueue(const RenderQueue &copy);
+			RenderQueue &operator =(const RenderQueue &copy);
+
+			enum Type
+			{
+				CommandBlit, CommandFill, CommandUpdate, CommandFlip
+			};
+
+			/*!
+			 * \brief One recorded command. Updates keep their rects in
+			 * CommandList::rects from first.
+			 */
+			struct Command
+			{
+				Type type;
+				SDL_Surface *surface;
+				SDL_Rect src, dst;
+				Uint32 color;
+				int first, count;
+			};
+
+			/*!
+			 * \brief Everything one Submit() hands over.
+			 */
+			struct CommandList
+			{
+				CommandList() : commands(), rects(), surfaces(), fence(0)
+				{
+				}
+
+				std::vector<Command> commands;
+				std::vector<Rect> rects;
+				/*! Surfaces referenced until the list has run */
+				std::vector<SDL_Surface *> surfaces;
+				Uint32 fence;
+			};
+
+			/*!
+			 * \brief The function the render thread runs.
+			 */
+			static int Render(void *data);
+
+			void Run(CommandList &list);
+			void Release(CommandList &list);
+			void Add(Type type, SDL_Surface *surface, const SDL_Rect *src,
+					 Sint16 x, Sint16 y, Uint32 color);
+
+			CommandList m_Lists[2];
+			/*! Index of the list being recorded */
+			int m_Recording;
+			/*! Submitted list the render thread hasn't taken yet */
+			CommandList *m_Ready;
+			MT::Thread *m_Thread;
+			MT::Mutex *m_Mutex;
+			/*! Signalled when a list is submitted or the queue is stopping */
+			MT::Cond *m_Work;
+			/*! Signalled when the render thread finishes a list */
+			MT::Cond *m_Done;
+			Uint32 m_Submitted;
+			Uint32 m_Completed;
+			bool m_Quit;
+			RenderStats m_Stats;
+			Uint64 m_Start;
+	};
+	//@}
+}
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SDL4CPP_SCROLL_H
+#define SDL4CPP_SCROLL_H
+
+#include <vector>
+#include "SDL4Cpp_video.h"
+
+namespace SDL
+{
+	/*!
+	 * \addtogroup Video
+	 */
+	//@{
+
+	/*!
+	 * \brief A view onto a large playfield that scrolls by copying.
+	 *
+	 * The view is a rectangle of a surface showing the playfield from
+	 * (GetX(), GetY()). Moving the view Surface::Scroll()s what's already
+	 * drawn and lists the strips that came into view, so only a few rows or
+	 * columns have to be drawn each frame instead of the whole view.
+	 *
+	 * \code
+	 * SDL::Scroller scroller(screen, SDL::Rect(0, 0, 640, 480));
+	 *
+	 * // every frame
+	 * scroller.ScrollTo(camerax, cameray);
+	 * const std::vector<SDL::Rect> &strips = scroller.GetExposed();
+	 * for(unsigned int i = 0; i < strips.size(); i++)
+	 *	DrawPlayfield(strips[i], scroller.ToWorldX(strips[i].x),
+	 *				  scroller.ToWorldY(strips[i].y));
+	 * screen.Flip();
+	 * \endcode
+	 *
+	 * The strips have to be redrawn after every move, or the next one copies
+	 * their stale pixels along with the rest. Anything drawn on top of the
+	 * playfield, like sprites, moves with it and has to be erased first.
+	 *
+	 * On an SDL_DOUBLEBUF surface the back buffer Flip() hands over is two
+	 * frames old, so there's nothing current to scroll. The whole view is
+	 * exposed on every move there instead, which saves nothing; scroll on a
+	 * single buffered screen, or on an offscreen surface blitted to the
+	 * screen, to get the savings.
+	 *
+	 * The scroller keeps a pointer to surface, so surface has to outlive it.
+	 */
+	class Scroller
+	{
+		public:
+			/*!
+			 * \brief Scroll the view rectangle of surface, starting at (0, 0).
+			 *
+			 * The whole view is exposed by the first move.
+			 */
+			Scroller(Surface &surface, const Rect &view);
+
+			/*!
+			 * \brief Show the playfield from (x, y).
+			 *
+			 * Exposes the whole view if the surface is SDL_DOUBLEBUF.
+			 *
+			 * \return False if the surface couldn't be locked, in which case
+			 * the whole view is exposed.
+			 */
+			bool ScrollTo(Sint32 x, Sint32 y);
+
+			/*!
+			 * \brief ScrollTo() (dx, dy) from where the view is.
+			 */
+			bool ScrollBy(int dx, int dy);
+
+			/*!
+			 * \brief Expose the whole view on the next move, even if it
+			 * doesn't go anywhere.
+			 */
+			void Invalidate();
+
+			/*!
+			 * \return The strips of the surface that came into view on the
+			 * last move, in surface coordinates.
+			 */
+			const std::vector<Rect> &GetExposed() const;
+
+			/*!
+			 * \return The playfield position at the view's upper left.
+			 */
+			Sint32 GetX() const;
+			Sint32 GetY() const;
+
+			/*!
+			 * \return The playfield position of surface column x or row y.
+			 */
+			Sint32 ToWorldX(int x) const;
+			Sint32 ToWorldY(int y) const;
+		private:
+			Scroller(const Scroller &copy);
+			Scroller &operator =(const Scroller &copy);
+
+			Surface *m_Surface;
+			Rect m_View;
+			Sint32 m_X, m_Y;
+			bool m_All;
+			std::vector<Rect> m_Exposed;
+	};
+	//@}
+}
+
+#endif
@@ -0,0 +1,377 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SDL4CPP_SPRITE_H
+#define SDL4CPP_SPRITE_H
+
+#include <vector>
+#include "SDL4Cpp_video.h"
+
+namespace SDL
+{
+	/*!
+	 * \addtogroup Video
+	 */
+	//@{
+
+	/*!
+	 * \brief Frames cut out of one Surface.
+	 *
+	 * The surface is shared, not copied. Frames are numbered in the order
+	 * they're added.
+	 *
+	 * \code
+	 * SDL::SpriteSheet sheet(image);
+	 * sheet.AddFrames(32, 32);	// every 32x32 cell, row by row
+	 * \endcode
+	 */
+	class SpriteSheet
+	{
+		public:
+			/*!
+			 * \brief Default constructor.
+			 */
+			SpriteSheet();
+
+			/*!
+			 * \brief Share surface's pixels.
+			 *
+			 * \throws SDL::LogicError if surface is empty.
+			 */
+			explicit SpriteSheet(Surface &surface);
+
+			/*!
+			 * \brief Destructor.
+			 */
+			~SpriteSheet();
+
+			/*!
+			 * \brief Share surface's pixels, keeping the frames.
+			 *
+			 * \throws SDL::LogicError if surface is empty.
+			 */
+			void SetSurface(Surface &surface);
+
+			/*!
+			 * \return The shared surface.
+			 */
+			const Surface &GetSurface() const;
+
+			/*!
+			 * \brief Add the frame at rect.
+			 *
+			 * \return The frame's number.
+			 */
+			int AddFrame(const Rect &rect);
+
+			/*!
+			 * \brief Add count w by h frames from a grid starting at the upper
+			 * left corner, going left to right then top to bottom.
+			 *
+			 * If count is 0, every whole cell that fits is added.
+			 *
+			 * \return The number of the first frame added, or -1 if the
+			 * surface isn't set or is smaller than one frame.
+			 */
+			int AddFrames(int w, int h, int count = 0);
+
+			/*!
+			 * \return The number of frames.
+			 */
+			int GetFrameCount() const;
+
+			/*!
+			 * \return Where frame is on the surface.
+			 */
+			const Rect &GetFrame(int frame) const;
+		private:
+			SpriteSheet(const SpriteSheet &copy);
+			SpriteSheet &operator =(const SpriteSheet &copy);
+
+			Surface m_Surface;
+			std::vector<Rect> m_Frames;
+	};
+
+	/*!
+	 * \brief A sequence of SpriteSheet frames and how long each is shown.
+	 *
+	 * An Animation is built once and then only read, so any number of
+	 * AnimatedSprites can play it at once. It keeps a pointer to its sheet,
+	 * so the sheet has to outlive it, and it has to outlive its sprites.
+	 *
+	 * \code
+	 * SDL::Animation walk(sheet);
+	 * walk.AddFrames(0, 8, 100);	// frames 0 to 7, 100ms each
+	 * \endcode
+	 */
+	class Animation
+	{
+		public:
+			/*!
+			 * \brief What happens at the end of the animation.
+			 */
+			enum Mode
+			{
+				/*! Stop on the last frame */
+				Once,
+				/*! Start over */
+				Loop,
+				/*! Play backwards to the start, then forwards again */
+				PingPong
+			};
+
+			/*!
+			 * \brief An empty animation of sheet's frames.
+			 */
+			explicit Animation(const SpriteSheet &sheet, Mode mode = Loop);
+
+			/*!
+			 * \brief Show sheet frame frame for duration milliseconds.
+			 *
+			 * Frames with a duration of 0 are ignored.
+			 */
+			void AddFrame(int frame, Uint32 duration);
+
+			/*!
+			 * \brief Add sheet frames first to first + count - 1, each
+			 * shown for duration milliseconds.
+			 */
+			void AddFrames(int first, int count, Uint32 duration);
+
+			/*!
+			 * \brief Change the mode.
+			 */
+			void SetMode(Mode mode);
+
+			/*!
+			 * \return The mode.
+			 */
+			Mode GetMode() const;
+
+			/*!
+			 * \return The sheet the frames are from.
+			 */
+			const SpriteSheet &GetSheet() const;
+
+			/*!
+			 * \return The number of frames.
+			 */
+			int GetFrameCount() const;
+
+			/*!
+			 * \return How long one pass through the frames takes in
+			 * milliseconds.
+			 */
+			Uint32 GetLength() const;
+
+			/*!
+			 * \return The sheet frame shown time milliseconds into one pass,
+			 * or -1 if there are no frames.
+			 */
+			int GetFrameAt(Uint32 time) const;
+		private:
+			Animation(const Animation &copy);
+			Animation &operator =(const Animation &copy);
+
+			const SpriteSheet *m_Sheet;
+			Mode m_Mode;
+			std::vector<int> m_Frames;
+			/*! When each frame ends */
+			std::vector<Uint32> m_Ends;
+			/*! Every frame's duration if they're all the same, otherwise 0 */
+			Uint32 m_Uniform;
+	};
+
+	/*!
+	 * \brief One playing Animation and where it's drawn.
+	 *
+	 * A sprite is small (24 bytes on 64-bit machines) and holds no pixels,
+	 * so thousands of them can be kept in a SpriteBatch and updated
+	 * together.
+	 */
+	class AnimatedSprite
+	{
+		public:
+			/*!
+			 * \brief A sprite with no animation, which is never drawn.
+			 */
+			AnimatedSprite();
+
+			/*!
+			 * \brief Start playing animation at (x, y).
+			 */
+			explicit AnimatedSprite(const Animation &animation, Sint16 x = 0,
+									Sint16 y = 0);
+
+			/*!
+			 * \brief Play animation from the start.
+			 */
+			void Play(const Animation &animation);
+
+			/*!
+			 * \brief Stop advancing.
+			 */
+			void Pause();
+
+			/*!
+			 * \brief Advance again after Pause().
+			 */
+			void Resume();
+
+			/*!
+			 * \return True unless paused or a Once animation has ended.
+			 */
+			bool IsPlaying() const;
+
+			/*!
+			 * \return True if a Once animation has reached its end.
+			 */
+			bool IsFinished() const;
+
+			/*!
+			 * \brief Play speed times as fast, 1.0 is normal.
+			 *
+			 * Kept to 1/256th, between 0 and 255.
+			 */
+			void SetSpeed(double speed);
+
+			/*!
+			 * \brief Move the sprite's upper left corner to (x, y).
+			 */
+			void SetPosition(Sint16 x, Sint16 y);
+
+			Sint16 GetX() const;
+			Sint16 GetY() const;
+
+			/*!
+			 * \brief Advance by ms milliseconds.
+			 */
+			void Update(Uint32 ms);
+
+			/*!
+			 * \return The current sheet frame, or -1 with no animation.
+			 */
+			int GetFrame() const;
+
+			/*!
+			 * \return The animation playing, or NULL.
+			 */
+			const Animation *GetAnimation() const;
+		private:
+			enum
+			{
+				Playing = 1,
+				Finished = 2
+			};
+
+			const Animation *m_Animation;
+			/*! Position in the animation in 1/256ths of a millisecond */
+			Uint32 m_Time;
+			Sint16 m_X, m_Y;
+			/*! 8.8 fixed point */
+			Uint16 m_Speed;
+			Sint16 m_Frame;
+			Uint8 m_Flags;
+	};
+
+	/*!
+	 * \brief A blit for a batch blitter.
+	 */
+	struct SpriteDraw
+	{
+		const Surface *surface;
+		SDL_Rect src;
+		Sint16 x, y;
+	};
+
+	/*!
+	 * \brief Many AnimatedSprites kept together and updated in one go.
+	 *
+	 * Sprites are stored in one array and drawn in the order they're in, so
+	 * later ones are on top.
+	 *
+	 * \code
+	 * SDL::SpriteBatch crowd;
+	 * for(int i = 0; i < 1000; i++)
+	 *	crowd.Add(walk, rand() % 640, rand() % 480);
+	 *
+	 * // every frame
+	 * crowd.Update(elapsed);
+	 * crowd.Draw(screen);
+	 * \endcode
+	 */
+	class SpriteBatch
+	{
+		public:
+			/*!
+			 * \brief Default constructor.
+			 */
+			SpriteBatch();
+
+			/*!
+			 * \brief Add a sprite playing animation at (x, y).
+			 *
+			 * \return Its index.
+			 */
+			int Add(const Animation &animation, Sint16 x, Sint16 y);
+
+			/*!
+			 * \brief Remove sprite index, the last sprite takes its index.
+			 */
+			void Remove(int index);
+
+			/*!
+			 * \brief Remove every sprite.
+			 */
+			void Clear();
+
+			/*!
+			 * \return The number of sprites.
+			 */
+			int GetCount() const;
+
+			/*!
+			 * \return Sprite index.
+			 */
+			AnimatedSprite &operator [](int index);
+
+			/*!
+			 * \brief Advance every sprite by ms milliseconds.
+			 */
+			void Update(Uint32 ms);
+
+			/*!
+			 * \brief List a blit for every sprite with a frame, in order.
+			 *
+			 * The list is rebuilt on each call and stays valid until the
+			 * next.
+			 */
+			const std::vector<SpriteDraw> &GetDraws();
+
+			/*!
+			 * \brief Blit every sprite to dst.
+			 *
+			 * \return False if any blit failed.
+			 */
+			bool Draw(Surface &dst);
+		private:
+			std::vector<AnimatedSprite> m_Sprites;
+			std::vector<SpriteDraw> m_Draws;
+	};
+	//@}
+}
+
+#endif
@@ -0,0 +1,198 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SDL4CPP_TEXTURE_H
+#define SDL4CPP_TEXTURE_H
+
+#include <vector>
+#include "SDL4Cpp_video.h"
+
+namespace SDL
+{
+	namespace GL
+	{
+		/*!
+		 * \brief An OpenGL texture kept up to date with a Surface.
+		 *
+		 * FromSurface() picks a GL format and type that read the surface's
+		 * pixels as they are, so 32-bit, 24-bit and 16-bit RGB surfaces of
+		 * the usual layouts go to GL straight from Surface::Get()->pixels.
+		 * GL_UNPACK_ROW_LENGTH and the skip rows and pixels let GL step
+		 * over the pitch, so Update() can send just the rectangles that
+		 * changed without copying them out first. Other surfaces, like 8-bit
+		 * ones, are converted a rectangle at a time into a buffer.
+		 *
+		 * With more than one buffer the texture streams: each Update()
+		 * writes the next of several GL textures, so it doesn't have to wait
+		 * for GL to finish drawing with the one written last. Every texture
+		 * is also sent the rectangles that changed since it was written
+		 * last, so they all stay complete.
+		 *
+		 * \code
+		 * SDL::GL::Texture texture;
+		 * texture.FromSurface(canvas, 2);
+		 *
+		 * // every frame
+		 * canvas.FillRect(dirty, color);
+		 * texture.Update(canvas, dirty);
+		 * texture.Bind();
+		 * // draw a quad from (0, 0) to (GetMaxU(), GetMaxV())
+		 * \endcode
+		 *
+		 * A Screen has to be set with SDL_OPENGL first. If the size isn't
+		 * a power of two and GL can't do those, the texture is made the next
+		 * power of two up and only the upper left part is used. The last
+		 * column and row are repeated into the padding, so GL_LINEAR
+		 * doesn't blend it into the right and bottom edges.
+		 *
+		 * \note Uploads leave GL_UNPACK_ALIGNMENT at 4 and the row length
+		 * and skips at 0, which is what GL starts with.
+		 */
+		class Texture
+		{
+			public:
+				/*!
+				 * \brief Make an empty texture.
+				 */
+				Texture();
+
+				/*!
+				 * \brief Deletes the GL textures if the GL context they were
+				 * made in is still there.
+				 */
+				~Texture();
+
+				/*!
+				 * \brief Make buffers GL textures with surface's size and
+				 * pixels.
+				 *
+				 * \return False if the surface is bigger than GL allows or
+				 * couldn't be locked.
+				 *
+				 * \throws SDL::LogicError if surface is empty or no Screen
+				 * has been set.
+				 */
+				bool FromSurface(Surface &surface, int buffers = 1);
+
+				/*!
+				 * \brief Send all of surface.
+				 *
+				 * If surface isn't the size and format the texture was made
+				 * with, FromSurface() is called again instead.
+				 *
+				 * \sa Update(Surface &, int, const Rect *)
+				 */
+				bool Update(Surface &surface);
+
+				/*!
+				 * \brief Send the rect part of surface.
+				 *
+				 * \sa Update(Surface &, int, const Rect *)
+				 */
+				bool Update(Surface &surface, const Rect &rect);
+
+				/*!
+				 * \brief Send the numrects rectangles of surface that changed
+				 * to the next buffer, which becomes the one Bind() uses.
+				 *
+				 * Rectangles are clipped to the surface.
+				 *
+				 * \return False if the surface couldn't be locked.
+				 *
+				 * \throws SDL::LogicError if surface is empty.
+				 */
+				bool Update(Surface &surface, int numrects, const Rect *rects);
+
+				/*!
+				 * \brief Bind the buffer Update() wrote last to
+				 * GL_TEXTURE_2D.
+				 */
+				void Bind();
+
+				/*!
+				 * \return The GL name of the buffer Update() wrote last, or
+				 * 0 if the texture is empty.
+				 */
+				Uint32 GetName() const;
+
+				/*!
+				 * \return The width of the surface.
+				 */
+				int GetWidth() const;
+
+				/*!
+				 * \return The height of the surface.
+				 */
+				int GetHeight() const;
+
+				/*!
+				 * \return The texture coordinate of the surface's right edge,
+				 * 1 unless the texture had to be padded.
+				 */
+				float GetMaxU() const;
+
+				/*!
+				 * \return The texture coordinate of the surface's bottom
+				 * edge.
+				 */
+				float GetMaxV() const;
+
+				/*!
+				 * \brief Delete the GL textures.
+				 */
+				void Free();
+			private:
+				Texture(const Texture &copy);
+				Texture &operator =(const Texture &copy);
+
+				/*!
+				 * \brief Send rect of s to buffer.
+				 */
+				void Upload(SDL_Surface *s, int buffer, const SDL_Rect &rect);
+
+				/*!
+				 * \brief Send rect of s to (x, y) of the bound texture.
+				 */
+				void Send(SDL_Surface *s, const SDL_Rect &rect, int x, int y);
+
+				/*!
+				 * \return True if s has the size and format the textures were
+				 * made with.
+				 */
+				bool Matches(const SDL_Surface *s) const;
+
+				/*! One GL texture per buffer */
+				std::vector<Uint32> m_Names;
+				/*! Per buffer, what changed since it was last written */
+				std::vector<std::vector<SDL_Rect> > m_Pending;
+				int m_Current;
+				/*! GL::GetContext() when the textures were made */
+				Uint32 m_Context;
+				int m_Width, m_Height;
+				int m_TextureWidth, m_TextureHeight;
+				/*! The surface format the textures were made for */
+				Uint8 m_Bpp;
+				Uint32 m_Rmask, m_Gmask, m_Bmask, m_Amask;
+				/*! GL format and type for glTexSubImage2D() */
+				Uint32 m_Format, m_Type;
+				/*! Pixels go through m_Buffer as RGBA bytes */
+				bool m_Convert;
+				std::vector<Uint8> m_Buffer;
+		};
+	}
+}
+
+#endif
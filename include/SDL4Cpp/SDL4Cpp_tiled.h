@@ -0,0 +1,236 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SDL4CPP_TILED_H
+#define SDL4CPP_TILED_H
+
+#include <vector>
+#include "SDL4Cpp_video.h"
+#include "SDL4Cpp_filter.h"
+
+namespace SDL
+{
+	/*!
+	 * \addtogroup Video
+	 */
+	//@{
+
+	/*!
+	 * \brief How a TiledSurface orders its pixels.
+	 */
+	enum TileLayout
+	{
+		/*! 8x8 tiles of 256 bytes, rows in order inside each */
+		TileLayout8x8,
+		/*! 16x16 tiles of 1k, rows in order inside each */
+		TileLayout16x16,
+		/*! 32x32 tiles of 4k, in Morton (Z) order inside each, so every
+		 * 2x2, 4x4, 8x8 and 16x16 block is together too */
+		TileLayoutMorton
+	};
+
+	/*!
+	 * \brief 32-bit pixels stored a square tile at a time instead of a row
+	 * at a time.
+	 *
+	 * In a Surface, going down a column reads a new cache line for every
+	 * row, so rotating, blurring down columns and the like miss the cache
+	 * all the time on big surfaces. Here the pixels above and below one are
+	 * in the same tile, so those touch a few tiles' worth of memory
+	 * instead. Going along a row is a little slower, since a row is cut up
+	 * into tile widths.
+	 *
+	 * Load() and Store() copy to and from a Surface, and Blit() draws onto
+	 * one for showing, with the colorkey and alpha the pixels were loaded
+	 * with. Widths and heights don't have to be multiples of the tile
+	 * size, but memory for whole tiles is used.
+	 *
+	 * \code
+	 * SDL::TiledSurface tiled(SDL::TileLayout16x16);
+	 * tiled.Load(map);
+	 * tiled.Rotate90(tiled, 1);
+	 * tiled.GaussianBlur(2.0);
+	 * tiled.Blit(screen, 0, 0);
+	 * \endcode
+	 */
+	class TiledSurface
+	{
+		public:
+			/*!
+			 * \brief Make an empty surface that will use layout.
+			 */
+			explicit TiledSurface(TileLayout layout = TileLayout8x8);
+
+			/*!
+			 * \brief Destructor.
+			 */
+			~TiledSurface();
+
+			/*!
+			 * \brief Make a width x height surface with the given masks,
+			 * filled with 0s.
+			 */
+			void Create(int width, int height, Uint32 Rmask, Uint32 Gmask,
+						Uint32 Bmask, Uint32 Amask);
+
+			/*!
+			 * \brief Release the pixels.
+			 */
+			void Free();
+
+			/*!
+			 * \brief Copy src's pixels, format, colorkey and alpha.
+			 *
+			 * \return False if src isn't 32-bit or couldn't be locked.
+			 *
+			 * \throws SDL::LogicError if src is empty.
+			 */
+			bool Load(Surface &src);
+
+			/*!
+			 * \brief Copy the pixels into dst, which is created like this
+			 * surface if it's empty or a different size or format.
+			 *
+			 * \return False if dst couldn't be created or locked.
+			 *
+			 * \throws SDL::LogicError if this surface is empty.
+			 */
+			bool Store(Surface &dst) const;
+
+			/*!
+			 * \brief Blit the surface to dst with its upper left corner at
+			 * (x, y), with the colorkey and alpha it was loaded with.
+			 *
+			 * A band of tiles at a time is put in row order in a small
+			 * buffer and blitted from there.
+			 *
+			 * \return False if a blit failed.
+			 *
+			 * \throws SDL::LogicError if either surface is empty.
+			 */
+			bool Blit(Surface &dst, Sint16 x, Sint16 y) const;
+
+			/*!
+			 * \brief Copy src onto this surface with its upper left corner at
+			 * (x, y), leaving out src's colorkeyed pixels if it has one.
+			 * Alpha isn't blended.
+			 *
+			 * \return False if src has different masks.
+			 *
+			 * \throws SDL::LogicError if either surface is empty.
+			 */
+			bool Blit(const TiledSurface &src, int x, int y);
+
+			/*!
+			 * \brief Put the surface turned clockwise by turns quarter
+			 * turns into dst, which may be this surface.
+			 *
+			 * dst keeps its own layout. The surface is walked a tile of dst
+			 * at a time, which reads from only a tile or two of this one.
+			 *
+			 * \throws SDL::LogicError if this surface is empty.
+			 */
+			void Rotate90(TiledSurface &dst, int turns) const;
+
+			/*!
+			 * \brief Convolve the surface with horizontal along the rows and
+			 * vertical down the columns.
+			 *
+			 * Works like SDL::Convolve(), with the same precision and
+			 * edges, on 64x64 blocks that are gathered out of the tiles
+			 * with the kernels' reach around them.
+			 *
+			 * \throws SDL::LogicError if the surface is empty.
+			 *
+			 * \sa SDL::Convolve()
+			 */
+			void Convolve(const Kernel &horizontal, const Kernel &vertical);
+
+			/*!
+			 * \brief Blur with a Gaussian of standard deviation sigma.
+			 */
+			void GaussianBlur(double sigma);
+
+			/*!
+			 * \brief Blur with a 2 * radius + 1 square box.
+			 */
+			void BoxBlur(int radius);
+
+			/*!
+			 * \return Pixel (x, y), which has to be inside the surface.
+			 */
+			Uint32 GetPixel(int x, int y) const;
+
+			/*!
+			 * \brief Set pixel (x, y), which has to be inside the surface.
+			 */
+			void SetPixel(int x, int y, Uint32 pixel);
+
+			/*!
+			 * \return The width in pixels.
+			 */
+			int GetWidth() const;
+
+			/*!
+			 * \return The height in pixels.
+			 */
+			int GetHeight() const;
+
+			/*!
+			 * \return How the pixels are ordered.
+			 */
+			TileLayout GetLayout() const;
+		private:
+			TiledSurface(const TiledSurface &copy);
+			TiledSurface &operator =(const TiledSurface &copy);
+
+			/*!
+			 * \brief Where pixel (x, y) is in m_Pixels.
+			 */
+			size_t Index(int x, int y) const;
+
+			/*!
+			 * \brief Copy n pixels of row y from x on out of pixels, which
+			 * is laid out like m_Pixels.
+			 */
+			void ReadRow(const Uint32 *pixels, int x, int y, int n,
+						 Uint32 *out) const;
+
+			/*!
+			 * \brief Copy n pixels from in to row y from x on in pixels.
+			 */
+			void WriteRow(Uint32 *pixels, int x, int y, int n,
+						  const Uint32 *in) const;
+
+			void Swap(TiledSurface &other);
+
+			TileLayout m_Layout;
+			/*! log2 of the tile size */
+			int m_Shift;
+			int m_Width, m_Height;
+			/*! Tiles in a row of tiles */
+			int m_Across;
+			std::vector<Uint32> m_Pixels;
+			Uint32 m_Rmask, m_Gmask, m_Bmask, m_Amask;
+			/*! SDL_SRCCOLORKEY, SDL_SRCALPHA and PREMULTIPLIED from Load() */
+			Uint32 m_Flags;
+			Uint32 m_ColorKey;
+			Uint8 m_Alpha;
+	};
+	//@}
+}
+
+#endif
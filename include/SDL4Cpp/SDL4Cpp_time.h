@@ -67,6 +67,16 @@ namespace SDL
 	 * \note That this value wraps if the program runs for more than ~49 days.
 	 */
 	Uint32 GetTicks(void);
+	/*!
+	 * \brief Get a high resolution time in microseconds.
+	 *
+	 * Unlike GetTicks() the count starts at some arbitrary point, so only
+	 * the difference between two calls means anything. It never goes
+	 * backwards, which makes it good for timing how long something takes.
+	 *
+	 * \return The current time in microseconds.
+	 */
+	Uint64 GetMicroTicks(void);
 	/*!
 	 * \brief Wait a specified number of milliseconds before returning.
 	 *
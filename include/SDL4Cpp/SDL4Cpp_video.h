@@ -18,6 +18,7 @@
 #define SDL4CPP_VIDEO_H
 
 #include <string>
+#include <vector>
 #include "SDL_video.h"
 
 namespace SDL
@@ -427,6 +428,67 @@ namespace SDL
 	 */
 	typedef SDL_Color Color;
 
+	/*!
+	 * \brief Conversions that can be done to a freshly loaded surface.
+	 */
+	enum Conversion
+	{
+		/*! Keep the surface in the format it was loaded in */
+		ConvertNone,
+		/*! Convert to the display format with SDL_DisplayFormat */
+		ConvertDisplay,
+		/*! Convert to the display format plus an alpha channel with
+		 * SDL_DisplayFormatAlpha */
+		ConvertDisplayAlpha,
+		/*! Like ConvertDisplayAlpha, then Surface::Premultiply() the
+		 * result */
+		ConvertDisplayPremultiplied
+	};
+
+	/*!
+	 * \brief Surface flag, set while a Surface's colors are premultiplied by
+	 * its alpha.
+	 *
+	 * It lives in SDL_Surface::flags next to SDL's own flags (in a bit
+	 * SDL 1.2 doesn't use), so it stays with the pixels when a surface is
+	 * shared. SDL itself ignores it.
+	 *
+	 * \sa Surface::Premultiply()
+	 */
+	const Uint32 PREMULTIPLIED = 0x00800000;
+
+	/*!
+	 * \brief How Surface::BlitTransformed() samples the source.
+	 */
+	enum Filter
+	{
+		/*! Take the closest source pixel, fast and blocky */
+		FilterNearest,
+		/*! Blend the four closest source pixels, smooth edges */
+		FilterBilinear
+	};
+
+	/*!
+	 * \brief What the last frame cost with Screen damage tracking on.
+	 *
+	 * \sa Screen::SetDamageTracking()
+	 */
+	struct DamageStats
+	{
+		/*! Tiles compared against the last frame */
+		int tiles;
+		/*! Tiles that were different and sent to the display */
+		int changed;
+		/*! Rectangles passed to SDL_UpdateRects() */
+		int rects;
+		/*! Microseconds spent comparing tiles and updating the shadow copy */
+		Uint32 comparetime;
+		/*! Bytes of pixels sent to the display */
+		Uint32 updated;
+		/*! Bytes a full screen update would have sent on top of that */
+		Uint32 saved;
+	};
+
 	/*!
 	 * Documention not written yet.
 	 */
@@ -448,6 +510,9 @@ namespace SDL
 	void GetRGBA(Uint32 pixel, PixelFormat &fmt, Uint8 &r, Uint8 &g, Uint8 &b,
 				  Uint8 &a);
 
+	class ColorMatrix;
+	class MipChain;
+
 	/*!
 	 * \brief Graphical Surface Structure.
 	 *
@@ -710,6 +775,138 @@ namespace SDL
 			friend bool Blit(Rect &srcrect, const Surface &src, Rect &destrect,
 							 Surface &dest);
 
+			/*!
+			 * \brief Blit src rotated and scaled, centered on (x, y).
+			 *
+			 * angle is in degrees counterclockwise and scale is the size
+			 * compared to src, so this replaces building a rotated copy of
+			 * src for every angle. Every pixel in the bounding box of the
+			 * result is mapped back into src by adding fixed point steps, and
+			 * nothing is allocated.
+			 *
+			 * src's colorkey, per-surface alpha and alpha channel are
+			 * blended like SDL_BlitSurface does. With FilterBilinear the
+			 * edges of src are anti-aliased as well.
+			 *
+			 * \return True if the blit was sucessfull. otherwise false.
+			 *
+			 * \throws SDL::LogicError if either Surface::m_Surface is NULL.
+			 */
+			bool BlitTransformed(const Surface &src, int x, int y, double angle,
+								 double scale = 1.0,
+								 Filter filter = FilterNearest);
+
+			/*!
+			 * \brief Blit the srcrect part of src rotated and scaled, centered
+			 * on (x, y).
+			 *
+			 * \sa BlitTransformed(const Surface &, int, int, double, double, Filter)
+			 */
+			bool BlitTransformed(Rect &srcrect, const Surface &src, int x, int y,
+								 double angle, double scale = 1.0,
+								 Filter filter = FilterNearest);
+
+			/*!
+			 * \brief Move the pixels inside rect by (dx, dy).
+			 *
+			 * The pixels are moved in place, row by row, so the source and
+			 * destination may overlap. Pixels moved outside rect are dropped.
+			 * The strips of rect left behind keep their old pixels and are
+			 * written to exposed, so only they have to be redrawn instead of
+			 * the whole of rect. rect is clipped to the surface.
+			 *
+			 * \return The number of exposed strips (0 to 2), or -1 if the
+			 * surface couldn't be locked.
+			 *
+			 * \throws SDL::LogicError if m_Surface is NULL.
+			 *
+			 * \sa Scroller
+			 */
+			int Scroll(int dx, int dy, const Rect &rect, Rect exposed[2]);
+
+			/*!
+			 * \brief Move the whole surface by (dx, dy).
+			 *
+			 * \sa Scroll(int, int, const Rect &, Rect [])
+			 */
+			int Scroll(int dx, int dy, Rect exposed[2]);
+
+			/*!
+			 * \brief Transform the color of every pixel by matrix.
+			 *
+			 * One pass over the pixels, four at a time with SSE2, with no
+			 * GetRGBA()/MapRGBA() per pixel. Matrices that only scale and
+			 * offset each channel, like ColorMatrix::Tint(), take a faster
+			 * path than ones that mix channels. With SDL_SRCCOLORKEY set,
+			 * colorkeyed pixels are left alone.
+			 *
+			 * \return False if the surface isn't 32-bit with 8-bit
+			 * channels or couldn't be locked.
+			 *
+			 * \throws SDL::LogicError if m_Surface is NULL.
+			 */
+			bool ApplyColorMatrix(const ColorMatrix &matrix);
+
+			/*!
+			 * \brief Transform the color of the pixels in rect by matrix.
+			 *
+			 * \sa ApplyColorMatrix(const ColorMatrix &)
+			 */
+			bool ApplyColorMatrix(const ColorMatrix &matrix, const Rect &rect);
+
+			/*!
+			 * \brief Blit src with its colors transformed by matrix, with
+			 * its upper left corner at (x, y).
+			 *
+			 * A few rows of src at a time are transformed into a small
+			 * buffer and blitted with src's colorkey and alpha, so src isn't
+			 * changed and no copy of all of it is made. Colorkeyed pixels
+			 * are left alone so they stay see through, and other pixels
+			 * that would turn into the colorkey are moved off it by one.
+			 *
+			 * \return False if src isn't 32-bit with 8-bit channels or a
+			 * blit failed.
+			 *
+			 * \throws SDL::LogicError if either Surface::m_Surface is NULL.
+			 */
+			bool BlitColorMatrix(const Surface &src, Sint16 x, Sint16 y,
+								 const ColorMatrix &matrix);
+
+			/*!
+			 * \brief Blit the srcrect part of src transformed by matrix to
+			 * (x, y).
+			 *
+			 * \sa BlitColorMatrix(const Surface &, Sint16, Sint16, const ColorMatrix &)
+			 */
+			bool BlitColorMatrix(const Rect &srcrect, const Surface &src,
+								 Sint16 x, Sint16 y, const ColorMatrix &matrix);
+
+			/*!
+			 * \brief Fill chain with this surface at half, quarter, eighth...
+			 * size, down to 1x1.
+			 *
+			 * Every pixel of a level is the average of a 2x2 block of the
+			 * level before, four pixels at a time with SSE2. With gamma the
+			 * colors are averaged as light instead of as sRGB numbers, so
+			 * fine bright and dark detail doesn't fade to too dark a gray,
+			 * which is slower since it goes through tables a byte at a time,
+			 * without SSE2. Alpha is always averaged as it is. Surfaces with
+			 * an alpha channel should be premultiplied first, so the colors
+			 * of see through pixels don't leak into their neighbours.
+			 *
+			 * The levels are given this surface's colorkey, alpha and
+			 * PREMULTIPLIED flag. Building again with the same surface size
+			 * reuses the chain's memory.
+			 *
+			 * \return False if the surface isn't 32-bit with 8-bit channels
+			 * or couldn't be locked.
+			 *
+			 * \throws SDL::LogicError if m_Surface is NULL.
+			 *
+			 * \sa MipChain
+			 */
+			bool BuildMipChain(MipChain &chain, bool gamma = false);
+
 			/*!
 			 * Documention not written yet.
 			 */
@@ -735,10 +932,43 @@ namespace SDL
 			bool CreateRGBFrom(Surface &from);
 
 			/*!
-			 * Documention not written yet.
+			 * \brief Make this a copy of surface.
 			 */
 			bool Convert(Surface &surface);
 
+			/*!
+			 * \brief Make this a copy of surface in format.
+			 *
+			 * Works like SDL_ConvertSurface(), but conversions between 16, 24
+			 * and 32-bit RGB formats (RGB565 to ARGB8888, 24-bit BMPs to
+			 * 32-bit and so on) are done with SSE2 instead of SDL's generic
+			 * blitter.
+			 *
+			 * \param dither When going to fewer bits per color, like
+			 * ARGB8888 to RGB565, use a 4x4 ordered dither instead of
+			 * dropping the low bits, which hides banding in gradients. It's
+			 * ignored for surfaces with a colorkey, which has to stay exact.
+			 */
+			bool Convert(Surface &surface, PixelFormat &format, Uint32 flags,
+						 bool dither = false);
+
+			/*!
+			 * \brief Make this a copy of surface in the display format.
+			 *
+			 * Works like SDL_DisplayFormat(), using the same fast conversions
+			 * as Convert(Surface &, PixelFormat &, Uint32, bool).
+			 */
+			bool DisplayFormat(Surface &surface, bool dither = false);
+
+			/*!
+			 * \brief Make this a copy of surface in the display format plus
+			 * an alpha channel.
+			 *
+			 * Works like SDL_DisplayFormatAlpha(), so colorkeyed pixels become
+			 * transparent.
+			 */
+			bool DisplayFormatAlpha(Surface &surface);
+
 			/*!
 			 * Documention not written yet.
 			 */
@@ -752,13 +982,13 @@ namespace SDL
 			/*!
 			 * Documention not written yet.
 			 */
-			int SetColors(Color &colors, int firstcolor, int ncolors);
+			virtual int SetColors(Color &colors, int firstcolor, int ncolors);
 
 			/*!
 			 * Documention not written yet.
 			 */
-			int SetPalette(int flags, Color &colors, int firstcolor,
-						   int ncolors);
+			virtual int SetPalette(int flags, Color &colors, int firstcolor,
+								   int ncolors);
 
 			/*!
 			 * Documention not written yet.
@@ -770,6 +1000,41 @@ namespace SDL
 			 */
 			bool SetAlpha(Uint32 flag, Uint8 alpha);
 
+			/*!
+			 * \brief Multiply the colors by the alpha channel, and set
+			 * PREMULTIPLIED.
+			 *
+			 * Blits from a premultiplied surface with SDL_SRCALPHA set use
+			 * dst = src + dst * (1 - alpha), which is cheaper than SDL's
+			 * blend and done with SSE2/AVX2 when the formats match. Scaling
+			 * premultiplied pixels (see BlitTransformed()) also doesn't leave
+			 * dark fringes around the edges.
+			 *
+			 * Do this once after loading and converting, SDL's own
+			 * conversions don't know about premultiplied colors and drop the
+			 * flag.
+			 *
+			 * \return False if the surface isn't 32-bit with 8-bit channels
+			 * and an alpha channel.
+			 *
+			 * \throws SDL::LogicError if m_Surface is NULL.
+			 */
+			bool Premultiply();
+
+			/*!
+			 * \brief Divide the colors by alpha again, and clear PREMULTIPLIED.
+			 *
+			 * Colors of fully transparent pixels are lost, they become black.
+			 *
+			 * \throws SDL::LogicError if m_Surface is NULL.
+			 */
+			bool Unpremultiply();
+
+			/*!
+			 * \return True if PREMULTIPLIED is set.
+			 */
+			bool IsPremultiplied();
+
 			/*!
 			 * Documention not written yet.
 			 */
@@ -834,7 +1099,7 @@ namespace SDL
 			 * \note There isn't any functions to check for
 			 * CreateRGBSurfaceFrom(), so for now you should take care of that.
 			 */
-			void Free();
+			virtual void Free();
 		protected:
 			/*!
 			 * \brief The SDL_Surface for the Surface class.
@@ -980,12 +1245,51 @@ namespace SDL
 		 * corruption. In a Win32 build environment, APIENTRY should be defined
 		 * as __stdcall.
 		 *
+		 * Each name is only looked up once per video mode, after that the
+		 * address comes from a table that Screen::SetVideoMode() empties.
+		 *
 		 * \return the address of the GL function proc, or NULL if the function
 		 * is not found.
 		 * \throws SDL::LogicError if the Screen has not been initialized.
 		 */
 		void *GetProcAddress(const std::string proc);
 
+		/*!
+		 * \brief GetProcAddress() cast to the function pointer type T.
+		 *
+		 * \code
+		 * typedef void (APIENTRY *GenBuffers)(GLsizei, GLuint *);
+		 * GenBuffers genbuffers = SDL::GL::GetProc<GenBuffers>("glGenBuffersARB");
+		 * \endcode
+		 */
+		template<typename T>
+		T GetProc(const std::string proc)
+		{
+			return reinterpret_cast<T>(GetProcAddress(proc));
+		}
+
+		/*!
+		 * \brief Look up every name in the NULL terminated names at once.
+		 *
+		 * Call this after Screen::SetVideoMode() with the functions a
+		 * program needs, so they're checked up front and GetProc() only
+		 * reads the table after that.
+		 *
+		 * \return False if any of them wasn't found.
+		 * \throws SDL::LogicError if the Screen has not been initialized.
+		 */
+		bool LoadProcs(const char *const *names);
+
+		/*!
+		 * \brief Get a number that changes every time
+		 * Screen::SetVideoMode() is called.
+		 *
+		 * Setting the video mode can make a new GL context, which makes
+		 * function pointers from the old one no good. Code that keeps its
+		 * own pointers can compare this to know when to look them up again.
+		 */
+		Uint32 GetContext();
+
 		/*!
 		 * \brief Get the value of a special SDL/OpenGL attribute
 		 *
@@ -993,6 +1297,9 @@ namespace SDL
 		 * is useful after a call to Screen::SetVideoMode() to check whether
 		 * your attributes have been set as you expected.
 		 *
+		 * Each attribute is read from SDL once per video mode and kept, since
+		 * it can't change until the next Screen::SetVideoMode().
+		 *
 		 * \return true an sucess and false on an error.
 		 * \throws SDL::LogicError if the Screen has not been initialized.
 		 */
@@ -1023,6 +1330,8 @@ namespace SDL
 		void SwapBuffers(void);
 	}
 
+	class FrameRecorder;
+
 	/*!
 	 * \brief The Surface that represents the screen to be drawn to.
 	 *
@@ -1033,7 +1342,6 @@ namespace SDL
 	 *
 	 * Unwrapped Screen functions:
 	 * \code
-	 * SDL_Rect **SDL_ListModes(SDL_PixelFormat *format, Uint32 flags);
 	 * void SDL_GL_SwapBuffers(void );
 	 * int SDL_GL_SetAttribute(SDL_GLattr attr, int value);
 	 * int SDL_GL_GetAttribute(SDLGLattr attr, int *value);
@@ -1229,6 +1537,47 @@ namespace SDL
 			static int VideoModeOK(int w, int h, int bpp,
 								   Uint32 flags = SDL_SWSURFACE);
 
+			/*!
+			 * \brief Get the sizes available for format and flags.
+			 *
+			 * The list comes from SDL_ListModes() the first time it's asked
+			 * for with a format and flags, and after that from a cache, so
+			 * mode selection doesn't have to probe with VideoModeOK(). It's
+			 * sorted largest first, without duplicates. A NULL format means
+			 * the one GetVideoInfo() gives, as SDL does.
+			 *
+			 * \param any is set to true if every size is available, which
+			 * is usual for windowed modes, and the list is then empty.
+			 *
+			 * \return The sizes in the w and h of each Rect. The list is
+			 * empty if nothing is available.
+			 *
+			 * \sa FlushModes()
+			 */
+			static const std::vector<Rect> &ListModes(PixelFormat *format = NULL,
+													  Uint32 flags = SDL_FULLSCREEN,
+													  bool *any = NULL);
+
+			/*!
+			 * \brief Find the mode in ListModes() closest to w x h at bpp
+			 * bits per pixel.
+			 *
+			 * The smallest mode that's at least w x h is picked, so
+			 * the picture doesn't have to shrink, or the largest mode if
+			 * none is big enough. If every size is available mode is w x
+			 * h.
+			 *
+			 * \return False if nothing is available at bpp with flags.
+			 */
+			static bool BestMode(int w, int h, int bpp, Uint32 flags,
+								 Rect &mode);
+
+			/*!
+			 * \brief Forget the cached ListModes() lists, say after the video
+			 * subsystem has been restarted.
+			 */
+			static void FlushModes();
+
 			/*!
 			 * \brief Obtain the name of the video driver.
 			 *
@@ -1240,6 +1589,46 @@ namespace SDL
 			 */
 			static std::string VideoDriverName();
 
+			/*!
+			 * \brief Record every frame shown with a FrameRecorder.
+			 *
+			 * Flip() and UpdateRects() hand the screen to recorder before
+			 * showing it. The recorder isn't owned, pass NULL to detach it
+			 * before it's destroyed.
+			 */
+			static void SetRecorder(FrameRecorder *recorder);
+
+			/*!
+			 * \return The attached FrameRecorder, or NULL.
+			 */
+			static FrameRecorder *GetRecorder();
+
+			/*!
+			 * \brief Only send the parts of the screen that changed.
+			 *
+			 * With damage tracking on the Screen keeps a copy of the last
+			 * frame it showed. Flip() compares the screen against it in
+			 * tiles of tilesize x tilesize pixels and only passes the tiles
+			 * that changed to SDL_UpdateRects(). UpdateRects() does the
+			 * same, but only looks at tiles touching the given rectangles.
+			 *
+			 * This pays off for programs that redraw everything every frame
+			 * but only change a little of it. Hardware double buffered
+			 * screens always flip the whole screen, so they're left alone.
+			 */
+			static void SetDamageTracking(bool enable, int tilesize = 32);
+
+			/*!
+			 * \return True if damage tracking is on.
+			 */
+			static bool GetDamageTracking();
+
+			/*!
+			 * \return The statistics for the last frame shown with damage
+			 * tracking on.
+			 */
+			static DamageStats GetDamageStats();
+
 			/*!
 			 * \brief Get information about the video hardware.
 			 *
@@ -1446,11 +1835,6 @@ namespace SDL
 			 * \return True if m_Surface is non-NULL, or False otherwise.
 			 */
 			friend bool GetVideoSurface(Screen &vid);
-
-			friend bool GL::LoadLibrary(const std::string path);
-			friend void *GL::GetProcAddress(const std::string proc);
-			friend bool GL::GetAttribute(Attr attr, int &value);
-			friend bool GL:: SetAttribute(Attr attr, int value);
 	};
 
 	bool GetVideoSurface(Screen &vid);
@@ -1461,6 +1845,12 @@ namespace SDL
 	 * This is for anyone who wants overlays. I've never used them, so if
 	 * someone wants to expand upon this, then feel free to.
 	 *
+	 * When the video driver has no hardware overlays (the dummy and fbcon
+	 * drivers, for one) SDL converts YUV to RGB in plain C. Display() then
+	 * uses SDL4Cpp's own converter instead, which does 8 pixels at a time
+	 * with SSE2 and can scale smoothly with SetFilter(FilterBilinear).
+	 * Blit() converts into any 16, 24 or 32-bit Surface the same way.
+	 *
 	 * \note May need some work to play nice with Surface or Screen.
 	 */
 	class Overlay
@@ -1529,18 +1919,57 @@ namespace SDL
 			/*!
 			 * \brief Display the Overlay on the Screen.
 			 *
-			 * Documentation not written yet.
+			 * The overlay is scaled to destrect. Without a hardware
+			 * overlay, YV12, IYUV, YUY2, UYVY and YVYU are converted by
+			 * Blit() onto the display surface given to Create() (or the
+			 * video surface), which is then updated unless it's double
+			 * buffered. Anything else goes to SDL_DisplayYUVOverlay().
 			 *
 			 * \return True if it was able to be displayed, False otherwise.
+			 *
+			 * \throws SDL::LogicError if the Overlay is empty.
 			 */
 			bool Display(Rect &destrect);
 
+			/*!
+			 * \brief Convert the Overlay to RGB into dst, scaled to
+			 * destrect, whether there's a hardware overlay or not.
+			 *
+			 * Only the part inside dst's clip rectangle is drawn and
+			 * destrect is set to it, like a blit.
+			 *
+			 * \return False if the Overlay isn't YV12, IYUV, YUY2, UYVY or
+			 * YVYU, dst isn't 16, 24 or 32-bit RGB, or dst couldn't be
+			 * locked.
+			 *
+			 * \throws SDL::LogicError if the Overlay or dst is empty.
+			 */
+			bool Blit(Surface &dst, Rect &destrect, Filter filter = FilterNearest);
+
+			/*!
+			 * \brief Set how Display() scales when SDL4Cpp converts.
+			 *
+			 * FilterNearest, the default, looks like SDL's own scaling.
+			 */
+			void SetFilter(Filter filter);
+
+			/*!
+			 * \return How Display() scales when SDL4Cpp converts.
+			 */
+			Filter GetFilter() const;
+
 			/*!
 			 * \brief Free the Overlay.
 			 *
 			 * Documentation not written yet.
 			 */
 			void Free();
+
+			/*!
+			 * \brief Get the pointer to m_Overlay, for writing the pixels
+			 * between Lock() and Unlock().
+			 */
+			SDL_Overlay *Get();
 		protected:
 			/*!
 			 * \brief The main data for this class.
@@ -1548,6 +1977,10 @@ namespace SDL
 			 * Documentation not written yet.
 			 */
 			SDL_Overlay *m_Overlay;
+
+			/*! The display from Create(), NULL for the video surface */
+			SDL_Surface *m_Display;
+			Filter m_Filter;
 	};
 	//@}
 }
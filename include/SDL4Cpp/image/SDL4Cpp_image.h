@@ -19,15 +19,120 @@
 
 #include "SDL.h"
 #include <string>
+#include "SDL4Cpp_mt.h"
+#include "SDL4Cpp_rwops.h"
 
 namespace SDL
 {
+	class Image;
+	class LoadTask;
+
+	/*!
+	 * \brief Handle to an image being loaded by Image::LoadAsync().
+	 *
+	 * Works a bit like a future: it can be copied around freely, and all
+	 * copies refer to the same load. The decoded surface is handed over with
+	 * Get() once the load has finished.
+	 *
+	 * \code
+	 * SDL::ImageLoad level = SDL::Image::LoadAsync("level1.png",
+	 *			SDL::ConvertDisplay);
+	 * ...
+	 * // somewhere in the main loop, never blocks
+	 * if(level.Ready())
+	 * {
+	 *	SDL::Image image;
+	 *	if(!level.Get(image))
+	 *		cout << level.GetError() << endl;
+	 * }
+	 * \endcode
+	 */
+	class ImageLoad
+	{
+		public:
+			/*!
+			 * \brief Creates a handle that doesn't refer to any load.
+			 */
+			ImageLoad();
+			ImageLoad(const ImageLoad &copy);
+			~ImageLoad();
+
+			ImageLoad &operator =(const ImageLoad &copy);
+
+			/*!
+			 * \return True if this handle came from Image::LoadAsync().
+			 */
+			bool Valid();
+
+			/*!
+			 * \return True once the load has finished, either way.
+			 */
+			bool Ready();
+
+			/*!
+			 * \brief Block until the load has finished.
+			 *
+			 * \return True if the image was loaded.
+			 */
+			bool Wait();
+
+			/*!
+			 * \brief Hand the loaded surface over to image.
+			 *
+			 * The surface is given to the first caller only.
+			 *
+			 * \return False if the load hasn't finished, failed, or was
+			 * already taken.
+			 */
+			bool Get(Image &image);
+
+			/*!
+			 * \return The error message if the load failed.
+			 */
+			std::string GetError();
+
+			/*!
+			 * \brief The ID sent in data1 of the completion event.
+			 *
+			 * \see Image::LoadAsync()
+			 */
+			Uint32 GetID();
+		private:
+			friend class Image;
+			friend class LoadTask;
+
+			struct State;
+
+			explicit ImageLoad(State *state);
+			void Release();
+
+			State *m_State;
+	};
+
 	/*!
 	 * Documention not written yet.
 	 */
 	class Image : public Surface
 	{
 		public:
+			/*!
+			 * \brief Image file formats DetectFormat() can recognize.
+			 */
+			enum Format
+			{
+				FormatUnknown,
+				FormatBMP,
+				FormatPNM,
+				FormatXPM,
+				FormatXCF,
+				FormatPCX,
+				FormatGIF,
+				FormatJPG,
+				FormatTIF,
+				FormatPNG,
+				FormatLBM
+			};
+
 			Image();
 			~Image();
 
@@ -47,17 +152,79 @@ namespace SDL
 			 */
 			bool Load(std::string file);
 			/*!
-			 * old Load_RW
-			 * Documention not written yet.
+			 * \brief Load an image from src, whatever format it's in.
+			 *
+			 * The format is found with DetectFormat() and src is handed
+			 * straight to the matching LoadXXX_RW(). Anything else is
+			 * passed to IMG_Load_RW(). TGA has no signature, so use
+			 * Load(src, freesrc, "TGA") for those.
+			 *
+			 * \return True on success, False on an error.
 			 */
 			bool Load(SDL_RWops *src, int freesrc);
 
+			/*!
+			 * \brief Load an image on a worker thread.
+			 *
+			 * The file is decoded (and converted if convert isn't
+			 * ConvertNone) on one of the loader threads, so the calling
+			 * thread never blocks. Use the returned ImageLoad to check on it
+			 * and fetch the result.
+			 *
+			 * When the load finishes an SDL_USEREVENT is pushed onto the
+			 * event queue with user.code set to code, user.data1 set to the
+			 * ImageLoad's GetID() (cast to a pointer) and user.data2 NULL,
+			 * so an Event Handle can pick it up in User().
+			 *
+			 * \note ConvertDisplay and ConvertDisplayAlpha convert to the
+			 * display format of the video mode set when LoadAsync() is
+			 * called, and always give a software surface, since SDL's video
+			 * calls can't be made from the loader threads.
+			 */
+			static ImageLoad LoadAsync(std::string file,
+									   Conversion convert = ConvertNone,
+									   int code = 0);
+
+			/*!
+			 * \brief Set the number of loader threads.
+			 *
+			 * Waits for any loads in flight first. Less than 1 means one per
+			 * CPU, which is the default.
+			 */
+			static void SetLoaderThreads(int threads);
+
+			/*!
+			 * \brief Wait for all loads and stop the loader threads.
+			 *
+			 * Call this before Quit(). The threads are started again by the
+			 * next LoadAsync().
+			 */
+			static void StopLoader();
+
 			/*!
 			 * Invert the alpha of a surface for use with OpenGL
 			 * This function is now a no-op, and only provided for backwards compatibility.
 			 */
 			int InvertAlpha(int on);
 
+			/*!
+			 * \brief Find the format of the image at the current position of src.
+			 *
+			 * Reads the first few bytes once and checks them against every
+			 * format's signature, where each isXXX() does its own seek and
+			 * read. src is put back where it was afterwards.
+			 *
+			 * \return The format, or FormatUnknown.
+			 */
+			static Format DetectFormat(RWops &src);
+
+			/*!
+			 * \brief Find the format of the image at the current position of src.
+			 *
+			 * \see DetectFormat(RWops &)
+			 */
+			static Format DetectFormat(SDL_RWops *src);
+
 			/* Functions to detect a file type, given a seekable source */
 			/*!
 			 * Documention not written yet.
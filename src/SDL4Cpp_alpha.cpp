@@ -0,0 +1,410 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_video.h"
+#include "SDL4Cpp_blit.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace SDL
+{
+	/*!
+	 * \brief Private SDL4Cpp_alpha function
+	 *
+	 * Check if format is 32-bit with an 8-bit alpha channel and 8-bit colors.
+	 */
+	static bool IsARGB(const SDL_PixelFormat *format)
+	{
+		return format->BytesPerPixel == 4 && format->Amask && format->Rloss == 0 &&
+			format->Gloss == 0 && format->Bloss == 0 && format->Aloss == 0;
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_alpha function
+	 *
+	 * Premultiply n pixels whose alpha is byte A. x / 255 is done exactly
+	 * as (x + 128 + ((x + 128) >> 8)) >> 8, and the alpha bytes are put back
+	 * afterwards.
+	 */
+	template<int A>
+	static void PremultiplyRow(Uint32 *p, int n)
+	{
+		const Uint32 amask = 0xFFu << (A * 8);
+		int i = 0;
+
+	#if defined(__AVX2__)
+		{
+			__m256i zero = _mm256_setzero_si256();
+			__m256i half = _mm256_set1_epi16(128);
+			__m256i keep = _mm256_set1_epi32(amask);
+
+			for(; i + 8 <= n; i += 8)
+			{
+				__m256i pixels = _mm256_loadu_si256(reinterpret_cast<__m256i *>(p + i));
+				__m256i lo = _mm256_unpacklo_epi8(pixels, zero);
+				__m256i hi = _mm256_unpackhi_epi8(pixels, zero);
+				__m256i alo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lo, _MM_SHUFFLE(A, A, A, A)), _MM_SHUFFLE(A, A, A, A));
+				__m256i ahi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(hi, _MM_SHUFFLE(A, A, A, A)), _MM_SHUFFLE(A, A, A, A));
+
+				lo = _mm256_add_epi16(_mm256_mullo_epi16(lo, alo), half);
+				hi = _mm256_add_epi16(_mm256_mullo_epi16(hi, ahi), half);
+				lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+				hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+
+				__m256i result = _mm256_packus_epi16(lo, hi);
+				result = _mm256_or_si256(_mm256_andnot_si256(keep, result), _mm256_and_si256(keep, pixels));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(p + i), result);
+			}
+		}
+	#endif
+	#if defined(__SSE2__)
+		{
+			__m128i zero = _mm_setzero_si128();
+			__m128i half = _mm_set1_epi16(128);
+			__m128i keep = _mm_set1_epi32(amask);
+
+			for(; i + 4 <= n; i += 4)
+			{
+				__m128i pixels = _mm_loadu_si128(reinterpret_cast<__m128i *>(p + i));
+				__m128i lo = _mm_unpacklo_epi8(pixels, zero);
+				__m128i hi = _mm_unpackhi_epi8(pixels, zero);
+				__m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(A, A, A, A)), _MM_SHUFFLE(A, A, A, A));
+				__m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(A, A, A, A)), _MM_SHUFFLE(A, A, A, A));
+
+				lo = _mm_add_epi16(_mm_mullo_epi16(lo, alo), half);
+				hi = _mm_add_epi16(_mm_mullo_epi16(hi, ahi), half);
+				lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+				hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+				__m128i result = _mm_packus_epi16(lo, hi);
+				result = _mm_or_si128(_mm_andnot_si128(keep, result), _mm_and_si128(keep, pixels));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(p + i), result);
+			}
+		}
+	#endif
+
+		for(; i < n; i++)
+		{
+			Uint32 pixel = p[i];
+			Uint32 alpha = (pixel >> (A * 8)) & 0xFF;
+			Uint32 result = pixel & amask;
+
+			for(int c = 0; c < 4; c++)
+			{
+				if(c == A)
+					continue;
+
+				Uint32 x = ((pixel >> (c * 8)) & 0xFF) * alpha + 128;
+				result |= ((x + (x >> 8)) >> 8) << (c * 8);
+			}
+
+			p[i] = result;
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_alpha function
+	 *
+	 * dst = src + dst * (1 - alpha) for n pixels of the same format, whose
+	 * alpha is byte A. 1 - alpha is taken as (256 - (a + (a >> 7))) / 256 so
+	 * there's no divide. Runs of fully opaque or empty pixels, which most
+	 * sprites are made of, skip the math.
+	 */
+	template<int A>
+	static void BlendRow(const Uint32 *src, Uint32 *dst, int n)
+	{
+		const Uint32 amask = 0xFFu << (A * 8);
+		int i = 0;
+
+	#if defined(__AVX2__)
+		{
+			__m256i zero = _mm256_setzero_si256();
+			__m256i full = _mm256_set1_epi16(256);
+			__m256i alphas = _mm256_set1_epi32(amask);
+
+			for(; i + 8 <= n; i += 8)
+			{
+				__m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+				__m256i a = _mm256_and_si256(s, alphas);
+
+				if(_mm256_movemask_epi8(_mm256_cmpeq_epi32(a, alphas)) == -1)
+				{
+					_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), s);
+					continue;
+				}
+				if(_mm256_movemask_epi8(_mm256_cmpeq_epi32(s, zero)) == -1)
+					continue;
+
+				__m256i d = _mm256_loadu_si256(reinterpret_cast<__m256i *>(dst + i));
+				__m256i slo = _mm256_unpacklo_epi8(s, zero);
+				__m256i shi = _mm256_unpackhi_epi8(s, zero);
+				__m256i alo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(slo, _MM_SHUFFLE(A, A, A, A)), _MM_SHUFFLE(A, A, A, A));
+				__m256i ahi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(shi, _MM_SHUFFLE(A, A, A, A)), _MM_SHUFFLE(A, A, A, A));
+
+				alo = _mm256_sub_epi16(full, _mm256_add_epi16(alo, _mm256_srli_epi16(alo, 7)));
+				ahi = _mm256_sub_epi16(full, _mm256_add_epi16(ahi, _mm256_srli_epi16(ahi, 7)));
+
+				__m256i dlo = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), alo), 8);
+				__m256i dhi = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), ahi), 8);
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+					_mm256_packus_epi16(_mm256_add_epi16(slo, dlo), _mm256_add_epi16(shi, dhi)));
+			}
+		}
+	#endif
+	#if defined(__SSE2__)
+		{
+			__m128i zero = _mm_setzero_si128();
+			__m128i full = _mm_set1_epi16(256);
+			__m128i alphas = _mm_set1_epi32(amask);
+
+			for(; i + 4 <= n; i += 4)
+			{
+				__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+				__m128i a = _mm_and_si128(s, alphas);
+
+				if(_mm_movemask_epi8(_mm_cmpeq_epi32(a, alphas)) == 0xFFFF)
+				{
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), s);
+					continue;
+				}
+				if(_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xFFFF)
+					continue;
+
+				__m128i d = _mm_loadu_si128(reinterpret_cast<__m128i *>(dst + i));
+				__m128i slo = _mm_unpacklo_epi8(s, zero);
+				__m128i shi = _mm_unpackhi_epi8(s, zero);
+				__m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(slo, _MM_SHUFFLE(A, A, A, A)), _MM_SHUFFLE(A, A, A, A));
+				__m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(shi, _MM_SHUFFLE(A, A, A, A)), _MM_SHUFFLE(A, A, A, A));
+
+				alo = _mm_sub_epi16(full, _mm_add_epi16(alo, _mm_srli_epi16(alo, 7)));
+				ahi = _mm_sub_epi16(full, _mm_add_epi16(ahi, _mm_srli_epi16(ahi, 7)));
+
+				__m128i dlo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), alo), 8);
+				__m128i dhi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), ahi), 8);
+
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+					_mm_packus_epi16(_mm_add_epi16(slo, dlo), _mm_add_epi16(shi, dhi)));
+			}
+		}
+	#endif
+
+		for(; i < n; i++)
+		{
+			Uint32 s = src[i];
+			Uint32 alpha = (s >> (A * 8)) & 0xFF;
+
+			if(alpha == 255)
+			{
+				dst[i] = s;
+				continue;
+			}
+			if(s == 0)
+				continue;
+
+			Uint32 d = dst[i];
+			Uint32 inverse = 256 - (alpha + (alpha >> 7));
+
+			dst[i] = s + ((((d & 0x00FF00FF) * inverse) >> 8) & 0x00FF00FF) +
+				((((d >> 8) & 0x00FF00FF) * inverse) & 0xFF00FF00);
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_alpha function
+	 *
+	 * Premultiply h rows, picking A from the alpha shift.
+	 */
+	static void PremultiplyRows(Uint8 *pixels, int pitch, int w, int h, int ashift)
+	{
+		for(int y = 0; y < h; y++, pixels += pitch)
+		{
+			Uint32 *row = reinterpret_cast<Uint32 *>(pixels);
+			switch(ashift)
+			{
+				case 0: PremultiplyRow<0>(row, w); break;
+				case 8: PremultiplyRow<1>(row, w); break;
+				case 16: PremultiplyRow<2>(row, w); break;
+				default: PremultiplyRow<3>(row, w); break;
+			}
+		}
+	}
+
+	namespace Private
+	{
+		bool Premultiply(SDL_Surface *surface)
+		{
+			if(surface->flags & PREMULTIPLIED)
+				return true;
+
+			if(!IsARGB(surface->format))
+			{
+				SDL_SetError("Only 32-bit surfaces with an alpha channel can be premultiplied");
+				return false;
+			}
+
+			if(SDL_MUSTLOCK(surface) && SDL_LockSurface(surface) != 0)
+				return false;
+
+			PremultiplyRows(static_cast<Uint8 *>(surface->pixels), surface->pitch,
+				surface->w, surface->h, surface->format->Ashift);
+			surface->flags |= PREMULTIPLIED;
+
+			if(SDL_MUSTLOCK(surface))
+				SDL_UnlockSurface(surface);
+
+			return true;
+		}
+
+		int BlitPremultiplied(SDL_Surface *src, SDL_Rect *srcrect, SDL_Surface *dst, SDL_Rect *dstrect)
+		{
+			SDL_Rect s, d;
+
+			if(!ClipBlit(src, srcrect, dst, dstrect, s, d))
+				return 0;
+
+			if(SDL_MUSTLOCK(src) && SDL_LockSurface(src) != 0)
+				return -1;
+			if(SDL_MUSTLOCK(dst) && SDL_LockSurface(dst) != 0)
+			{
+				if(SDL_MUSTLOCK(src))
+					SDL_UnlockSurface(src);
+				return -1;
+			}
+
+			SDL_PixelFormat *sf = src->format, *df = dst->format;
+			bool same = IsARGB(sf) && df->BytesPerPixel == 4 && sf->Rmask == df->Rmask &&
+				sf->Gmask == df->Gmask && sf->Bmask == df->Bmask &&
+				(df->Amask == 0 || df->Amask == sf->Amask);
+
+			for(int y = 0; y < d.h; y++)
+			{
+				Uint8 *sp = PixelAddress(src, s.x, s.y + y);
+				Uint8 *dp = PixelAddress(dst, d.x, d.y + y);
+
+				if(same)
+				{
+					const Uint32 *srow = reinterpret_cast<const Uint32 *>(sp);
+					Uint32 *drow = reinterpret_cast<Uint32 *>(dp);
+
+					switch(sf->Ashift)
+					{
+						case 0: BlendRow<0>(srow, drow, d.w); break;
+						case 8: BlendRow<1>(srow, drow, d.w); break;
+						case 16: BlendRow<2>(srow, drow, d.w); break;
+						default: BlendRow<3>(srow, drow, d.w); break;
+					}
+					continue;
+				}
+
+				// Different formats, slowly through SDL
+				for(int x = 0; x < d.w; x++, sp += sf->BytesPerPixel, dp += df->BytesPerPixel)
+				{
+					Uint8 r, g, b, a, dr, dg, db, da;
+					SDL_GetRGBA(ReadPixel(sp, sf->BytesPerPixel), sf, &r, &g, &b, &a);
+					if(a == 0 && r == 0 && g == 0 && b == 0)
+						continue;
+
+					SDL_GetRGBA(ReadPixel(dp, df->BytesPerPixel), df, &dr, &dg, &db, &da);
+
+					unsigned int inverse = 255 - a;
+					r = static_cast<Uint8>(r + (dr * inverse + 127) / 255);
+					g = static_cast<Uint8>(g + (dg * inverse + 127) / 255);
+					b = static_cast<Uint8>(b + (db * inverse + 127) / 255);
+					a = static_cast<Uint8>(a + (da * inverse + 127) / 255);
+
+					WritePixel(dp, df->BytesPerPixel, SDL_MapRGBA(df, r, g, b, a));
+				}
+			}
+
+			if(SDL_MUSTLOCK(dst))
+				SDL_UnlockSurface(dst);
+			if(SDL_MUSTLOCK(src))
+				SDL_UnlockSurface(src);
+
+			return 0;
+		}
+	}
+
+	bool Surface::Premultiply()
+	{
+		if(m_Surface == NULL)
+			throw LogicError("m_Surface not intialized before call to Premultiply()");
+
+		return Private::Premultiply(m_Surface);
+	}
+
+	bool Surface::Unpremultiply()
+	{
+		if(m_Surface == NULL)
+			throw LogicError("m_Surface not intialized before call to Unpremultiply()");
+
+		if(!(m_Surface->flags & PREMULTIPLIED))
+			return true;
+
+		if(!Lock())
+			return false;
+
+		SDL_PixelFormat *format = m_Surface->format;
+		int ashift = format->Ashift;
+
+		for(int y = 0; y < m_Surface->h; y++)
+		{
+			Uint32 *row = reinterpret_cast<Uint32 *>(Private::PixelAddress(m_Surface, 0, y));
+
+			for(int x = 0; x < m_Surface->w; x++)
+			{
+				Uint32 pixel = row[x];
+				Uint32 alpha = (pixel >> ashift) & 0xFF;
+
+				if(alpha == 255)
+					continue;
+				if(alpha == 0)
+				{
+					row[x] = 0;
+					continue;
+				}
+
+				Uint32 result = pixel & format->Amask;
+				for(int c = 0; c < 32; c += 8)
+				{
+					if(c == ashift)
+						continue;
+
+					Uint32 value = (((pixel >> c) & 0xFF) * 255 + alpha / 2) / alpha;
+					result |= (value > 255 ? 255 : value) << c;
+				}
+
+				row[x] = result;
+			}
+		}
+
+		m_Surface->flags &= ~PREMULTIPLIED;
+		Unlock();
+
+		return true;
+	}
+
+	bool Surface::IsPremultiplied()
+	{
+		return m_Surface != NULL && (m_Surface->flags & PREMULTIPLIED);
+	}
+}
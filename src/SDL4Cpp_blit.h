@@ -0,0 +1,266 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+/*
+ * Private helpers shared by the SDL4Cpp software blitters. This header is
+ * not installed.
+ */
+
+#ifndef SDL4CPP_BLIT_H
+#define SDL4CPP_BLIT_H
+
+#include "SDL_video.h"
+
+namespace SDL
+{
+	namespace Private
+	{
+		/*!
+		 * \brief Clip a blit the same way SDL_UpperBlit() does.
+		 *
+		 * srcrect may be NULL for the whole source and dstrect may be NULL
+		 * for the upper left corner of dst. On return s and d hold the
+		 * clipped source and destination areas (which have the same size),
+		 * and dstrect (if non-NULL) is updated to the final blit area like
+		 * SDL does.
+		 *
+		 * \return False if nothing is left to draw.
+		 */
+		inline bool ClipBlit(SDL_Surface *src, SDL_Rect *srcrect,
+							 SDL_Surface *dst, SDL_Rect *dstrect,
+							 SDL_Rect &s, SDL_Rect &d)
+		{
+			int sx, sy, w, h;
+
+			if(srcrect)
+			{
+				sx = srcrect->x;
+				sy = srcrect->y;
+				w = srcrect->w;
+				h = srcrect->h;
+
+				if(sx < 0)
+				{
+					w += sx;
+					if(dstrect)
+						dstrect->x -= sx;
+					sx = 0;
+				}
+				if(sx + w > src->w)
+					w = src->w - sx;
+
+				if(sy < 0)
+				{
+					h += sy;
+					if(dstrect)
+						dstrect->y -= sy;
+					sy = 0;
+				}
+				if(sy + h > src->h)
+					h = src->h - sy;
+			}
+			else
+			{
+				sx = sy = 0;
+				w = src->w;
+				h = src->h;
+			}
+
+			int dx = dstrect ? dstrect->x : 0;
+			int dy = dstrect ? dstrect->y : 0;
+			const SDL_Rect &clip = dst->clip_rect;
+
+			if(dx < clip.x)
+			{
+				w -= clip.x - dx;
+				sx += clip.x - dx;
+				dx = clip.x;
+			}
+			if(dx + w > clip.x + clip.w)
+				w = clip.x + clip.w - dx;
+
+			if(dy < clip.y)
+			{
+				h -= clip.y - dy;
+				sy += clip.y - dy;
+				dy = clip.y;
+			}
+			if(dy + h > clip.y + clip.h)
+				h = clip.y + clip.h - dy;
+
+			if(w <= 0 || h <= 0)
+			{
+				if(dstrect)
+					dstrect->w = dstrect->h = 0;
+				return false;
+			}
+
+			s.x = sx;
+			s.y = sy;
+			d.x = dx;
+			d.y = dy;
+			s.w = d.w = w;
+			s.h = d.h = h;
+
+			if(dstrect)
+				*dstrect = d;
+
+			return true;
+		}
+
+		/*!
+		 * \brief Premultiply surface in place and set PREMULTIPLIED.
+		 *
+		 * \return False if it isn't 32-bit with an 8-bit alpha channel.
+		 */
+		bool Premultiply(SDL_Surface *surface);
+
+		/*!
+		 * \brief SDL_BlitSurface() for a premultiplied src.
+		 */
+		int BlitPremultiplied(SDL_Surface *src, SDL_Rect *srcrect,
+							  SDL_Surface *dst, SDL_Rect *dstrect);
+
+		/*!
+		 * \brief SDL_BlitSurface(), except premultiplied surfaces are
+		 * blended by SDL4Cpp since SDL doesn't know about them.
+		 */
+		int BlitSurface(SDL_Surface *src, SDL_Rect *srcrect,
+						SDL_Surface *dst, SDL_Rect *dstrect);
+
+		/*!
+		 * \brief SDL_ConvertSurface() with fast paths for 16, 24 and 32-bit
+		 * RGB formats.
+		 *
+		 * Other formats, and hardware surfaces, go to SDL_ConvertSurface().
+		 * If dither is true, colors losing bits get a 4x4 ordered dither
+		 * instead of being truncated, unless src has a colorkey that's kept.
+		 */
+		SDL_Surface *ConvertSurface(SDL_Surface *src, SDL_PixelFormat *format,
+									Uint32 flags, bool dither = false);
+
+		/*!
+		 * \brief A 1x1 software surface in the format DisplayFormat()
+		 * converts to, or NULL if there's no video mode.
+		 *
+		 * It holds its own copy of the format, palette included, so it
+		 * can be used off the main thread.
+		 */
+		SDL_Surface *DisplayTarget(bool alpha);
+
+		/*!
+		 * \brief SDL_DisplayFormat(), or SDL_DisplayFormatAlpha() if alpha
+		 * is true, through ConvertSurface().
+		 */
+		SDL_Surface *DisplayFormat(SDL_Surface *surface, bool alpha,
+								   bool dither = false);
+
+		/*!
+		 * \brief Vertical pass of a convolution: n bytes of rows weighted
+		 * into out, with 4 fraction bits.
+		 *
+		 * weights are 1.14 fixed point, padded with a 0 to an even number
+		 * of taps. Byte i comes from rows[k][offset + i].
+		 */
+		void VerticalRow(const Uint8 *const *rows, const Sint16 *weights,
+						 int taps, int offset, Sint16 *out, int n);
+
+		/*!
+		 * \brief Horizontal pass of a convolution: n 32-bit pixels out of
+		 * the VerticalRow() results in row, which start the kernel radius
+		 * to the left.
+		 *
+		 * row has to have a pixel to spare past the last tap.
+		 */
+		void HorizontalRow(const Sint16 *row, const Sint16 *weights,
+						   int taps, Uint8 *out, int n);
+
+		/*!
+		 * \brief Convert overlay to RGB into dst, scaled to dstrect.
+		 *
+		 * Only the part inside dst's clip rectangle is drawn, and dstrect
+		 * is set to it.
+		 *
+		 * \return False if overlay isn't YV12, IYUV, YUY2, UYVY or YVYU,
+		 * dst isn't 16, 24 or 32-bit RGB, or dst couldn't be locked.
+		 */
+		bool BlitYUV(SDL_Overlay *overlay, SDL_Surface *dst, SDL_Rect &dstrect,
+					 bool bilinear);
+
+		/*!
+		 * \brief Address of pixel (x, y) in surface.
+		 */
+		inline Uint8 *PixelAddress(SDL_Surface *surface, int x, int y)
+		{
+			return static_cast<Uint8 *>(surface->pixels) + y * surface->pitch +
+				x * surface->format->BytesPerPixel;
+		}
+
+		/*!
+		 * \brief The pixel at p, which is bpp bytes.
+		 */
+		inline Uint32 ReadPixel(const Uint8 *p, int bpp)
+		{
+			switch(bpp)
+			{
+				case 1:
+					return *p;
+				case 2:
+					return *reinterpret_cast<const Uint16 *>(p);
+				case 3:
+				#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+					return p[0] | (p[1] << 8) | (p[2] << 16);
+				#else
+					return (p[0] << 16) | (p[1] << 8) | p[2];
+				#endif
+				default:
+					return *reinterpret_cast<const Uint32 *>(p);
+			}
+		}
+
+		/*!
+		 * \brief Set the bpp byte pixel at p.
+		 */
+		inline void WritePixel(Uint8 *p, int bpp, Uint32 pixel)
+		{
+			switch(bpp)
+			{
+				case 1:
+					*p = static_cast<Uint8>(pixel);
+					break;
+				case 2:
+					*reinterpret_cast<Uint16 *>(p) = static_cast<Uint16>(pixel);
+					break;
+				case 3:
+				#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+					p[0] = static_cast<Uint8>(pixel);
+					p[1] = static_cast<Uint8>(pixel >> 8);
+					p[2] = static_cast<Uint8>(pixel >> 16);
+				#else
+					p[0] = static_cast<Uint8>(pixel >> 16);
+					p[1] = static_cast<Uint8>(pixel >> 8);
+					p[2] = static_cast<Uint8>(pixel);
+				#endif
+					break;
+				default:
+					*reinterpret_cast<Uint32 *>(p) = pixel;
+					break;
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,299 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <vector>
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_cache.h"
+#include "SDL4Cpp_blit.h"
+
+namespace SDL
+{
+	/*!
+	 * \brief Private SDL4Cpp_cache function
+	 *
+	 * The default loader, SDL_LoadBMP is a macro so it can't be used directly
+	 */
+	static SDL_Surface *LoadBMPFile(const char *file)
+	{
+		return SDL_LoadBMP(file);
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_cache function
+	 *
+	 * How many bytes a surface's pixels take up
+	 */
+	static Uint32 SurfaceBytes(SDL_Surface *surface)
+	{
+		Uint32 bytes = surface->pitch * surface->h;
+
+		if(surface->format->palette)
+			bytes += surface->format->palette->ncolors * sizeof(Color);
+
+		return bytes;
+	}
+
+	AssetCache::AssetCache(Uint32 budget) : m_Entries(), m_Index(),
+		m_Loader(LoadBMPFile), m_Budget(budget), m_Usage(0), m_Hits(0),
+		m_Misses(0), m_Evictions(0)
+	{
+	}
+
+	AssetCache::~AssetCache()
+	{
+		while(!m_Entries.empty())
+			Drop(m_Entries.begin());
+	}
+
+	bool AssetCache::Load(std::string file, Surface &surface, Conversion convert)
+	{
+		EntryList::iterator entry = Fetch(file, convert, true);
+		if(entry == m_Entries.end())
+			return false;
+
+		// The Surface gets its own reference, Surface::operator= drops
+		// whatever it held before
+		entry->surface->refcount++;
+		surface = entry->surface;
+
+		Evict();
+
+		return true;
+	}
+
+	bool AssetCache::Pin(std::string file, Conversion convert)
+	{
+		EntryList::iterator entry = Fetch(file, convert, true);
+		if(entry == m_Entries.end())
+			return false;
+
+		entry->pins++;
+		Evict();
+
+		return true;
+	}
+
+	bool AssetCache::Unpin(std::string file, Conversion convert)
+	{
+		EntryMap::iterator found = m_Index.find(MakeKey(file, convert));
+		if(found == m_Index.end() || found->second->pins == 0)
+			return false;
+
+		found->second->pins--;
+		Evict(false);
+
+		return true;
+	}
+
+	bool AssetCache::Contains(std::string file, Conversion convert)
+	{
+		return m_Index.find(MakeKey(file, convert)) != m_Index.end();
+	}
+
+	bool AssetCache::Remove(std::string file, Conversion convert)
+	{
+		EntryMap::iterator found = m_Index.find(MakeKey(file, convert));
+		if(found == m_Index.end())
+			return false;
+
+		Drop(found->second);
+
+		return true;
+	}
+
+	void AssetCache::Clear()
+	{
+		EntryList::iterator entry = m_Entries.begin();
+		while(entry != m_Entries.end())
+		{
+			EntryList::iterator next = entry;
+			++next;
+
+			if(entry->pins == 0)
+				Drop(entry);
+
+			entry = next;
+		}
+	}
+
+	void AssetCache::SetBudget(Uint32 budget)
+	{
+		m_Budget = budget;
+		Evict(false);
+	}
+
+	Uint32 AssetCache::GetBudget()
+	{
+		return m_Budget;
+	}
+
+	Uint32 AssetCache::GetUsage()
+	{
+		return m_Usage;
+	}
+
+	int AssetCache::GetCount()
+	{
+		return m_Index.size();
+	}
+
+	void AssetCache::SetLoader(Loader loader)
+	{
+		m_Loader = loader ? loader : LoadBMPFile;
+	}
+
+	Uint32 AssetCache::GetHits()
+	{
+		return m_Hits;
+	}
+
+	Uint32 AssetCache::GetMisses()
+	{
+		return m_Misses;
+	}
+
+	Uint32 AssetCache::GetEvictions()
+	{
+		return m_Evictions;
+	}
+
+	void AssetCache::ResetCounters()
+	{
+		m_Hits = m_Misses = m_Evictions = 0;
+	}
+
+	std::string AssetCache::NormalizePath(std::string path)
+	{
+		for(std::string::size_type i = 0; i < path.size(); i++)
+		{
+			if(path[i] == '\\')
+				path[i] = '/';
+		}
+
+		bool absolute = !path.empty() && path[0] == '/';
+		std::vector<std::string> parts;
+		std::string::size_type start = 0;
+
+		while(start <= path.size())
+		{
+			std::string::size_type end = path.find('/', start);
+			if(end == std::string::npos)
+				end = path.size();
+
+			std::string part = path.substr(start, end - start);
+			start = end + 1;
+
+			if(part.empty() || part == ".")
+				continue;
+
+			if(part == ".." && !parts.empty() && parts.back() != "..")
+				parts.pop_back();
+			else if(part != ".." || !absolute)
+				parts.push_back(part);
+		}
+
+		std::string normalized = absolute ? "/" : "";
+		for(unsigned int i = 0; i < parts.size(); i++)
+		{
+			if(i)
+				normalized += '/';
+			normalized += parts[i];
+		}
+
+		return normalized;
+	}
+
+	AssetCache::EntryList::iterator AssetCache::Fetch(const std::string &file,
+		Conversion convert, bool count)
+	{
+		std::string key = MakeKey(file, convert);
+		EntryMap::iterator found = m_Index.find(key);
+
+		if(found != m_Index.end())
+		{
+			if(count)
+				m_Hits++;
+
+			m_Entries.splice(m_Entries.begin(), m_Entries, found->second);
+
+			return m_Entries.begin();
+		}
+
+		if(count)
+			m_Misses++;
+
+		SDL_Surface *surface = m_Loader(file.c_str());
+		if(surface == NULL)
+			return m_Entries.end();
+
+		if(convert != ConvertNone)
+		{
+			SDL_Surface *converted = Private::DisplayFormat(surface, convert != ConvertDisplay);
+			SDL_FreeSurface(surface);
+
+			if(converted == NULL)
+				return m_Entries.end();
+			if(convert == ConvertDisplayPremultiplied)
+				Private::Premultiply(converted);
+
+			surface = converted;
+		}
+
+		Entry entry;
+		entry.key = key;
+		entry.surface = surface;
+		entry.bytes = SurfaceBytes(surface);
+		entry.pins = 0;
+
+		m_Entries.push_front(entry);
+		m_Index[key] = m_Entries.begin();
+		m_Usage += entry.bytes;
+
+		return m_Entries.begin();
+	}
+
+	void AssetCache::Evict(bool keepfront)
+	{
+		EntryList::iterator entry = m_Entries.end();
+		while(m_Usage > m_Budget && entry != m_Entries.begin())
+		{
+			--entry;
+			if(keepfront && entry == m_Entries.begin())
+				break;
+
+			if(entry->pins != 0)
+				continue;
+
+			EntryList::iterator dropped = entry++;
+			Drop(dropped);
+			m_Evictions++;
+		}
+	}
+
+	void AssetCache::Drop(EntryList::iterator entry)
+	{
+		m_Usage -= entry->bytes;
+		m_Index.erase(entry->key);
+		SDL_FreeSurface(entry->surface);
+		m_Entries.erase(entry);
+	}
+
+	std::string AssetCache::MakeKey(const std::string &file, Conversion convert)
+	{
+		// A newline can't be in any sane path, so it separates the parts
+		return NormalizePath(file) + '\n' + static_cast<char>('0' + convert);
+	}
+}
@@ -0,0 +1,302 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_collide.h"
+#include "SDL4Cpp_blit.h"
+
+namespace SDL
+{
+	/*!
+	 * \brief Private SDL4Cpp_collide function
+	 *
+	 * The number of bits set.
+	 */
+	static inline Uint32 PopCount(Uint64 bits)
+	{
+#if defined(__GNUC__)
+		return __builtin_popcountll(bits);
+#else
+		bits = bits - ((bits >> 1) & 0x5555555555555555ULL);
+		bits = (bits & 0x3333333333333333ULL) + ((bits >> 2) & 0x3333333333333333ULL);
+		bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		return static_cast<Uint32>((bits * 0x0101010101010101ULL) >> 56);
+#endif
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_collide function
+	 *
+	 * The 64 bits of row starting at bit, which may start before or run
+	 * past the end of the row's words. Bits outside the row are clear.
+	 */
+	static inline Uint64 Fetch(const Uint64 *row, int words, int bit)
+	{
+		int word = bit >= 0 ? bit / 64 : -((63 - bit) / 64);
+		int shift = bit - word * 64;
+
+		Uint64 low = word >= 0 && word < words ? row[word] : 0;
+		if(shift == 0)
+			return low;
+
+		Uint64 high = word + 1 >= 0 && word + 1 < words ? row[word + 1] : 0;
+		return (low >> shift) | (high << (64 - shift));
+	}
+
+	CollisionMask::CollisionMask() : m_Width(0), m_Height(0), m_Words(0), m_Bits()
+	{
+	}
+
+	CollisionMask::CollisionMask(Surface &surface, Uint8 threshold) : m_Width(0),
+		m_Height(0), m_Words(0), m_Bits()
+	{
+		if(surface.Get() == NULL)
+			throw LogicError("surface not initialized before call to CollisionMask(Surface, Uint8)");
+
+		Build(surface, Rect(0, 0, surface.Get()->w, surface.Get()->h), threshold);
+	}
+
+	CollisionMask::CollisionMask(Surface &surface, const Rect &srcrect, Uint8 threshold) :
+		m_Width(0), m_Height(0), m_Words(0), m_Bits()
+	{
+		Build(surface, srcrect, threshold);
+	}
+
+	bool CollisionMask::Build(Surface &surface, const Rect &srcrect, Uint8 threshold)
+	{
+		SDL_Surface *s = surface.Get();
+		if(s == NULL)
+			throw LogicError("surface not initialized before call to CollisionMask::Build(Surface, Rect, Uint8)");
+
+		// Only the part of srcrect that's inside the surface
+		int sx = srcrect.x < 0 ? 0 : srcrect.x;
+		int sy = srcrect.y < 0 ? 0 : srcrect.y;
+		int sw = (srcrect.x + srcrect.w < s->w ? srcrect.x + srcrect.w : s->w) - sx;
+		int sh = (srcrect.y + srcrect.h < s->h ? srcrect.y + srcrect.h : s->h) - sy;
+
+		m_Width = sw > 0 ? sw : 0;
+		m_Height = sh > 0 ? sh : 0;
+		m_Words = (m_Width + 63) / 64;
+		m_Bits.assign(m_Words * m_Height, 0);
+
+		if(m_Bits.empty())
+			return true;
+
+		const SDL_PixelFormat *format = s->format;
+		bool colorkey = (s->flags & SDL_SRCCOLORKEY) != 0;
+		bool perpixel = format->Amask != 0;
+
+		// A see through surface has nothing solid
+		if(!perpixel && (s->flags & SDL_SRCALPHA) && format->alpha < threshold)
+			return true;
+
+		if(!surface.Lock())
+		{
+			m_Width = m_Height = m_Words = 0;
+			m_Bits.clear();
+			return false;
+		}
+
+		int bpp = format->BytesPerPixel;
+		for(int y = 0; y < m_Height; y++)
+		{
+			const Uint8 *p = Private::PixelAddress(s, sx, sy + y);
+			Uint64 *row = &m_Bits[y * m_Words];
+
+			for(int x = 0; x < m_Width; x++, p += bpp)
+			{
+				Uint32 pixel = Private::ReadPixel(p, bpp);
+
+				if(colorkey && pixel == format->colorkey)
+					continue;
+				if(perpixel && (((pixel & format->Amask) >> format->Ashift) << format->Aloss) < threshold)
+					continue;
+
+				row[x / 64] |= static_cast<Uint64>(1) << (x % 64);
+			}
+		}
+
+		surface.Unlock();
+
+		return true;
+	}
+
+	int CollisionMask::GetWidth() const
+	{
+		return m_Width;
+	}
+
+	int CollisionMask::GetHeight() const
+	{
+		return m_Height;
+	}
+
+	bool CollisionMask::Get(int x, int y) const
+	{
+		if(x < 0 || y < 0 || x >= m_Width || y >= m_Height)
+			return false;
+
+		return (m_Bits[y * m_Words + x / 64] >> (x % 64)) & 1;
+	}
+
+	Uint32 CollisionMask::GetCount() const
+	{
+		Uint32 count = 0;
+
+		for(std::vector<Uint64>::const_iterator i = m_Bits.begin(); i != m_Bits.end(); ++i)
+			count += PopCount(*i);
+
+		return count;
+	}
+
+	bool CollisionMask::Collides(const CollisionMask &other, int dx, int dy) const
+	{
+		return Test(other, dx, dy, false) != 0;
+	}
+
+	Uint32 CollisionMask::Overlap(const CollisionMask &other, int dx, int dy) const
+	{
+		return Test(other, dx, dy, true);
+	}
+
+	Uint32 CollisionMask::Test(const CollisionMask &other, int dx, int dy, bool count) const
+	{
+		// The rectangle both masks cover, in this mask's coordinates
+		int x1 = dx > 0 ? dx : 0;
+		int y1 = dy > 0 ? dy : 0;
+		int x2 = dx + other.m_Width < m_Width ? dx + other.m_Width : m_Width;
+		int y2 = dy + other.m_Height < m_Height ? dy + other.m_Height : m_Height;
+
+		if(x1 >= x2 || y1 >= y2)
+			return 0;
+
+		// Bits past either mask's width are clear, so whole words can be
+		// ANDed without masking the ends
+		int first = x1 / 64, last = (x2 - 1) / 64;
+		Uint32 total = 0;
+
+		for(int y = y1; y < y2; y++)
+		{
+			const Uint64 *row = &m_Bits[y * m_Words];
+			const Uint64 *otherrow = &other.m_Bits[(y - dy) * other.m_Words];
+
+			for(int word = first; word <= last; word++)
+			{
+				Uint64 bits = row[word] & Fetch(otherrow, other.m_Words, word * 64 - dx);
+				if(bits == 0)
+					continue;
+
+				if(!count)
+					return 1;
+				total += PopCount(bits);
+			}
+		}
+
+		return total;
+	}
+
+	bool CollisionMaskCache::Key::operator <(const Key &key) const
+	{
+		if(surface != key.surface)
+			return surface < key.surface;
+		if(x != key.x)
+			return x < key.x;
+		if(y != key.y)
+			return y < key.y;
+		if(w != key.w)
+			return w < key.w;
+		if(h != key.h)
+			return h < key.h;
+
+		return threshold < key.threshold;
+	}
+
+	CollisionMaskCache::CollisionMaskCache() : m_Masks()
+	{
+	}
+
+	CollisionMaskCache::~CollisionMaskCache()
+	{
+		Clear();
+	}
+
+	const CollisionMask &CollisionMaskCache::Get(const Surface &surface, Uint8 threshold)
+	{
+		// Surface::Get() isn't const, but only the pointer is wanted
+		SDL_Surface *s = const_cast<Surface &>(surface).Get();
+		if(s == NULL)
+			throw LogicError("surface not initialized before call to CollisionMaskCache::Get(Surface, Uint8)");
+
+		return Get(surface, Rect(0, 0, s->w, s->h), threshold);
+	}
+
+	const CollisionMask &CollisionMaskCache::Get(const Surface &surface, const Rect &srcrect, Uint8 threshold)
+	{
+		Surface &source = const_cast<Surface &>(surface);
+		if(source.Get() == NULL)
+			throw LogicError("surface not initialized before call to CollisionMaskCache::Get(Surface, Rect, Uint8)");
+
+		Key key;
+		key.surface = source.Get();
+		key.x = srcrect.x;
+		key.y = srcrect.y;
+		key.w = srcrect.w;
+		key.h = srcrect.h;
+		key.threshold = threshold;
+
+		MaskMap::iterator i = m_Masks.lower_bound(key);
+		if(i != m_Masks.end() && !(key < i->first))
+			return i->second;
+
+		i = m_Masks.insert(i, MaskMap::value_type(key, CollisionMask()));
+		i->second.Build(source, srcrect, threshold);
+
+		// Keep the surface alive while its masks are cached
+		key.surface->refcount++;
+
+		return i->second;
+	}
+
+	void CollisionMaskCache::Remove(const Surface &surface)
+	{
+		SDL_Surface *s = const_cast<Surface &>(surface).Get();
+
+		MaskMap::iterator i = m_Masks.begin();
+		while(i != m_Masks.end())
+		{
+			if(i->first.surface == s)
+			{
+				SDL_FreeSurface(s);
+				m_Masks.erase(i++);
+			}
+			else
+				++i;
+		}
+	}
+
+	void CollisionMaskCache::Clear()
+	{
+		for(MaskMap::iterator i = m_Masks.begin(); i != m_Masks.end(); ++i)
+			SDL_FreeSurface(i->first.surface);
+
+		m_Masks.clear();
+	}
+
+	int CollisionMaskCache::GetCount() const
+	{
+		return m_Masks.size();
+	}
+}
@@ -0,0 +1,495 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <cmath>
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_color.h"
+#include "SDL4Cpp_blit.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace SDL
+{
+	/*!
+	 * \brief Private SDL4Cpp_color structure
+	 *
+	 * A ColorMatrix for one pixel format: rows and columns are the bytes of
+	 * the 32-bit pixel instead of r, g, b, a, in 4.12 fixed point.
+	 */
+	struct Transform
+	{
+		Sint16 matrix[4][4];
+		/*! Offsets with the rounding added, multiples of 64 */
+		Sint32 offset[4];
+		/*! Only matrix[i][i] isn't 0 */
+		bool diagonal;
+		/*! Pixels that match key under keymask are left alone */
+		Uint32 keymask, key;
+		/*! Flipped in results that would match key, so they don't become
+		 * see through */
+		Uint32 nudge;
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_color function
+	 */
+	static inline int Clamp(int value, int low, int high)
+	{
+		return value < low ? low : (value > high ? high : value);
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_color function
+	 *
+	 * Set up transform to do matrix on surface's pixels.
+	 *
+	 * \return False if surface isn't 32-bit with 8-bit channels.
+	 */
+	static bool Prepare(Transform &transform, const SDL_Surface *surface, const ColorMatrix &matrix)
+	{
+		const SDL_PixelFormat *format = surface->format;
+		if(format->BytesPerPixel != 4 || format->Rloss || format->Gloss || format->Bloss ||
+		   (format->Amask && format->Aloss))
+		{
+			SDL_SetError("Only 32-bit surfaces with 8-bit channels can be color transformed");
+			return false;
+		}
+
+		// Which byte of the pixel each channel is in. Without an alpha
+		// channel alpha reads as 255 and the spare byte is kept as it is.
+		int lane[4] = { format->Rshift / 8, format->Gshift / 8, format->Bshift / 8, 0 };
+		bool alpha = format->Amask != 0;
+		if(alpha)
+			lane[3] = format->Ashift / 8;
+		else
+			lane[3] = 6 - lane[0] - lane[1] - lane[2];
+
+		for(int i = 0; i < 4; i++)
+		{
+			transform.offset[i] = 0;
+			for(int j = 0; j < 4; j++)
+				transform.matrix[i][j] = 0;
+		}
+
+		for(int row = 0; row < 4; row++)
+		{
+			if(row == 3 && !alpha)
+			{
+				transform.matrix[lane[3]][lane[3]] = 4096;
+				transform.offset[lane[3]] = 2048;
+				continue;
+			}
+
+			double offset = matrix(row, 4);
+			for(int column = 0; column < 4; column++)
+			{
+				double value = matrix(row, column);
+				if(column == 3 && !alpha)
+				{
+					offset += value * 255;
+					continue;
+				}
+
+				transform.matrix[lane[row]][lane[column]] = Clamp(static_cast<int>(floor(value * 4096 + 0.5)), -32767, 32767);
+			}
+
+			// Offsets are kept to 1/64 so the diagonal path can do them with
+			// 16-bit multiplies
+			transform.offset[lane[row]] = Clamp(static_cast<int>(floor(offset * 64 + 0.5)), -32767, 32735) * 64 + 2048;
+		}
+
+		transform.diagonal = true;
+		for(int i = 0; i < 4; i++)
+		{
+			for(int j = 0; j < 4; j++)
+			{
+				if(i != j && transform.matrix[i][j] != 0)
+					transform.diagonal = false;
+			}
+		}
+
+		transform.keymask = format->Rmask | format->Gmask | format->Bmask;
+		transform.key = format->colorkey & transform.keymask;
+		transform.nudge = transform.keymask & (~transform.keymask + 1);
+		if(!(surface->flags & SDL_SRCCOLORKEY))
+		{
+			// Nothing under a 0 mask matches 1
+			transform.keymask = 0;
+			transform.key = 1;
+			transform.nudge = 0;
+		}
+
+		return true;
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_color function
+	 *
+	 * Transform n pixels from src into dst, which may be the same.
+	 */
+	static void TransformRow(const Transform &t, const Uint32 *src, Uint32 *dst, int n)
+	{
+		int x = 0;
+
+	#if defined(__SSE2__)
+		{
+			__m128i zero = _mm_setzero_si128();
+			__m128i keymask = _mm_set1_epi32(t.keymask);
+			__m128i key = _mm_set1_epi32(t.key);
+			__m128i nudge = _mm_set1_epi32(t.nudge);
+
+			if(t.diagonal)
+			{
+				// Interleave each byte with 64 so one madd does
+				// byte * scale + 64 * offset / 64
+				__m128i sixtyfour = _mm_set1_epi16(64);
+				__m128i w = _mm_set_epi16(t.offset[3] >> 6, t.matrix[3][3], t.offset[2] >> 6, t.matrix[2][2],
+										  t.offset[1] >> 6, t.matrix[1][1], t.offset[0] >> 6, t.matrix[0][0]);
+
+				for(; x + 4 <= n; x += 4)
+				{
+					__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x));
+					__m128i lo = _mm_unpacklo_epi8(v, zero), hi = _mm_unpackhi_epi8(v, zero);
+
+					__m128i p0 = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(lo, sixtyfour), w), 12);
+					__m128i p1 = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(lo, sixtyfour), w), 12);
+					__m128i p2 = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(hi, sixtyfour), w), 12);
+					__m128i p3 = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(hi, sixtyfour), w), 12);
+					__m128i out = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+
+					__m128i keep = _mm_cmpeq_epi32(_mm_and_si128(v, keymask), key);
+					__m128i clash = _mm_andnot_si128(keep, _mm_cmpeq_epi32(_mm_and_si128(out, keymask), key));
+					out = _mm_xor_si128(out, _mm_and_si128(clash, nudge));
+					out = _mm_or_si128(_mm_and_si128(keep, v), _mm_andnot_si128(keep, out));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), out);
+				}
+			}
+			else
+			{
+				__m128i w[4];
+				for(int i = 0; i < 4; i++)
+					w[i] = _mm_set_epi16(t.matrix[i][3], t.matrix[i][2], t.matrix[i][1], t.matrix[i][0],
+										 t.matrix[i][3], t.matrix[i][2], t.matrix[i][1], t.matrix[i][0]);
+				__m128i offset = _mm_loadu_si128(reinterpret_cast<const __m128i *>(t.offset));
+
+				for(; x + 4 <= n; x += 4)
+				{
+					__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x));
+					__m128i half[2] = { _mm_unpacklo_epi8(v, zero), _mm_unpackhi_epi8(v, zero) };
+					__m128i packed[2];
+
+					// Each half is two pixels. madd gives each output byte as
+					// two partial sums per pixel, which are shuffled together
+					// and added.
+					for(int h = 0; h < 2; h++)
+					{
+						__m128i m0 = _mm_madd_epi16(half[h], w[0]);
+						__m128i m1 = _mm_madd_epi16(half[h], w[1]);
+						__m128i m2 = _mm_madd_epi16(half[h], w[2]);
+						__m128i m3 = _mm_madd_epi16(half[h], w[3]);
+
+						__m128i a = _mm_unpacklo_epi32(m0, m1), b = _mm_unpackhi_epi32(m0, m1);
+						__m128i s01 = _mm_add_epi32(_mm_unpacklo_epi64(a, b), _mm_unpackhi_epi64(a, b));
+						a = _mm_unpacklo_epi32(m2, m3);
+						b = _mm_unpackhi_epi32(m2, m3);
+						__m128i s23 = _mm_add_epi32(_mm_unpacklo_epi64(a, b), _mm_unpackhi_epi64(a, b));
+
+						__m128i first = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi64(s01, s23), offset), 12);
+						__m128i second = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi64(s01, s23), offset), 12);
+						packed[h] = _mm_packs_epi32(first, second);
+					}
+
+					__m128i out = _mm_packus_epi16(packed[0], packed[1]);
+					__m128i keep = _mm_cmpeq_epi32(_mm_and_si128(v, keymask), key);
+					__m128i clash = _mm_andnot_si128(keep, _mm_cmpeq_epi32(_mm_and_si128(out, keymask), key));
+					out = _mm_xor_si128(out, _mm_and_si128(clash, nudge));
+					out = _mm_or_si128(_mm_and_si128(keep, v), _mm_andnot_si128(keep, out));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), out);
+				}
+			}
+		}
+	#endif
+
+		for(; x < n; x++)
+		{
+			Uint32 pixel = src[x];
+			if((pixel & t.keymask) == t.key)
+			{
+				dst[x] = pixel;
+				continue;
+			}
+
+			int in[4];
+			for(int i = 0; i < 4; i++)
+				in[i] = (pixel >> (i * 8)) & 0xFF;
+
+			Uint32 out = 0;
+			for(int i = 0; i < 4; i++)
+			{
+				int value = t.offset[i];
+				for(int j = 0; j < 4; j++)
+					value += t.matrix[i][j] * in[j];
+
+				out |= static_cast<Uint32>(Clamp(value >> 12, 0, 255)) << (i * 8);
+			}
+
+			if((out & t.keymask) == t.key)
+				out ^= t.nudge;
+			dst[x] = out;
+		}
+	}
+
+	ColorMatrix::ColorMatrix()
+	{
+		for(int row = 0; row < 4; row++)
+		{
+			for(int column = 0; column < 5; column++)
+				m_Values[row][column] = row == column ? 1.0 : 0.0;
+		}
+	}
+
+	ColorMatrix::ColorMatrix(const double values[20])
+	{
+		for(int row = 0; row < 4; row++)
+		{
+			for(int column = 0; column < 5; column++)
+				m_Values[row][column] = values[row * 5 + column];
+		}
+	}
+
+	double &ColorMatrix::operator ()(int row, int column)
+	{
+		return m_Values[row][column];
+	}
+
+	double ColorMatrix::operator ()(int row, int column) const
+	{
+		return m_Values[row][column];
+	}
+
+	ColorMatrix ColorMatrix::operator *(const ColorMatrix &matrix) const
+	{
+		ColorMatrix result;
+
+		// As 5x5 matrices with a last row of 0 0 0 0 1
+		for(int row = 0; row < 4; row++)
+		{
+			for(int column = 0; column < 5; column++)
+			{
+				double value = column == 4 ? m_Values[row][4] : 0.0;
+				for(int k = 0; k < 4; k++)
+					value += m_Values[row][k] * matrix.m_Values[k][column];
+
+				result.m_Values[row][column] = value;
+			}
+		}
+
+		return result;
+	}
+
+	bool ColorMatrix::IsDiagonal() const
+	{
+		for(int row = 0; row < 4; row++)
+		{
+			for(int column = 0; column < 4; column++)
+			{
+				if(row != column && m_Values[row][column] != 0.0)
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	ColorMatrix ColorMatrix::Tint(const Color &color, double amount)
+	{
+		ColorMatrix matrix;
+		Uint8 rgb[3] = { color.r, color.g, color.b };
+
+		for(int i = 0; i < 3; i++)
+			matrix.m_Values[i][i] = 1.0 - amount + amount * rgb[i] / 255.0;
+
+		return matrix;
+	}
+
+	ColorMatrix ColorMatrix::BrightnessContrast(double brightness, double contrast)
+	{
+		ColorMatrix matrix;
+
+		for(int i = 0; i < 3; i++)
+		{
+			matrix.m_Values[i][i] = contrast;
+			matrix.m_Values[i][4] = 128.0 * (1.0 - contrast) + brightness * 255.0;
+		}
+
+		return matrix;
+	}
+
+	ColorMatrix ColorMatrix::Grayscale(double amount)
+	{
+		ColorMatrix matrix;
+		const double luma[3] = { 0.299, 0.587, 0.114 };
+
+		for(int row = 0; row < 3; row++)
+		{
+			for(int column = 0; column < 3; column++)
+				matrix.m_Values[row][column] = (row == column ? 1.0 - amount : 0.0) + amount * luma[column];
+		}
+
+		return matrix;
+	}
+
+	ColorMatrix ColorMatrix::Fade(const Color &color, double amount)
+	{
+		ColorMatrix matrix;
+		Uint8 rgb[3] = { color.r, color.g, color.b };
+
+		for(int i = 0; i < 3; i++)
+		{
+			matrix.m_Values[i][i] = 1.0 - amount;
+			matrix.m_Values[i][4] = amount * rgb[i];
+		}
+
+		return matrix;
+	}
+
+	ColorMatrix ColorMatrix::Opacity(double opacity)
+	{
+		ColorMatrix matrix;
+		matrix.m_Values[3][3] = opacity;
+
+		return matrix;
+	}
+
+	bool Surface::ApplyColorMatrix(const ColorMatrix &matrix)
+	{
+		if(m_Surface == NULL)
+			throw LogicError("m_Surface not intialized before call to ApplyColorMatrix(ColorMatrix)");
+
+		return ApplyColorMatrix(matrix, Rect(0, 0, m_Surface->w, m_Surface->h));
+	}
+
+	bool Surface::ApplyColorMatrix(const ColorMatrix &matrix, const Rect &rect)
+	{
+		if(m_Surface == NULL)
+			throw LogicError("m_Surface not intialized before call to ApplyColorMatrix(ColorMatrix, Rect)");
+
+		Transform transform;
+		if(!Prepare(transform, m_Surface, matrix))
+			return false;
+
+		int x = rect.x < 0 ? 0 : rect.x;
+		int y = rect.y < 0 ? 0 : rect.y;
+		int w = (rect.x + rect.w < m_Surface->w ? rect.x + rect.w : m_Surface->w) - x;
+		int h = (rect.y + rect.h < m_Surface->h ? rect.y + rect.h : m_Surface->h) - y;
+
+		if(w <= 0 || h <= 0)
+			return true;
+
+		if(!Lock())
+			return false;
+
+		for(int row = y; row < y + h; row++)
+		{
+			Uint32 *p = reinterpret_cast<Uint32 *>(Private::PixelAddress(m_Surface, x, row));
+			TransformRow(transform, p, p, w);
+		}
+
+		Unlock();
+
+		return true;
+	}
+
+	bool Surface::BlitColorMatrix(const Surface &src, Sint16 x, Sint16 y, const ColorMatrix &matrix)
+	{
+		if(src.m_Surface == NULL)
+			throw LogicError("src.m_Surface not initialized before call to BlitColorMatrix(Surface, Sint16, Sint16, ColorMatrix)");
+
+		return BlitColorMatrix(Rect(0, 0, src.m_Surface->w, src.m_Surface->h), src, x, y, matrix);
+	}
+
+	bool Surface::BlitColorMatrix(const Rect &srcrect, const Surface &src, Sint16 x, Sint16 y,
+								  const ColorMatrix &matrix)
+	{
+		if(m_Surface == NULL)
+			throw LogicError("m_Surface not intialized before call to BlitColorMatrix(Rect, Surface, Sint16, Sint16, ColorMatrix)");
+		if(src.m_Surface == NULL)
+			throw LogicError("src.m_Surface not initialized before call to BlitColorMatrix(Rect, Surface, Sint16, Sint16, ColorMatrix)");
+
+		SDL_Surface *s = src.m_Surface;
+		Transform transform;
+		if(!Prepare(transform, s, matrix))
+			return false;
+
+		// Only the part of srcrect that's inside src
+		int sx = srcrect.x < 0 ? 0 : srcrect.x;
+		int sy = srcrect.y < 0 ? 0 : srcrect.y;
+		int sw = (srcrect.x + srcrect.w < s->w ? srcrect.x + srcrect.w : s->w) - sx;
+		int sh = (srcrect.y + srcrect.h < s->h ? srcrect.y + srcrect.h : s->h) - sy;
+		x += sx - srcrect.x;
+		y += sy - srcrect.y;
+
+		if(sw <= 0 || sh <= 0)
+			return true;
+
+		// A strip of about 16k is transformed and blitted at a time, with
+		// the same colorkey and alpha as src
+		int rows = 16384 / (sw * 4);
+		if(rows < 1)
+			rows = 1;
+		if(rows > sh)
+			rows = sh;
+
+		SDL_Surface *strip = SDL_CreateRGBSurface(SDL_SWSURFACE, sw, rows, 32, s->format->Rmask,
+												  s->format->Gmask, s->format->Bmask, s->format->Amask);
+		if(strip == NULL)
+			return false;
+
+		SDL_SetColorKey(strip, s->flags & SDL_SRCCOLORKEY, s->format->colorkey);
+		SDL_SetAlpha(strip, s->flags & SDL_SRCALPHA, s->format->alpha);
+		strip->flags |= s->flags & PREMULTIPLIED;
+
+		bool ok = true;
+		for(int row = 0; row < sh && ok; row += rows)
+		{
+			int n = sh - row < rows ? sh - row : rows;
+
+			if(SDL_MUSTLOCK(s) && SDL_LockSurface(s) < 0)
+			{
+				ok = false;
+				break;
+			}
+
+			for(int i = 0; i < n; i++)
+				TransformRow(transform, reinterpret_cast<const Uint32 *>(Private::PixelAddress(s, sx, sy + row + i)),
+							 reinterpret_cast<Uint32 *>(Private::PixelAddress(strip, 0, i)), sw);
+
+			if(SDL_MUSTLOCK(s))
+				SDL_UnlockSurface(s);
+
+			SDL_Rect part = { 0, 0, static_cast<Uint16>(sw), static_cast<Uint16>(n) };
+			SDL_Rect dst = { static_cast<Sint16>(x), static_cast<Sint16>(y + row), 0, 0 };
+			if(Private::BlitSurface(strip, &part, m_Surface, &dst) < 0)
+				ok = false;
+		}
+
+		SDL_FreeSurface(strip);
+
+		return ok;
+	}
+}
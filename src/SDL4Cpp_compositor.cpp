@@ -0,0 +1,457 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <algorithm>
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_compositor.h"
+#include "SDL4Cpp_blit.h"
+
+namespace SDL
+{
+	/*!
+	 * \brief Private SDL4Cpp_compositor function
+	 *
+	 * Clip (x, y, w, h) to a width x height screen.
+	 *
+	 * \return False if nothing is left.
+	 */
+	static bool ClipToScreen(int &x, int &y, int &w, int &h, int width, int height)
+	{
+		if(x < 0)
+		{
+			w += x;
+			x = 0;
+		}
+		if(y < 0)
+		{
+			h += y;
+			y = 0;
+		}
+		if(x + w > width)
+			w = width - x;
+		if(y + h > height)
+			h = height - y;
+
+		return w > 0 && h > 0;
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_compositor function
+	 *
+	 * Check if surface draws every pixel of itself solidly.
+	 */
+	static bool IsOpaque(const SDL_Surface *surface)
+	{
+		if(surface->flags & SDL_SRCCOLORKEY)
+			return false;
+
+		if(surface->flags & SDL_SRCALPHA)
+			return surface->format->Amask == 0 && surface->format->alpha == SDL_ALPHA_OPAQUE;
+
+		return true;
+	}
+
+	Compositor::Compositor(int tilesize) : m_TileSize(tilesize < 8 ? 8 : tilesize),
+		m_Columns(0), m_Rows(0), m_Layers(), m_Items(), m_FreeItems(), m_Damage(),
+		m_All(true), m_Background(0), m_Dirty(), m_Occluder(), m_Order(), m_Updates(),
+		m_Above(), m_Current(), m_Stats()
+	{
+	}
+
+	Compositor::~Compositor()
+	{
+		for(std::vector<Item>::iterator i = m_Items.begin(); i != m_Items.end(); ++i)
+		{
+			if(i->surface)
+				SDL_FreeSurface(i->surface);
+		}
+	}
+
+	int Compositor::AddLayer(int z)
+	{
+		m_Layers.push_back(Layer(z));
+
+		return m_Layers.size() - 1;
+	}
+
+	void Compositor::RemoveLayer(int layer)
+	{
+		while(!m_Layers[layer].items.empty())
+			Remove(m_Layers[layer].items.back());
+
+		m_Layers[layer].used = false;
+	}
+
+	void Compositor::SetLayerVisible(int layer, bool visible)
+	{
+		Layer &l = m_Layers[layer];
+		if(l.visible == visible)
+			return;
+
+		l.visible = visible;
+		for(std::vector<int>::iterator i = l.items.begin(); i != l.items.end(); ++i)
+			Damage(m_Items[*i]);
+	}
+
+	int Compositor::NewItem(int layer, const SDL_Rect &src, Surface &surface, Sint16 x, Sint16 y)
+	{
+		SDL_Surface *s = surface.Get();
+		if(s == NULL)
+			throw LogicError("Surface passed to Compositor::Add was empty");
+
+		// The compositor gets its own reference to the pixels
+		s->refcount++;
+
+		Item item;
+		item.surface = s;
+		item.src = src;
+		item.x = x;
+		item.y = y;
+		item.opaque.x = item.opaque.y = 0;
+		item.opaque.w = IsOpaque(s) ? src.w : 0;
+		item.opaque.h = IsOpaque(s) ? src.h : 0;
+		item.layer = layer;
+
+		int index;
+		if(m_FreeItems.empty())
+		{
+			index = m_Items.size();
+			m_Items.push_back(item);
+		}
+		else
+		{
+			index = m_FreeItems.back();
+			m_FreeItems.pop_back();
+			m_Items[index] = item;
+		}
+
+		m_Layers[layer].items.push_back(index);
+		Damage(item);
+
+		return index;
+	}
+
+	int Compositor::Add(int layer, Surface &surface, Sint16 x, Sint16 y)
+	{
+		SDL_Rect src = { 0, 0, 0, 0 };
+		if(surface.Get())
+		{
+			src.w = surface.Get()->w;
+			src.h = surface.Get()->h;
+		}
+
+		return NewItem(layer, src, surface, x, y);
+	}
+
+	int Compositor::Add(int layer, const Rect &srcrect, Surface &surface, Sint16 x, Sint16 y)
+	{
+		return NewItem(layer, srcrect, surface, x, y);
+	}
+
+	void Compositor::Remove(int item)
+	{
+		Item &i = m_Items[item];
+		std::vector<int> &items = m_Layers[i.layer].items;
+
+		Damage(i);
+		items.erase(std::find(items.begin(), items.end(), item));
+
+		SDL_FreeSurface(i.surface);
+		i.surface = NULL;
+		m_FreeItems.push_back(item);
+	}
+
+	void Compositor::Move(int item, Sint16 x, Sint16 y)
+	{
+		Item &i = m_Items[item];
+		if(i.x == x && i.y == y)
+			return;
+
+		Damage(i);
+		i.x = x;
+		i.y = y;
+		Damage(i);
+	}
+
+	void Compositor::SetSource(int item, const Rect &srcrect)
+	{
+		Item &i = m_Items[item];
+
+		Damage(i);
+		i.src = srcrect;
+		Damage(i);
+	}
+
+	void Compositor::SetOpaqueRect(int item, const Rect &rect)
+	{
+		m_Items[item].opaque = rect;
+		Damage(m_Items[item]);
+	}
+
+	void Compositor::Invalidate(int item)
+	{
+		Damage(m_Items[item]);
+	}
+
+	void Compositor::Invalidate(const Rect &rect)
+	{
+		Damage(rect.x, rect.y, rect.w, rect.h);
+	}
+
+	void Compositor::InvalidateAll()
+	{
+		m_All = true;
+	}
+
+	void Compositor::SetBackground(Uint32 color)
+	{
+		m_Background = color;
+		m_All = true;
+	}
+
+	CompositorStats Compositor::GetStats()
+	{
+		return m_Stats;
+	}
+
+	void Compositor::Damage(const Item &item)
+	{
+		Damage(item.x, item.y, item.src.w, item.src.h);
+	}
+
+	void Compositor::Damage(int x, int y, int w, int h)
+	{
+		if(w <= 0 || h <= 0)
+			return;
+
+		SDL_Rect rect;
+		rect.x = x;
+		rect.y = y;
+		rect.w = w;
+		rect.h = h;
+		m_Damage.push_back(rect);
+	}
+
+	bool Compositor::Compose(Screen &screen)
+	{
+		SDL_Surface *video = screen.Get();
+		if(video == NULL)
+			throw LogicError("screen not initialized before call to Compositor::Compose");
+
+		const int t = m_TileSize;
+		const int width = video->w, height = video->h;
+		int columns = (width + t - 1) / t;
+		int rows = (height + t - 1) / t;
+		bool flip = (video->flags & SDL_DOUBLEBUF) != 0;
+
+		if(columns != m_Columns || rows != m_Rows)
+		{
+			m_Columns = columns;
+			m_Rows = rows;
+			m_All = true;
+		}
+
+		m_Stats.tiles = columns * rows;
+		m_Stats.dirty = m_Stats.blits = 0;
+		m_Stats.drawn = m_Stats.culled = 0;
+
+		// Mark the tiles to redraw
+		m_Dirty.assign(columns * rows, m_All || flip);
+		if(!m_All && !flip)
+		{
+			for(std::vector<SDL_Rect>::iterator i = m_Damage.begin(); i != m_Damage.end(); ++i)
+			{
+				int x = i->x, y = i->y, w = i->w, h = i->h;
+				if(!ClipToScreen(x, y, w, h, width, height))
+					continue;
+
+				for(int row = y / t; row <= (y + h - 1) / t; row++)
+					std::fill(&m_Dirty[row * columns + x / t], &m_Dirty[row * columns + (x + w - 1) / t] + 1, 1);
+			}
+		}
+		m_Damage.clear();
+		m_All = false;
+
+		for(std::vector<Uint8>::iterator i = m_Dirty.begin(); i != m_Dirty.end(); ++i)
+			m_Stats.dirty += *i;
+
+		// Drawing order is by layer z, then the order items were added
+		std::vector<int> layers;
+		for(unsigned int i = 0; i < m_Layers.size(); i++)
+		{
+			if(!m_Layers[i].used || !m_Layers[i].visible)
+				continue;
+
+			std::vector<int>::iterator at = layers.begin();
+			while(at != layers.end() && m_Layers[*at].z <= m_Layers[i].z)
+				++at;
+			layers.insert(at, i);
+		}
+
+		m_Order.clear();
+		for(std::vector<int>::iterator i = layers.begin(); i != layers.end(); ++i)
+			m_Order.insert(m_Order.end(), m_Layers[*i].items.begin(), m_Layers[*i].items.end());
+
+		// Find the topmost item covering each tile. Tiles on the right and
+		// bottom edges only need covering as far as the screen goes.
+		m_Occluder.assign(columns * rows, -1);
+		for(unsigned int k = 0; k < m_Order.size(); k++)
+		{
+			const Item &item = m_Items[m_Order[k]];
+			int x = item.x + item.opaque.x, y = item.y + item.opaque.y;
+			int w = std::min<int>(item.opaque.w, item.src.w - item.opaque.x);
+			int h = std::min<int>(item.opaque.h, item.src.h - item.opaque.y);
+			if(!ClipToScreen(x, y, w, h, width, height))
+				continue;
+
+			int c0 = (x + t - 1) / t, c1 = x + w >= width ? columns : (x + w) / t;
+			int r0 = (y + t - 1) / t, r1 = y + h >= height ? rows : (y + h) / t;
+			for(int row = r0; row < r1; row++)
+			{
+				for(int column = c0; column < c1; column++)
+					m_Occluder[row * columns + column] = k;
+			}
+		}
+
+		bool ok = true;
+
+		// Fill uncovered tiles with the background, a row of tiles at a time
+		for(int row = 0; row < rows; row++)
+		{
+			for(int column = 0; column < columns; column++)
+			{
+				int start = column;
+				while(column < columns && m_Dirty[row * columns + column] &&
+					  m_Occluder[row * columns + column] < 0)
+					column++;
+
+				if(column == start)
+					continue;
+
+				int x = start * t, y = row * t, w = (column - start) * t, h = t;
+				ClipToScreen(x, y, w, h, width, height);
+
+				Rect rect(x, y, w, h);
+				if(SDL_FillRect(video, &rect, m_Background) < 0)
+					ok = false;
+				m_Stats.blits++;
+				m_Stats.drawn += w * h;
+			}
+		}
+
+		// Draw each item in the dirty tiles it can be seen in
+		for(unsigned int k = 0; k < m_Order.size(); k++)
+		{
+			const Item &item = m_Items[m_Order[k]];
+			int bx = item.x, by = item.y, bw = item.src.w, bh = item.src.h;
+			if(!ClipToScreen(bx, by, bw, bh, width, height))
+				continue;
+
+			int c0 = bx / t, c1 = (bx + bw - 1) / t;
+			for(int row = by / t; row <= (by + bh - 1) / t; row++)
+			{
+				int y = std::max(by, row * t);
+				int h = std::min(by + bh, (row + 1) * t) - y;
+
+				for(int column = c0; column <= c1; column++)
+				{
+					int tile = row * columns + column;
+					if(!m_Dirty[tile])
+						continue;
+
+					if(m_Occluder[tile] > static_cast<int>(k))
+					{
+						int x = std::max(bx, column * t);
+						m_Stats.culled += (std::min(bx + bw, (column + 1) * t) - x) * h;
+						continue;
+					}
+
+					int start = column;
+					while(column + 1 <= c1 && m_Dirty[tile + 1] && m_Occluder[tile + 1] <= static_cast<int>(k))
+					{
+						column++;
+						tile++;
+					}
+
+					int x = std::max(bx, start * t);
+					int w = std::min(bx + bw, (column + 1) * t) - x;
+
+					SDL_Rect src = item.src;
+					src.x += x - item.x;
+					src.y += y - item.y;
+					src.w = w;
+					src.h = h;
+					SDL_Rect dst = { static_cast<Sint16>(x), static_cast<Sint16>(y), 0, 0 };
+
+					if(Private::BlitSurface(item.surface, &src, video, &dst) < 0)
+						ok = false;
+					m_Stats.blits++;
+					m_Stats.drawn += w * h;
+				}
+			}
+		}
+
+		if(flip)
+		{
+			if(!screen.Flip())
+				ok = false;
+			return ok;
+		}
+
+		// Send the dirty tiles, a run per row, joined with a rect ending at
+		// the row above when they line up
+		m_Updates.clear();
+		m_Current.clear();
+		for(int row = 0; row < rows; row++)
+		{
+			m_Above.swap(m_Current);
+			m_Current.clear();
+
+			for(int column = 0; column < columns; column++)
+			{
+				int start = column;
+				while(column < columns && m_Dirty[row * columns + column])
+					column++;
+
+				if(column == start)
+					continue;
+
+				int x = start * t, y = row * t, w = (column - start) * t, h = t;
+				ClipToScreen(x, y, w, h, width, height);
+
+				unsigned int i = 0;
+				while(i < m_Above.size() && (m_Updates[m_Above[i]].x != x || m_Updates[m_Above[i]].w != w))
+					i++;
+
+				if(i < m_Above.size())
+				{
+					m_Updates[m_Above[i]].h += h;
+					m_Current.push_back(m_Above[i]);
+				}
+				else
+				{
+					m_Current.push_back(m_Updates.size());
+					m_Updates.push_back(Rect(x, y, w, h));
+				}
+			}
+		}
+
+		if(!m_Updates.empty())
+			screen.UpdateRects(m_Updates.size(), &m_Updates[0]);
+
+		return ok;
+	}
+}
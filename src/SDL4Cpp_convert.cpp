@@ -0,0 +1,471 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <cstring>
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_video.h"
+#include "SDL4Cpp_blit.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace SDL
+{
+	/*!
+	 * \brief Private SDL4Cpp_convert structure
+	 *
+	 * Where the channels of a 16, 24 or 32-bit format are, in the order R, G,
+	 * B, A. mask[3] is 0 when there's no alpha channel.
+	 */
+	struct Layout
+	{
+		int bpp;
+		Uint32 mask[4];
+		int shift[4];
+		int loss[4];
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_convert variable
+	 *
+	 * Where R, G, B and A go in the ARGB8888 pixels converted through.
+	 */
+	static const int s_Canonical[4] = { 16, 8, 0, 24 };
+
+	/*!
+	 * \brief Private SDL4Cpp_convert variable
+	 *
+	 * 4x4 ordered dither thresholds.
+	 */
+	static const Uint8 s_Bayer[4][4] =
+	{
+		{  0,  8,  2, 10 },
+		{ 12,  4, 14,  6 },
+		{  3, 11,  1,  9 },
+		{ 15,  7, 13,  5 }
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_convert function
+	 *
+	 * Fill layout from format. Only formats whose channels all have at least
+	 * 4 bits can be converted by shifting, so anything else (palettes, 8-bit
+	 * and odd masks) is left to SDL.
+	 *
+	 * \return False if format can't be handled here.
+	 */
+	static bool GetLayout(const SDL_PixelFormat *format, Layout &layout)
+	{
+		if(format->palette != NULL || format->BytesPerPixel < 2)
+			return false;
+
+		layout.bpp = format->BytesPerPixel;
+		layout.mask[0] = format->Rmask;
+		layout.mask[1] = format->Gmask;
+		layout.mask[2] = format->Bmask;
+		layout.mask[3] = format->Amask;
+		layout.shift[0] = format->Rshift;
+		layout.shift[1] = format->Gshift;
+		layout.shift[2] = format->Bshift;
+		layout.shift[3] = format->Ashift;
+		layout.loss[0] = format->Rloss;
+		layout.loss[1] = format->Gloss;
+		layout.loss[2] = format->Bloss;
+		layout.loss[3] = format->Aloss;
+
+		for(int c = 0; c < 4; c++)
+		{
+			if(layout.mask[c] == 0)
+			{
+				if(c < 3)
+					return false;
+				layout.shift[c] = 0;
+				layout.loss[c] = 8;
+			}
+			else if(layout.loss[c] > 4 ||
+					(layout.mask[c] >> layout.shift[c]) != (0xFFu >> layout.loss[c]))
+				return false;
+		}
+
+		return true;
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_convert function
+	 *
+	 * Check if a and b are the same format, so rows can just be copied.
+	 */
+	static bool SameLayout(const Layout &a, const Layout &b)
+	{
+		return a.bpp == b.bpp && a.mask[0] == b.mask[0] && a.mask[1] == b.mask[1] &&
+			a.mask[2] == b.mask[2] && a.mask[3] == b.mask[3];
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_convert function
+	 *
+	 * Expand pixel to ARGB8888. Low bits are filled by repeating the high
+	 * ones so white stays white, and pixels without alpha are opaque.
+	 */
+	static inline Uint32 Decode(Uint32 pixel, const Layout &from)
+	{
+		Uint32 out = from.mask[3] ? 0 : 0xFF000000;
+
+		for(int c = 0; c < 4; c++)
+		{
+			if(from.mask[c] == 0)
+				continue;
+
+			Uint32 x = (pixel & from.mask[c]) >> from.shift[c];
+			x = (x << from.loss[c]) | (x >> (8 - 2 * from.loss[c]));
+			out |= x << s_Canonical[c];
+		}
+
+		return out;
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_convert function
+	 *
+	 * Pack the ARGB8888 pixel into to.
+	 */
+	static inline Uint32 Encode(Uint32 pixel, const Layout &to)
+	{
+		Uint32 out = 0;
+
+		for(int c = 0; c < 4; c++)
+		{
+			if(to.mask[c])
+				out |= (((pixel >> s_Canonical[c]) & 0xFF) >> to.loss[c]) << to.shift[c];
+		}
+
+		return out;
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_convert function
+	 *
+	 * Add each byte of d to p, saturating at 255.
+	 */
+	static inline Uint32 AddSaturate(Uint32 p, Uint32 d)
+	{
+		Uint32 out = 0;
+
+		for(int shift = 0; shift < 32; shift += 8)
+		{
+			Uint32 x = ((p >> shift) & 0xFF) + ((d >> shift) & 0xFF);
+			out |= (x > 0xFF ? 0xFF : x) << shift;
+		}
+
+		return out;
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_convert structure
+	 *
+	 * Everything a row conversion needs besides the pixels.
+	 */
+	struct Converter
+	{
+		Layout from, to;
+		/*! ARGB8888 amounts to add before dropping bits, per row and
+		 * column mod 4, or NULL for no dithering */
+		const Uint32 (*dither)[4];
+		/*! Source pixels that match key under keymask become 0 */
+		bool dropkey;
+		Uint32 keymask, key;
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_convert function
+	 *
+	 * Convert n pixels of row y from src to dst, four at a time with SSE2.
+	 * Every format goes through ARGB8888 in registers; the shifts differ
+	 * per format but not per pixel so the same code covers every pair.
+	 */
+	static void ConvertRow(const Converter &conv, const Uint8 *src, Uint8 *dst,
+						   int n, int y)
+	{
+		const Layout &from = conv.from;
+		const Layout &to = conv.to;
+		const Uint32 *dither = conv.dither ? conv.dither[y & 3] : NULL;
+		int i = 0;
+
+	#if defined(__SSE2__)
+		{
+			__m128i zero = _mm_setzero_si128();
+			__m128i ff = _mm_set1_epi32(0xFF);
+			__m128i opaque = _mm_set1_epi32(from.mask[3] ? 0 : 0xFF000000);
+			__m128i keymask = _mm_set1_epi32(conv.keymask);
+			__m128i key = _mm_set1_epi32(conv.key);
+			__m128i bias = _mm_set1_epi32(0x8000);
+			__m128i unbias = _mm_set1_epi16(static_cast<short>(0x8000));
+			__m128i d = dither ? _mm_loadu_si128(reinterpret_cast<const __m128i *>(dither)) : zero;
+			__m128i fshift[4], fkeep[4], floss[4], fspread[4], canon[4], tloss[4], tshift[4];
+
+			for(int c = 0; c < 4; c++)
+			{
+				fshift[c] = _mm_cvtsi32_si128(from.shift[c]);
+				fkeep[c] = _mm_set1_epi32(0xFF >> from.loss[c]);
+				floss[c] = _mm_cvtsi32_si128(from.loss[c]);
+				fspread[c] = _mm_cvtsi32_si128(8 - 2 * from.loss[c]);
+				canon[c] = _mm_cvtsi32_si128(s_Canonical[c]);
+				tloss[c] = _mm_cvtsi32_si128(to.loss[c]);
+				tshift[c] = _mm_cvtsi32_si128(to.shift[c]);
+			}
+
+			for(; i + 4 <= n; i += 4)
+			{
+				const Uint8 *s = src + i * from.bpp;
+				__m128i v;
+
+				if(from.bpp == 4)
+					v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+				else if(from.bpp == 2)
+					v = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(s)), zero);
+				else
+					v = _mm_set_epi32(Private::ReadPixel(s + 9, 3), Private::ReadPixel(s + 6, 3),
+									  Private::ReadPixel(s + 3, 3), Private::ReadPixel(s, 3));
+
+				__m128i argb = opaque;
+				for(int c = 0; c < 4; c++)
+				{
+					if(from.mask[c] == 0)
+						continue;
+
+					__m128i x = _mm_and_si128(_mm_srl_epi32(v, fshift[c]), fkeep[c]);
+					x = _mm_or_si128(_mm_sll_epi32(x, floss[c]), _mm_srl_epi32(x, fspread[c]));
+					argb = _mm_or_si128(argb, _mm_sll_epi32(x, canon[c]));
+				}
+
+				if(dither)
+					argb = _mm_adds_epu8(argb, d);
+
+				__m128i out = zero;
+				for(int c = 0; c < 4; c++)
+				{
+					if(to.mask[c] == 0)
+						continue;
+
+					__m128i x = _mm_and_si128(_mm_srl_epi32(argb, canon[c]), ff);
+					out = _mm_or_si128(out, _mm_sll_epi32(_mm_srl_epi32(x, tloss[c]), tshift[c]));
+				}
+
+				if(conv.dropkey)
+					out = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_and_si128(v, keymask), key), out);
+
+				Uint8 *p = dst + i * to.bpp;
+				if(to.bpp == 4)
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(p), out);
+				else if(to.bpp == 2)
+				{
+					// There's no unsigned 32 to 16-bit pack before SSE4.1, so
+					// shift into signed range and back
+					out = _mm_packs_epi32(_mm_sub_epi32(out, bias), zero);
+					_mm_storel_epi64(reinterpret_cast<__m128i *>(p), _mm_xor_si128(out, unbias));
+				}
+				else
+				{
+					Uint32 pixels[4];
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(pixels), out);
+					for(int j = 0; j < 4; j++)
+						Private::WritePixel(p + j * 3, 3, pixels[j]);
+				}
+			}
+		}
+	#endif
+
+		for(; i < n; i++)
+		{
+			Uint32 pixel = Private::ReadPixel(src + i * from.bpp, from.bpp);
+			Uint32 out = 0;
+
+			if(!conv.dropkey || (pixel & conv.keymask) != conv.key)
+			{
+				Uint32 argb = Decode(pixel, from);
+				if(dither)
+					argb = AddSaturate(argb, dither[i & 3]);
+				out = Encode(argb, to);
+			}
+
+			Private::WritePixel(dst + i * to.bpp, to.bpp, out);
+		}
+	}
+
+	SDL_Surface *Private::ConvertSurface(SDL_Surface *src, SDL_PixelFormat *format,
+										 Uint32 flags, bool dither)
+	{
+		Converter conv;
+
+		if(!GetLayout(src->format, conv.from) || !GetLayout(format, conv.to) ||
+		   (flags & SDL_HWSURFACE))
+			return SDL_ConvertSurface(src, format, flags);
+
+		SDL_Surface *dst = SDL_CreateRGBSurface(flags, src->w, src->h, format->BitsPerPixel,
+												format->Rmask, format->Gmask,
+												format->Bmask, format->Amask);
+		if(dst == NULL)
+			return NULL;
+
+		// Like SDL_ConvertSurface(), a colorkey becomes transparent pixels
+		// when converting to alpha unless the key was asked for
+		bool keyed = (src->flags & SDL_SRCCOLORKEY) != 0;
+		conv.dropkey = keyed && !(flags & SDL_SRCCOLORKEY) && format->Amask;
+		conv.keymask = ~src->format->Amask;
+		if(conv.from.bpp < 4)
+			conv.keymask &= (1u << (conv.from.bpp * 8)) - 1;
+		conv.key = src->format->colorkey & conv.keymask;
+
+		// Dithering would move keyed pixels off the key
+		Uint32 pattern[4][4];
+		bool dithered = false;
+		for(int y = 0; y < 4; y++)
+		{
+			for(int x = 0; x < 4; x++)
+			{
+				pattern[y][x] = 0;
+				for(int c = 0; c < 3; c++)
+				{
+					if(conv.to.loss[c] > conv.from.loss[c])
+						pattern[y][x] |= (s_Bayer[y][x] >> (4 - conv.to.loss[c])) << s_Canonical[c];
+				}
+				dithered = dithered || pattern[y][x];
+			}
+		}
+		conv.dither = dither && dithered && (!keyed || conv.dropkey) ? pattern : NULL;
+
+		if(SDL_LockSurface(src) < 0)
+		{
+			SDL_FreeSurface(dst);
+			return NULL;
+		}
+		if(SDL_LockSurface(dst) < 0)
+		{
+			SDL_UnlockSurface(src);
+			SDL_FreeSurface(dst);
+			return NULL;
+		}
+
+		// Keyed pixels have to go through ConvertRow() to lose their alpha
+		bool copy = SameLayout(conv.from, conv.to) && !conv.dropkey;
+		for(int y = 0; y < src->h; y++)
+		{
+			const Uint8 *s = Private::PixelAddress(src, 0, y);
+			Uint8 *d = Private::PixelAddress(dst, 0, y);
+
+			if(copy)
+				memcpy(d, s, src->w * conv.from.bpp);
+			else
+				ConvertRow(conv, s, d, src->w, y);
+		}
+
+		SDL_UnlockSurface(dst);
+		SDL_UnlockSurface(src);
+
+		if(keyed && !conv.dropkey)
+		{
+			Uint8 r, g, b;
+			SDL_GetRGB(src->format->colorkey, src->format, &r, &g, &b);
+			SDL_SetColorKey(dst, (src->flags & (SDL_SRCCOLORKEY | SDL_RLEACCELOK)) |
+							(flags & SDL_RLEACCELOK), SDL_MapRGB(dst->format, r, g, b));
+		}
+		if(src->flags & SDL_SRCALPHA)
+			SDL_SetAlpha(dst, (src->flags & (SDL_SRCALPHA | SDL_RLEACCELOK)) |
+						 (flags & SDL_RLEACCELOK), src->format->alpha);
+
+		// Reordering 8-bit channels keeps premultiplied colors as they were
+		if((src->flags & PREMULTIPLIED) && format->Amask && conv.to.loss[0] == 0 &&
+		   conv.to.loss[1] == 0 && conv.to.loss[2] == 0 && conv.to.loss[3] == 0)
+			dst->flags |= PREMULTIPLIED;
+
+		return dst;
+	}
+
+	SDL_Surface *Private::DisplayTarget(bool alpha)
+	{
+		SDL_Surface *video = SDL_GetVideoSurface();
+		if(video == NULL)
+		{
+			SDL_SetError("No video mode has been set");
+			return NULL;
+		}
+
+		SDL_PixelFormat *vf = video->format;
+		if(!alpha)
+		{
+			SDL_Surface *target = SDL_CreateRGBSurface(SDL_SWSURFACE, 1, 1, vf->BitsPerPixel,
+													   vf->Rmask, vf->Gmask, vf->Bmask, vf->Amask);
+			if(target && vf->palette && target->format->palette)
+				SDL_SetColors(target, vf->palette->colors, 0, vf->palette->ncolors);
+
+			return target;
+		}
+
+		// The same masks SDL_DisplayFormatAlpha() picks
+		Uint32 Rmask = 0x00FF0000, Gmask = 0x0000FF00, Bmask = 0x000000FF, Amask = 0xFF000000;
+
+		if(vf->BytesPerPixel == 2)
+		{
+			if(vf->Rmask == 0x1F && (vf->Bmask == 0xF800 || vf->Bmask == 0x7C00))
+			{
+				Rmask = 0x000000FF;
+				Bmask = 0x00FF0000;
+			}
+		}
+		else if(vf->BytesPerPixel > 2)
+		{
+			if(vf->Rmask == 0xFF && vf->Bmask == 0xFF0000)
+			{
+				Rmask = 0x000000FF;
+				Bmask = 0x00FF0000;
+			}
+			else if(vf->Rmask == 0xFF00 && vf->Bmask == 0xFF000000)
+			{
+				Amask = 0x000000FF;
+				Rmask = 0x0000FF00;
+				Gmask = 0x00FF0000;
+				Bmask = 0xFF000000;
+			}
+		}
+
+		return SDL_CreateRGBSurface(SDL_SWSURFACE, 1, 1, 32, Rmask, Gmask, Bmask, Amask);
+	}
+
+	SDL_Surface *Private::DisplayFormat(SDL_Surface *surface, bool alpha, bool dither)
+	{
+		SDL_Surface *video = SDL_GetVideoSurface();
+
+		// Let SDL pick hardware surfaces and report no video mode
+		if(video == NULL || (video->flags & SDL_HWSURFACE))
+			return alpha ? SDL_DisplayFormatAlpha(surface) : SDL_DisplayFormat(surface);
+
+		if(!alpha)
+			return ConvertSurface(surface, video->format, SDL_SWSURFACE |
+								  (surface->flags & (SDL_SRCCOLORKEY | SDL_SRCALPHA | SDL_RLEACCELOK)),
+								  dither);
+
+		SDL_Surface *target = DisplayTarget(true);
+		if(target == NULL)
+			return NULL;
+
+		SDL_Surface *converted = ConvertSurface(surface, target->format, SDL_SWSURFACE |
+												(surface->flags & (SDL_SRCALPHA | SDL_RLEACCELOK)));
+		SDL_FreeSurface(target);
+
+		return converted;
+	}
+}
@@ -0,0 +1,235 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <cstring>
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_time.h"
+#include "SDL4Cpp_damage.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace SDL
+{
+	namespace Private
+	{
+		/*!
+		 * \brief Private SDL4Cpp_damage function
+		 *
+		 * Check if size bytes at a and b are the same, stopping at the first
+		 * difference. Most tiles either match completely or differ early, so
+		 * this beats hashing them.
+		 */
+		static bool RowsEqual(const Uint8 *a, const Uint8 *b, int size)
+		{
+			int i = 0;
+
+		#if defined(__AVX2__)
+			for(; i + 32 <= size; i += 32)
+			{
+				__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+				__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+				if(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)) != -1)
+					return false;
+			}
+		#endif
+		#if defined(__SSE2__)
+			for(; i + 16 <= size; i += 16)
+			{
+				__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+				__m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+				if(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF)
+					return false;
+			}
+		#endif
+
+			return memcmp(a + i, b + i, size - i) == 0;
+		}
+
+		/*!
+		 * \brief Private SDL4Cpp_damage function
+		 *
+		 * Check if the tile touches any of the hints
+		 */
+		static bool Touches(int x, int y, int w, int h, int numhints, SDL_Rect *hints)
+		{
+			for(int i = 0; i < numhints; i++)
+			{
+				if(x < hints[i].x + hints[i].w && hints[i].x < x + w &&
+					y < hints[i].y + hints[i].h && hints[i].y < y + h)
+					return true;
+			}
+
+			return false;
+		}
+
+		DamageTracker::DamageTracker(int tilesize) : m_Shadow(), m_Rects(),
+			m_Above(), m_Current(), m_Tile(tilesize > 0 ? tilesize : 32),
+			m_W(0), m_H(0), m_Pitch(0), m_Format(), m_Stats()
+		{
+		}
+
+		void DamageTracker::Present(SDL_Surface *screen, int numhints, SDL_Rect *hints)
+		{
+			PixelFormat *format = screen->format;
+			Uint32 current[5] = { format->BitsPerPixel, format->Rmask, format->Gmask,
+				format->Bmask, format->Amask };
+
+			if(screen->w != m_W || screen->h != m_H || screen->pitch != m_Pitch ||
+				memcmp(current, m_Format, sizeof(m_Format)) != 0)
+			{
+				memcpy(m_Format, current, sizeof(m_Format));
+				Reset(screen);
+				return;
+			}
+
+			if(SDL_LockSurface(screen) != 0)
+			{
+				Reset(screen);
+				return;
+			}
+
+			Uint64 start = GetMicroTicks();
+			int bpp = format->BytesPerPixel;
+			const Uint8 *pixels = static_cast<const Uint8 *>(screen->pixels);
+
+			m_Rects.clear();
+			m_Above.clear();
+			m_Stats.tiles = m_Stats.changed = 0;
+
+			for(int ty = 0; ty < m_H; ty += m_Tile)
+			{
+				int th = m_Tile < m_H - ty ? m_Tile : m_H - ty;
+				int run = -1;
+
+				m_Current.clear();
+				for(int tx = 0; tx < m_W; tx += m_Tile)
+				{
+					int tw = m_Tile < m_W - tx ? m_Tile : m_W - tx;
+					bool changed = false;
+
+					if(hints == NULL || Touches(tx, ty, tw, th, numhints, hints))
+					{
+						m_Stats.tiles++;
+
+						int offset = ty * m_Pitch + tx * bpp;
+						for(int y = 0; y < th && !changed; y++)
+						{
+							changed = !RowsEqual(pixels + offset + y * m_Pitch,
+								&m_Shadow[offset + y * m_Pitch], tw * bpp);
+						}
+
+						if(changed)
+						{
+							m_Stats.changed++;
+							for(int y = 0; y < th; y++)
+								memcpy(&m_Shadow[offset + y * m_Pitch], pixels + offset + y * m_Pitch, tw * bpp);
+						}
+					}
+
+					if(changed && run < 0)
+						run = tx;
+					else if(!changed && run >= 0)
+					{
+						AddRect(run, ty, tx - run, th);
+						run = -1;
+					}
+				}
+
+				if(run >= 0)
+					AddRect(run, ty, m_W - run, th);
+
+				m_Above.swap(m_Current);
+			}
+
+			SDL_UnlockSurface(screen);
+			m_Stats.comparetime = static_cast<Uint32>(GetMicroTicks() - start);
+
+			Uint32 updated = 0;
+			for(unsigned int i = 0; i < m_Rects.size(); i++)
+				updated += m_Rects[i].w * m_Rects[i].h * bpp;
+
+			m_Stats.rects = m_Rects.size();
+			m_Stats.updated = updated;
+			m_Stats.saved = m_W * m_H * bpp - updated;
+
+			if(!m_Rects.empty())
+				SDL_UpdateRects(screen, m_Rects.size(), &m_Rects[0]);
+		}
+
+		void DamageTracker::Invalidate()
+		{
+			m_W = m_H = m_Pitch = 0;
+		}
+
+		DamageStats DamageTracker::GetStats()
+		{
+			return m_Stats;
+		}
+
+		void DamageTracker::Reset(SDL_Surface *screen)
+		{
+			m_W = m_H = m_Pitch = 0;
+			m_Shadow.clear();
+
+			int tiles = ((screen->w + m_Tile - 1) / m_Tile) * ((screen->h + m_Tile - 1) / m_Tile);
+			m_Stats.tiles = m_Stats.changed = tiles;
+			m_Stats.rects = 1;
+			m_Stats.comparetime = 0;
+			m_Stats.updated = screen->w * screen->h * screen->format->BytesPerPixel;
+			m_Stats.saved = 0;
+
+			if(SDL_LockSurface(screen) == 0)
+			{
+				const Uint8 *pixels = static_cast<const Uint8 *>(screen->pixels);
+				m_Shadow.assign(pixels, pixels + screen->pitch * screen->h);
+				SDL_UnlockSurface(screen);
+
+				m_W = screen->w;
+				m_H = screen->h;
+				m_Pitch = screen->pitch;
+			}
+
+			SDL_UpdateRect(screen, 0, 0, 0, 0);
+		}
+
+		void DamageTracker::AddRect(int x, int y, int w, int h)
+		{
+			for(unsigned int i = 0; i < m_Above.size(); i++)
+			{
+				SDL_Rect &above = m_Rects[m_Above[i]];
+				if(above.x == x && above.w == w && above.y + above.h == y)
+				{
+					above.h += h;
+					m_Current.push_back(m_Above[i]);
+					return;
+				}
+			}
+
+			SDL_Rect rect;
+			rect.x = x;
+			rect.y = y;
+			rect.w = w;
+			rect.h = h;
+
+			m_Current.push_back(m_Rects.size());
+			m_Rects.push_back(rect);
+		}
+	}
+}
@@ -0,0 +1,82 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+/*
+ * The tile comparison behind Screen::SetDamageTracking(). This header is not
+ * installed.
+ */
+
+#ifndef SDL4CPP_DAMAGE_H
+#define SDL4CPP_DAMAGE_H
+
+#include <vector>
+#include "SDL4Cpp_video.h"
+
+namespace SDL
+{
+	namespace Private
+	{
+		/*!
+		 * \brief Keeps a shadow of the last frame shown and updates only
+		 * the tiles that differ from it.
+		 */
+		class DamageTracker
+		{
+			public:
+				explicit DamageTracker(int tilesize);
+
+				/*!
+				 * \brief Send the changed parts of screen to the display.
+				 *
+				 * With hints only tiles touching one of the numhints
+				 * rectangles are looked at.
+				 */
+				void Present(SDL_Surface *screen, int numhints, SDL_Rect *hints);
+
+				/*!
+				 * \brief Forget the shadow, the next Present() sends
+				 * everything.
+				 */
+				void Invalidate();
+
+				DamageStats GetStats();
+			private:
+				/*!
+				 * \brief Start over with a full update of screen.
+				 */
+				void Reset(SDL_Surface *screen);
+
+				/*!
+				 * \brief Add a changed run of tiles, merging it with a run
+				 * from the tile row above when they line up.
+				 */
+				void AddRect(int x, int y, int w, int h);
+
+				std::vector<Uint8> m_Shadow;
+				std::vector<SDL_Rect> m_Rects;
+				/*!
+				 * \brief Rects ending at the previous and current tile row.
+				 */
+				std::vector<unsigned int> m_Above, m_Current;
+				int m_Tile;
+				int m_W, m_H, m_Pitch;
+				Uint32 m_Format[5];
+				DamageStats m_Stats;
+		};
+	}
+}
+
+#endif
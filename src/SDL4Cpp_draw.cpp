@@ -0,0 +1,945 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_draw.h"
+#include "SDL4Cpp_blit.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace SDL
+{
+	/*!
+	 * \brief Private SDL4Cpp_draw structure
+	 *
+	 * The surface being drawn on and the color being drawn with.
+	 */
+	struct Pen
+	{
+		SDL_Surface *surface;
+		SDL_Rect clip;
+		Uint8 r, g, b;
+		/*! The color mapped with full alpha */
+		Uint32 pixel;
+		/*! 0 to 256 */
+		unsigned int alpha;
+		/*! 32-bit with 8-bit channels, blended a byte at a time */
+		bool bytewise;
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_draw structure
+	 *
+	 * A polygon edge in 16.16 fixed point, x is where the edge crosses the
+	 * center of row y1.
+	 */
+	struct Edge
+	{
+		int y1, y2;
+		Sint32 x, dx;
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_draw function
+	 *
+	 * Fill n 32-bit pixels with pixel.
+	 */
+	static void Fill32(Uint32 *p, int n, Uint32 pixel)
+	{
+		int i = 0;
+
+	#if defined(__AVX2__)
+		__m256i wide = _mm256_set1_epi32(pixel);
+		for(; i + 8 <= n; i += 8)
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(p + i), wide);
+	#endif
+	#if defined(__SSE2__)
+		__m128i value = _mm_set1_epi32(pixel);
+		for(; i + 4 <= n; i += 4)
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(p + i), value);
+	#endif
+
+		for(; i < n; i++)
+			p[i] = pixel;
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_draw function
+	 *
+	 * Blend n 32-bit pixels towards pixel by alpha (0 to 256), treating
+	 * every byte as a channel: d = (s * a + d * (256 - a)) >> 8. Every term
+	 * fits in 16 bits, so SSE2/AVX2 do eight/sixteen channels per multiply.
+	 */
+	static void Blend32(Uint32 *p, int n, Uint32 pixel, unsigned int alpha)
+	{
+		int i = 0;
+
+	#if defined(__AVX2__)
+		{
+			__m256i zero = _mm256_setzero_si256();
+			__m256i src = _mm256_mullo_epi16(_mm256_unpacklo_epi8(_mm256_set1_epi32(pixel), zero),
+				_mm256_set1_epi16(static_cast<short>(alpha)));
+			__m256i inverse = _mm256_set1_epi16(static_cast<short>(256 - alpha));
+
+			for(; i + 8 <= n; i += 8)
+			{
+				__m256i d = _mm256_loadu_si256(reinterpret_cast<__m256i *>(p + i));
+				__m256i lo = _mm256_unpacklo_epi8(d, zero);
+				__m256i hi = _mm256_unpackhi_epi8(d, zero);
+
+				lo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(lo, inverse), src), 8);
+				hi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(hi, inverse), src), 8);
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(p + i), _mm256_packus_epi16(lo, hi));
+			}
+		}
+	#endif
+	#if defined(__SSE2__)
+		{
+			__m128i zero = _mm_setzero_si128();
+			__m128i src = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set1_epi32(pixel), zero),
+				_mm_set1_epi16(static_cast<short>(alpha)));
+			__m128i inverse = _mm_set1_epi16(static_cast<short>(256 - alpha));
+
+			for(; i + 4 <= n; i += 4)
+			{
+				__m128i d = _mm_loadu_si128(reinterpret_cast<__m128i *>(p + i));
+				__m128i lo = _mm_unpacklo_epi8(d, zero);
+				__m128i hi = _mm_unpackhi_epi8(d, zero);
+
+				lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(lo, inverse), src), 8);
+				hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(hi, inverse), src), 8);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(p + i), _mm_packus_epi16(lo, hi));
+			}
+		}
+	#endif
+
+		// Two channels at a time in the gaps of a 32-bit int
+		Uint32 rb = (pixel & 0x00FF00FF) * alpha;
+		Uint32 ag = ((pixel >> 8) & 0x00FF00FF) * alpha;
+		unsigned int inverse = 256 - alpha;
+
+		for(; i < n; i++)
+		{
+			Uint32 d = p[i];
+			p[i] = (((rb + (d & 0x00FF00FF) * inverse) >> 8) & 0x00FF00FF) |
+				((ag + ((d >> 8) & 0x00FF00FF) * inverse) & 0xFF00FF00);
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_draw function
+	 *
+	 * Draw pixels x1 to x2 of row y, clipped. alpha is 0 to 256.
+	 */
+	static void Span(const Pen &pen, int x1, int x2, int y, unsigned int alpha)
+	{
+		const SDL_Rect &clip = pen.clip;
+
+		if(y < clip.y || y >= clip.y + clip.h || alpha == 0)
+			return;
+
+		if(x1 > x2)
+			std::swap(x1, x2);
+		if(x1 < clip.x)
+			x1 = clip.x;
+		if(x2 >= clip.x + clip.w)
+			x2 = clip.x + clip.w - 1;
+		if(x1 > x2)
+			return;
+
+		SDL_PixelFormat *format = pen.surface->format;
+		int bpp = format->BytesPerPixel;
+		int n = x2 - x1 + 1;
+		Uint8 *p = Private::PixelAddress(pen.surface, x1, y);
+
+		if(alpha >= 256)
+		{
+			switch(bpp)
+			{
+				case 1:
+					memset(p, static_cast<int>(pen.pixel), n);
+					break;
+				case 4:
+					Fill32(reinterpret_cast<Uint32 *>(p), n, pen.pixel);
+					break;
+				default:
+					for(int i = 0; i < n; i++, p += bpp)
+						Private::WritePixel(p, bpp, pen.pixel);
+					break;
+			}
+
+			return;
+		}
+
+		if(pen.bytewise)
+		{
+			Blend32(reinterpret_cast<Uint32 *>(p), n, pen.pixel, alpha);
+			return;
+		}
+
+		unsigned int inverse = 256 - alpha;
+		for(int i = 0; i < n; i++, p += bpp)
+		{
+			Uint8 r, g, b, a;
+			SDL_GetRGBA(Private::ReadPixel(p, bpp), format, &r, &g, &b, &a);
+
+			r = static_cast<Uint8>((pen.r * alpha + r * inverse) >> 8);
+			g = static_cast<Uint8>((pen.g * alpha + g * inverse) >> 8);
+			b = static_cast<Uint8>((pen.b * alpha + b * inverse) >> 8);
+			a = static_cast<Uint8>((255 * alpha + a * inverse) >> 8);
+
+			Private::WritePixel(p, bpp, SDL_MapRGBA(format, r, g, b, a));
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_draw function
+	 */
+	static void Plot(const Pen &pen, int x, int y)
+	{
+		Span(pen, x, x, y, pen.alpha);
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_draw function
+	 *
+	 * Plot the (up to) four mirror images of (x, y) around (cx, cy).
+	 */
+	static void Plot4(const Pen &pen, int cx, int cy, int x, int y)
+	{
+		Plot(pen, cx + x, cy + y);
+		if(x != 0)
+			Plot(pen, cx - x, cy + y);
+		if(y != 0)
+		{
+			Plot(pen, cx + x, cy - y);
+			if(x != 0)
+				Plot(pen, cx - x, cy - y);
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_draw function
+	 *
+	 * Set up pen for drawing on surface in color.
+	 */
+	static void SetPen(Pen &pen, SDL_Surface *surface, Color color, Uint8 alpha)
+	{
+		SDL_PixelFormat *format = surface->format;
+
+		pen.surface = surface;
+		pen.clip = surface->clip_rect;
+		pen.r = color.r;
+		pen.g = color.g;
+		pen.b = color.b;
+		pen.pixel = SDL_MapRGBA(format, color.r, color.g, color.b, 255);
+		pen.alpha = alpha + (alpha >> 7);
+		pen.bytewise = format->BytesPerPixel == 4 && format->Rloss == 0 &&
+			format->Gloss == 0 && format->Bloss == 0 &&
+			(format->Amask == 0 || format->Aloss == 0);
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_draw function
+	 *
+	 * Bresenham's line. Without last the end point isn't drawn, so joined
+	 * lines don't draw their corners twice.
+	 */
+	static void DrawLine(const Pen &pen, int x1, int y1, int x2, int y2, bool last)
+	{
+		int sx = x1 < x2 ? 1 : -1;
+		int sy = y1 < y2 ? 1 : -1;
+
+		if(y1 == y2)
+		{
+			if(!last)
+			{
+				if(x1 == x2)
+					return;
+				x2 -= sx;
+			}
+
+			Span(pen, x1, x2, y1, pen.alpha);
+			return;
+		}
+
+		// Entirely outside the clip rect
+		const SDL_Rect &clip = pen.clip;
+		if(std::max(x1, x2) < clip.x || std::min(x1, x2) >= clip.x + clip.w ||
+			std::max(y1, y2) < clip.y || std::min(y1, y2) >= clip.y + clip.h)
+			return;
+
+		int dx = abs(x2 - x1);
+		int dy = -abs(y2 - y1);
+		int error = dx + dy;
+
+		for(;;)
+		{
+			if(x1 == x2 && y1 == y2)
+			{
+				if(last)
+					Plot(pen, x1, y1);
+				break;
+			}
+
+			Plot(pen, x1, y1);
+
+			int e2 = 2 * error;
+			if(e2 >= dy)
+			{
+				error += dy;
+				x1 += sx;
+			}
+			if(e2 <= dx)
+			{
+				error += dx;
+				y1 += sy;
+			}
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_draw function
+	 *
+	 * Wu's line. The line is stepped along its major axis, and each step
+	 * covers the two pixels across it in proportion to where it crosses.
+	 */
+	static void DrawAALine(const Pen &pen, int x1, int y1, int x2, int y2)
+	{
+		bool steep = abs(y2 - y1) > abs(x2 - x1);
+
+		if(steep)
+		{
+			std::swap(x1, y1);
+			std::swap(x2, y2);
+		}
+		if(x1 > x2)
+		{
+			std::swap(x1, x2);
+			std::swap(y1, y2);
+		}
+
+		int dx = x2 - x1;
+		Sint32 gradient = dx ? static_cast<Sint32>((static_cast<Sint64>(y2 - y1) << 16) / dx) : 0;
+		Sint32 y = y1 * 65536;
+
+		for(int x = x1; x <= x2; x++, y += gradient)
+		{
+			int major = y >> 16;
+			unsigned int coverage = (y >> 8) & 0xFF;
+			unsigned int upper = (pen.alpha * (256 - coverage)) >> 8;
+			unsigned int lower = (pen.alpha * coverage) >> 8;
+
+			if(steep)
+			{
+				Span(pen, major, major, x, upper);
+				Span(pen, major + 1, major + 1, x, lower);
+			}
+			else
+			{
+				Span(pen, x, x, major, upper);
+				Span(pen, x, x, major + 1, lower);
+			}
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_draw function
+	 */
+	static void DrawRectangle(const Pen &pen, const SDL_Rect &rect)
+	{
+		if(rect.w == 0 || rect.h == 0)
+			return;
+
+		int x2 = rect.x + rect.w - 1;
+		int y2 = rect.y + rect.h - 1;
+
+		Span(pen, rect.x, x2, rect.y, pen.alpha);
+		if(y2 == rect.y)
+			return;
+
+		Span(pen, rect.x, x2, y2, pen.alpha);
+		for(int y = rect.y + 1; y < y2; y++)
+		{
+			Plot(pen, rect.x, y);
+			if(x2 != rect.x)
+				Plot(pen, x2, y);
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_draw function
+	 */
+	static void DrawFilledRect(const Pen &pen, const SDL_Rect &rect)
+	{
+		int y1 = std::max<int>(rect.y, pen.clip.y);
+		int y2 = std::min<int>(rect.y + rect.h, pen.clip.y + pen.clip.h);
+
+		if(rect.w == 0)
+			return;
+
+		for(int y = y1; y < y2; y++)
+			Span(pen, rect.x, rect.x + rect.w - 1, y, pen.alpha);
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_draw function
+	 *
+	 * Midpoint circle, one octant mirrored eight ways.
+	 */
+	static void DrawCircle(const Pen &pen, int cx, int cy, int r)
+	{
+		if(r < 0)
+			return;
+
+		int x = r, y = 0;
+		int error = 1 - r;
+
+		while(x >= y)
+		{
+			Plot4(pen, cx, cy, x, y);
+			if(x != y)
+				Plot4(pen, cx, cy, y, x);
+
+			y++;
+			if(error < 0)
+				error += 2 * y + 1;
+			else
+			{
+				x--;
+				error += 2 * (y - x) + 1;
+			}
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_draw function
+	 *
+	 * Midpoint ellipse, in two regions: where it's flatter than 45 degrees
+	 * x steps every pixel, after that y does.
+	 */
+	static void DrawEllipse(const Pen &pen, int cx, int cy, int rx, int ry)
+	{
+		if(rx < 0 || ry < 0)
+			return;
+
+		if(rx == ry)
+		{
+			DrawCircle(pen, cx, cy, rx);
+			return;
+		}
+		if(rx == 0 || ry == 0)
+		{
+			DrawLine(pen, cx - rx, cy - ry, cx + rx, cy + ry, true);
+			return;
+		}
+
+		Sint64 a2 = static_cast<Sint64>(rx) * rx;
+		Sint64 b2 = static_cast<Sint64>(ry) * ry;
+		int x = 0, y = ry;
+		Sint64 px = 0, py = 2 * a2 * y;
+
+		// The decision values are kept multiplied by 4 to stay integers
+		Sint64 p = 4 * b2 - 4 * a2 * ry + a2;
+		while(px < py)
+		{
+			Plot4(pen, cx, cy, x, y);
+
+			x++;
+			px += 2 * b2;
+			if(p < 0)
+				p += 4 * (b2 + px);
+			else
+			{
+				y--;
+				py -= 2 * a2;
+				p += 4 * (b2 + px - py);
+			}
+		}
+
+		p = b2 * (2 * x + 1) * (2 * x + 1) + 4 * a2 * (y - 1) * (y - 1) - 4 * a2 * b2;
+		while(y >= 0)
+		{
+			Plot4(pen, cx, cy, x, y);
+
+			y--;
+			py -= 2 * a2;
+			if(p > 0)
+				p += 4 * (a2 - py);
+			else
+			{
+				x++;
+				px += 2 * b2;
+				p += 4 * (a2 - py + px);
+			}
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_draw function
+	 *
+	 * One span per row, walking the half width in from rx as the rows move
+	 * away from the center. Rows are padded by half a pixel, which makes
+	 * small circles round instead of diamond shaped.
+	 */
+	static void DrawFilledEllipse(const Pen &pen, int cx, int cy, int rx, int ry)
+	{
+		if(rx < 0 || ry < 0)
+			return;
+
+		Sint64 a2 = static_cast<Sint64>(rx) * rx;
+		Sint64 b2 = static_cast<Sint64>(ry) * ry;
+		Sint64 limit = a2 * b2 + (rx || ry ? a2 * b2 / std::max(rx, ry) : 0);
+		int w = rx;
+
+		for(int y = 0; y <= ry; y++)
+		{
+			Sint64 dy = static_cast<Sint64>(y) * y * a2;
+			while(w > 0 && static_cast<Sint64>(w) * w * b2 + dy > limit)
+				w--;
+
+			Span(pen, cx - w, cx + w, cy + y, pen.alpha);
+			if(y != 0)
+				Span(pen, cx - w, cx + w, cy - y, pen.alpha);
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_draw function
+	 */
+	static void DrawPolygon(const Pen &pen, const Point *points, int n)
+	{
+		if(n == 1)
+			Plot(pen, points[0].x, points[0].y);
+
+		for(int i = 0; n > 1 && i < n; i++)
+		{
+			const Point &next = points[(i + 1) % n];
+			DrawLine(pen, points[i].x, points[i].y, next.x, next.y, false);
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_draw function
+	 *
+	 * Scanline polygon fill. Every row finds where the edges cross the row's
+	 * center, sorts those crossings and fills between pairs of them. Only
+	 * pixels whose centers are inside get drawn.
+	 *
+	 * edges and crossings are scratch space, so a DrawList can reuse them.
+	 */
+	static void DrawFilledPolygon(const Pen &pen, const Point *points, int n,
+								  std::vector<Edge> &edges,
+								  std::vector<Sint32> &crossings)
+	{
+		if(n < 3)
+			return;
+
+		int top = pen.clip.y + pen.clip.h, bottom = pen.clip.y;
+
+		edges.clear();
+		for(int i = 0; i < n; i++)
+		{
+			Point a = points[i], b = points[(i + 1) % n];
+
+			if(a.y == b.y)
+				continue;
+			if(a.y > b.y)
+				std::swap(a, b);
+
+			// Rows a.y to b.y - 1 have their centers between a and b
+			Edge edge;
+			Sint64 dy = b.y - a.y;
+			edge.y1 = std::max<int>(a.y, pen.clip.y);
+			edge.y2 = std::min<int>(b.y, pen.clip.y + pen.clip.h);
+			if(edge.y1 >= edge.y2)
+				continue;
+
+			edge.dx = static_cast<Sint32>((static_cast<Sint64>(b.x - a.x) << 16) / dy);
+			edge.x = static_cast<Sint32>((static_cast<Sint64>(a.x) << 16) +
+				((static_cast<Sint64>(b.x - a.x) * (2 * (edge.y1 - a.y) + 1)) << 16) / (2 * dy));
+
+			top = std::min(top, edge.y1);
+			bottom = std::max(bottom, edge.y2);
+			edges.push_back(edge);
+		}
+
+		for(int y = top; y < bottom; y++)
+		{
+			crossings.clear();
+			for(unsigned int i = 0; i < edges.size(); i++)
+			{
+				Edge &edge = edges[i];
+				if(y < edge.y1 || y >= edge.y2)
+					continue;
+
+				crossings.push_back(edge.x);
+				edge.x += edge.dx;
+			}
+
+			std::sort(crossings.begin(), crossings.end());
+
+			for(unsigned int i = 0; i + 1 < crossings.size(); i += 2)
+			{
+				// First and last pixel centers inside [a, b)
+				int x1 = (crossings[i] + 0x7FFF) >> 16;
+				int x2 = ((crossings[i + 1] + 0x7FFF) >> 16) - 1;
+
+				if(x1 <= x2)
+					Span(pen, x1, x2, y, pen.alpha);
+			}
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_draw function
+	 *
+	 * Lock dst and set up the pen.
+	 */
+	static bool Begin(Surface &dst, Pen &pen, Color color, Uint8 alpha, const char *caller)
+	{
+		if(dst.Get() == NULL)
+			throw LogicError(std::string("Surface not initialized before call to Draw::") + caller);
+
+		if(!dst.Lock())
+			return false;
+
+		SetPen(pen, dst.Get(), color, alpha);
+		return true;
+	}
+
+	namespace Draw
+	{
+		bool Pixel(Surface &dst, int x, int y, Color color, Uint8 alpha)
+		{
+			Pen pen;
+			if(!Begin(dst, pen, color, alpha, "Pixel"))
+				return false;
+
+			Plot(pen, x, y);
+			dst.Unlock();
+			return true;
+		}
+
+		bool Line(Surface &dst, int x1, int y1, int x2, int y2, Color color, Uint8 alpha)
+		{
+			Pen pen;
+			if(!Begin(dst, pen, color, alpha, "Line"))
+				return false;
+
+			DrawLine(pen, x1, y1, x2, y2, true);
+			dst.Unlock();
+			return true;
+		}
+
+		bool AALine(Surface &dst, int x1, int y1, int x2, int y2, Color color, Uint8 alpha)
+		{
+			Pen pen;
+			if(!Begin(dst, pen, color, alpha, "AALine"))
+				return false;
+
+			DrawAALine(pen, x1, y1, x2, y2);
+			dst.Unlock();
+			return true;
+		}
+
+		bool Rectangle(Surface &dst, Rect &rect, Color color, Uint8 alpha)
+		{
+			Pen pen;
+			if(!Begin(dst, pen, color, alpha, "Rectangle"))
+				return false;
+
+			DrawRectangle(pen, rect);
+			dst.Unlock();
+			return true;
+		}
+
+		bool FilledRect(Surface &dst, Rect &rect, Color color, Uint8 alpha)
+		{
+			Pen pen;
+			if(!Begin(dst, pen, color, alpha, "FilledRect"))
+				return false;
+
+			DrawFilledRect(pen, rect);
+			dst.Unlock();
+			return true;
+		}
+
+		bool Circle(Surface &dst, int x, int y, int r, Color color, Uint8 alpha)
+		{
+			Pen pen;
+			if(!Begin(dst, pen, color, alpha, "Circle"))
+				return false;
+
+			DrawCircle(pen, x, y, r);
+			dst.Unlock();
+			return true;
+		}
+
+		bool FilledCircle(Surface &dst, int x, int y, int r, Color color, Uint8 alpha)
+		{
+			Pen pen;
+			if(!Begin(dst, pen, color, alpha, "FilledCircle"))
+				return false;
+
+			DrawFilledEllipse(pen, x, y, r, r);
+			dst.Unlock();
+			return true;
+		}
+
+		bool Ellipse(Surface &dst, int x, int y, int rx, int ry, Color color, Uint8 alpha)
+		{
+			Pen pen;
+			if(!Begin(dst, pen, color, alpha, "Ellipse"))
+				return false;
+
+			DrawEllipse(pen, x, y, rx, ry);
+			dst.Unlock();
+			return true;
+		}
+
+		bool FilledEllipse(Surface &dst, int x, int y, int rx, int ry, Color color, Uint8 alpha)
+		{
+			Pen pen;
+			if(!Begin(dst, pen, color, alpha, "FilledEllipse"))
+				return false;
+
+			DrawFilledEllipse(pen, x, y, rx, ry);
+			dst.Unlock();
+			return true;
+		}
+
+		bool Triangle(Surface &dst, int x1, int y1, int x2, int y2, int x3, int y3, Color color, Uint8 alpha)
+		{
+			Point points[3] = { { x1, y1 }, { x2, y2 }, { x3, y3 } };
+			return Polygon(dst, points, 3, color, alpha);
+		}
+
+		bool FilledTriangle(Surface &dst, int x1, int y1, int x2, int y2, int x3, int y3, Color color, Uint8 alpha)
+		{
+			Point points[3] = { { x1, y1 }, { x2, y2 }, { x3, y3 } };
+			return FilledPolygon(dst, points, 3, color, alpha);
+		}
+
+		bool Polygon(Surface &dst, const Point *points, int n, Color color, Uint8 alpha)
+		{
+			Pen pen;
+			if(!Begin(dst, pen, color, alpha, "Polygon"))
+				return false;
+
+			DrawPolygon(pen, points, n);
+			dst.Unlock();
+			return true;
+		}
+
+		bool FilledPolygon(Surface &dst, const Point *points, int n, Color color, Uint8 alpha)
+		{
+			std::vector<Edge> edges;
+			std::vector<Sint32> crossings;
+			Pen pen;
+
+			if(!Begin(dst, pen, color, alpha, "FilledPolygon"))
+				return false;
+
+			DrawFilledPolygon(pen, points, n, edges, crossings);
+			dst.Unlock();
+			return true;
+		}
+	}
+
+	DrawList::DrawList() : m_Commands(), m_Points()
+	{
+	}
+
+	void DrawList::Clear()
+	{
+		m_Commands.clear();
+		m_Points.clear();
+	}
+
+	int DrawList::GetCount()
+	{
+		return m_Commands.size();
+	}
+
+	void DrawList::Pixel(int x, int y, Color color, Uint8 alpha)
+	{
+		Add(ShapePixel, x, y, 0, 0, color, alpha);
+	}
+
+	void DrawList::Line(int x1, int y1, int x2, int y2, Color color, Uint8 alpha)
+	{
+		Add(ShapeLine, x1, y1, x2, y2, color, alpha);
+	}
+
+	void DrawList::AALine(int x1, int y1, int x2, int y2, Color color, Uint8 alpha)
+	{
+		Add(ShapeAALine, x1, y1, x2, y2, color, alpha);
+	}
+
+	void DrawList::Rectangle(Rect &rect, Color color, Uint8 alpha)
+	{
+		Add(ShapeRectangle, rect.x, rect.y, rect.w, rect.h, color, alpha);
+	}
+
+	void DrawList::FilledRect(Rect &rect, Color color, Uint8 alpha)
+	{
+		Add(ShapeFilledRect, rect.x, rect.y, rect.w, rect.h, color, alpha);
+	}
+
+	void DrawList::Circle(int x, int y, int r, Color color, Uint8 alpha)
+	{
+		Add(ShapeEllipse, x, y, r, r, color, alpha);
+	}
+
+	void DrawList::FilledCircle(int x, int y, int r, Color color, Uint8 alpha)
+	{
+		Add(ShapeFilledEllipse, x, y, r, r, color, alpha);
+	}
+
+	void DrawList::Ellipse(int x, int y, int rx, int ry, Color color, Uint8 alpha)
+	{
+		Add(ShapeEllipse, x, y, rx, ry, color, alpha);
+	}
+
+	void DrawList::FilledEllipse(int x, int y, int rx, int ry, Color color, Uint8 alpha)
+	{
+		Add(ShapeFilledEllipse, x, y, rx, ry, color, alpha);
+	}
+
+	void DrawList::Triangle(int x1, int y1, int x2, int y2, int x3, int y3, Color color, Uint8 alpha)
+	{
+		Point points[3] = { { x1, y1 }, { x2, y2 }, { x3, y3 } };
+		AddPoints(ShapePolygon, points, 3, color, alpha);
+	}
+
+	void DrawList::FilledTriangle(int x1, int y1, int x2, int y2, int x3, int y3, Color color, Uint8 alpha)
+	{
+		Point points[3] = { { x1, y1 }, { x2, y2 }, { x3, y3 } };
+		AddPoints(ShapeFilledPolygon, points, 3, color, alpha);
+	}
+
+	void DrawList::Polygon(const Point *points, int n, Color color, Uint8 alpha)
+	{
+		AddPoints(ShapePolygon, points, n, color, alpha);
+	}
+
+	void DrawList::FilledPolygon(const Point *points, int n, Color color, Uint8 alpha)
+	{
+		AddPoints(ShapeFilledPolygon, points, n, color, alpha);
+	}
+
+	bool DrawList::Draw(Surface &dst)
+	{
+		if(dst.Get() == NULL)
+			throw LogicError("Surface not initialized before call to DrawList::Draw");
+
+		if(m_Commands.empty())
+			return true;
+
+		if(!dst.Lock())
+			return false;
+
+		std::vector<Edge> edges;
+		std::vector<Sint32> crossings;
+		Pen pen;
+
+		for(unsigned int i = 0; i < m_Commands.size(); i++)
+		{
+			const Command &command = m_Commands[i];
+			const int *args = command.args;
+
+			// Mapping the color is the expensive part of SetPen
+			if(i == 0 || memcmp(&command.color, &m_Commands[i - 1].color, sizeof(Color)) != 0)
+				SetPen(pen, dst.Get(), command.color, command.alpha);
+			else
+				pen.alpha = command.alpha + (command.alpha >> 7);
+
+			switch(command.shape)
+			{
+				case ShapePixel:
+					Plot(pen, args[0], args[1]);
+					break;
+				case ShapeLine:
+					DrawLine(pen, args[0], args[1], args[2], args[3], true);
+					break;
+				case ShapeAALine:
+					DrawAALine(pen, args[0], args[1], args[2], args[3]);
+					break;
+				case ShapeRectangle:
+				case ShapeFilledRect:
+				{
+					SDL_Rect rect;
+					rect.x = static_cast<Sint16>(args[0]);
+					rect.y = static_cast<Sint16>(args[1]);
+					rect.w = static_cast<Uint16>(args[2]);
+					rect.h = static_cast<Uint16>(args[3]);
+
+					if(command.shape == ShapeRectangle)
+						DrawRectangle(pen, rect);
+					else
+						DrawFilledRect(pen, rect);
+					break;
+				}
+				case ShapeEllipse:
+					DrawEllipse(pen, args[0], args[1], args[2], args[3]);
+					break;
+				case ShapeFilledEllipse:
+					DrawFilledEllipse(pen, args[0], args[1], args[2], args[3]);
+					break;
+				case ShapePolygon:
+					DrawPolygon(pen, &m_Points[args[0]], args[1]);
+					break;
+				case ShapeFilledPolygon:
+					DrawFilledPolygon(pen, &m_Points[args[0]], args[1], edges, crossings);
+					break;
+			}
+		}
+
+		dst.Unlock();
+		return true;
+	}
+
+	void DrawList::Add(Shape shape, int a, int b, int c, int d, Color color, Uint8 alpha)
+	{
+		Command command;
+		command.shape = shape;
+		command.color = color;
+		command.alpha = alpha;
+		command.args[0] = a;
+		command.args[1] = b;
+		command.args[2] = c;
+		command.args[3] = d;
+
+		m_Commands.push_back(command);
+	}
+
+	void DrawList::AddPoints(Shape shape, const Point *points, int n, Color color, Uint8 alpha)
+	{
+		if(n <= 0)
+			return;
+
+		Add(shape, m_Points.size(), n, 0, 0, color, alpha);
+		m_Points.insert(m_Points.end(), points, points + n);
+	}
+}
@@ -0,0 +1,747 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <cmath>
+#include <cstring>
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_filter.h"
+#include "SDL4Cpp_blit.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace SDL
+{
+	/*!
+	 * \brief Private SDL4Cpp_filter variable
+	 *
+	 * Bytes of source rows a column strip may read per output row, about
+	 * what fits in L2 next to everything else.
+	 */
+	static const int s_TileBytes = 128 * 1024;
+
+	/*!
+	 * \brief Private SDL4Cpp_filter variable
+	 *
+	 * Scratch buffers not in use.
+	 */
+	static std::vector<std::vector<Uint8> *> s_Scratch;
+
+	/*!
+	 * \brief Private SDL4Cpp_filter function
+	 *
+	 * A scratch buffer of at least bytes bytes. Give it back with
+	 * ReleaseScratch().
+	 */
+	static std::vector<Uint8> *GetScratch(size_t bytes)
+	{
+		std::vector<Uint8> *scratch;
+
+		if(s_Scratch.empty())
+			scratch = new std::vector<Uint8>;
+		else
+		{
+			scratch = s_Scratch.back();
+			s_Scratch.pop_back();
+		}
+
+		if(scratch->size() < bytes)
+			scratch->resize(bytes);
+
+		return scratch;
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_filter function
+	 */
+	static void ReleaseScratch(std::vector<Uint8> *scratch)
+	{
+		s_Scratch.push_back(scratch);
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_filter function
+	 */
+	static inline int Clamp(int value, int low, int high)
+	{
+		return value < low ? low : (value > high ? high : value);
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_filter structure
+	 *
+	 * One filter over a whole image, split into bands of rows that can run
+	 * on different threads.
+	 */
+	struct Job
+	{
+		const Uint8 *src;
+		int srcpitch;
+		Uint8 *dst;
+		int dstpitch;
+		int w, h;
+		/*! Convolve() kernels, padded to an even number of taps */
+		const Sint16 *horizontal, *vertical;
+		int htaps, vtaps;
+		/*! BoxBlur() radius */
+		int radius;
+		/*! Sharpen() blurred copy of src and amount in 8.8 fixed point */
+		const Uint8 *blur;
+		int blurpitch;
+		int amount;
+		/*! Filter rows y1 up to y2 */
+		void (*run)(const Job &job, int y1, int y2);
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_filter class
+	 */
+	class BandTask : public MT::Task
+	{
+		public:
+			BandTask(const Job &job, int y1, int y2) : m_Job(job), m_Y1(y1), m_Y2(y2)
+			{
+			}
+
+			void Run()
+			{
+				m_Job.run(m_Job, m_Y1, m_Y2);
+			}
+		private:
+			BandTask(const BandTask &copy);
+			BandTask &operator =(const BandTask &copy);
+
+			const Job &m_Job;
+			int m_Y1, m_Y2;
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_filter function
+	 *
+	 * Run job over every row, in bands on pool's threads if there is one.
+	 */
+	static void RunJob(const Job &job, MT::ThreadPool *pool)
+	{
+		int threads = pool ? pool->GetThreads() : 1;
+		if(threads < 2 || job.h < 32)
+		{
+			job.run(job, 0, job.h);
+			return;
+		}
+
+		// A few bands per thread evens out threads that get held up
+		int bands = threads * 4;
+		int step = (job.h + bands - 1) / bands;
+		if(step < 8)
+			step = 8;
+
+		for(int y = 0; y < job.h; y += step)
+			pool->Add(new BandTask(job, y, y + step < job.h ? y + step : job.h));
+		pool->Wait();
+	}
+
+	void Private::VerticalRow(const Uint8 *const *rows, const Sint16 *weights, int taps,
+							  int offset, Sint16 *out, int n)
+	{
+		int i = 0;
+
+	#if defined(__SSE2__)
+		{
+			__m128i zero = _mm_setzero_si128();
+			__m128i round = _mm_set1_epi32(1 << 9);
+
+			for(; i + 16 <= n; i += 16)
+			{
+				__m128i acc0 = round, acc1 = round, acc2 = round, acc3 = round;
+
+				// Two rows at a time, interleaved so madd weights both
+				for(int k = 0; k < taps; k += 2)
+				{
+					__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[k] + offset + i));
+					__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[k + 1] + offset + i));
+					__m128i w = _mm_set1_epi32((weights[k] & 0xFFFF) | (weights[k + 1] << 16));
+					__m128i alo = _mm_unpacklo_epi8(a, zero), ahi = _mm_unpackhi_epi8(a, zero);
+					__m128i blo = _mm_unpacklo_epi8(b, zero), bhi = _mm_unpackhi_epi8(b, zero);
+
+					acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi16(alo, blo), w));
+					acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi16(alo, blo), w));
+					acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi16(ahi, bhi), w));
+					acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi16(ahi, bhi), w));
+				}
+
+				acc0 = _mm_srai_epi32(acc0, 10);
+				acc1 = _mm_srai_epi32(acc1, 10);
+				acc2 = _mm_srai_epi32(acc2, 10);
+				acc3 = _mm_srai_epi32(acc3, 10);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packs_epi32(acc0, acc1));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 8), _mm_packs_epi32(acc2, acc3));
+			}
+		}
+	#endif
+
+		for(; i < n; i++)
+		{
+			int acc = 1 << 9;
+			for(int k = 0; k < taps; k++)
+				acc += weights[k] * rows[k][offset + i];
+
+			out[i] = Clamp(acc >> 10, -32768, 32767);
+		}
+	}
+
+	void Private::HorizontalRow(const Sint16 *row, const Sint16 *weights, int taps,
+								Uint8 *out, int n)
+	{
+		int x = 0;
+
+	#if defined(__SSE2__)
+		{
+			__m128i round = _mm_set1_epi32(1 << 17);
+
+			// Two pixels at a time; interleaving pixel x + k with x + k + 1
+			// lets madd do two taps per channel
+			for(; x + 2 <= n; x += 2)
+			{
+				__m128i lo = round, hi = round;
+
+				for(int k = 0; k < taps; k += 2)
+				{
+					__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + (x + k) * 4));
+					__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + (x + k + 1) * 4));
+					__m128i w = _mm_set1_epi32((weights[k] & 0xFFFF) | (weights[k + 1] << 16));
+
+					lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+					hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+				}
+
+				__m128i result = _mm_packs_epi32(_mm_srai_epi32(lo, 18), _mm_srai_epi32(hi, 18));
+				_mm_storel_epi64(reinterpret_cast<__m128i *>(out + x * 4), _mm_packus_epi16(result, result));
+			}
+		}
+	#endif
+
+		for(; x < n; x++)
+		{
+			for(int c = 0; c < 4; c++)
+			{
+				int acc = 1 << 17;
+				for(int k = 0; k < taps; k++)
+					acc += weights[k] * row[(x + k) * 4 + c];
+
+				out[x * 4 + c] = Clamp(acc >> 18, 0, 255);
+			}
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_filter function
+	 *
+	 * Convolve() rows y1 to y2, a column strip at a time so the rows the
+	 * vertical kernel reads stay in cache from one output row to the next.
+	 */
+	static void ConvolveBand(const Job &job, int y1, int y2)
+	{
+		// The last tap is padding, so the radius is one less than half
+		int hradius = job.htaps / 2 - 1, vradius = job.vtaps / 2 - 1;
+		int tile = s_TileBytes / (job.vtaps * 4) & ~15;
+		if(tile < 64)
+			tile = 64;
+		if(tile > job.w)
+			tile = job.w;
+
+		// The vertical results for a strip plus the horizontal kernel's
+		// reach either side and a spare pixel
+		std::vector<Sint16> row((tile + job.htaps + 1) * 4);
+		std::vector<const Uint8 *> rows(job.vtaps);
+
+		for(int x1 = 0; x1 < job.w; x1 += tile)
+		{
+			int x2 = x1 + tile < job.w ? x1 + tile : job.w;
+			int left = x1 - hradius;
+			int c1 = left > 0 ? left : 0;
+			int c2 = x2 + hradius < job.w ? x2 + hradius : job.w;
+
+			for(int y = y1; y < y2; y++)
+			{
+				for(int k = 0; k < job.vtaps; k++)
+					rows[k] = job.src + Clamp(y + k - vradius, 0, job.h - 1) * job.srcpitch;
+
+				Sint16 *start = &row[(c1 - left) * 4];
+				Private::VerticalRow(&rows[0], job.vertical, job.vtaps, c1 * 4, start, (c2 - c1) * 4);
+
+				// Repeat the edge pixels out past the image
+				for(Sint16 *p = &row[0]; p < start; p += 4)
+					memcpy(p, start, 4 * sizeof(Sint16));
+				for(Sint16 *p = start + (c2 - c1) * 4; p < &row[0] + row.size(); p += 4)
+					memcpy(p, p - 4, 4 * sizeof(Sint16));
+
+				Private::HorizontalRow(&row[0], job.horizontal, job.htaps, job.dst + y * job.dstpitch + x1 * 4, x2 - x1);
+			}
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_filter function
+	 *
+	 * BoxBlur() rows y1 to y2. Column sums are kept for the whole width and
+	 * moved down a row at a time by adding the row coming in and taking
+	 * away the one going out, then each row of sums is run along the same
+	 * way.
+	 */
+	static void BoxBand(const Job &job, int y1, int y2)
+	{
+		int radius = job.radius, w = job.w, n = w * 4;
+		float scale = 1.0f / ((2 * radius + 1) * (2 * radius + 1));
+		std::vector<Sint32> sums(n, 0);
+
+		for(int k = -radius; k <= radius; k++)
+		{
+			const Uint8 *p = job.src + Clamp(y1 + k, 0, job.h - 1) * job.srcpitch;
+			for(int i = 0; i < n; i++)
+				sums[i] += p[i];
+		}
+
+		for(int y = y1; y < y2; y++)
+		{
+			if(y > y1)
+			{
+				const Uint8 *in = job.src + Clamp(y + radius, 0, job.h - 1) * job.srcpitch;
+				const Uint8 *out = job.src + Clamp(y - radius - 1, 0, job.h - 1) * job.srcpitch;
+				Sint32 *s = &sums[0];
+				int i = 0;
+
+			#if defined(__SSE2__)
+				__m128i zero = _mm_setzero_si128();
+				for(; i + 16 <= n; i += 16)
+				{
+					__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+					__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(out + i));
+					__m128i dlo = _mm_sub_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+					__m128i dhi = _mm_sub_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+					__m128i *p = reinterpret_cast<__m128i *>(s + i);
+
+					// Sign extend the 16-bit differences to 32
+					_mm_storeu_si128(p, _mm_add_epi32(_mm_loadu_si128(p), _mm_srai_epi32(_mm_unpacklo_epi16(dlo, dlo), 16)));
+					_mm_storeu_si128(p + 1, _mm_add_epi32(_mm_loadu_si128(p + 1), _mm_srai_epi32(_mm_unpackhi_epi16(dlo, dlo), 16)));
+					_mm_storeu_si128(p + 2, _mm_add_epi32(_mm_loadu_si128(p + 2), _mm_srai_epi32(_mm_unpacklo_epi16(dhi, dhi), 16)));
+					_mm_storeu_si128(p + 3, _mm_add_epi32(_mm_loadu_si128(p + 3), _mm_srai_epi32(_mm_unpackhi_epi16(dhi, dhi), 16)));
+				}
+			#endif
+
+				for(; i < n; i++)
+					s[i] += in[i] - out[i];
+			}
+
+			Uint8 *dst = job.dst + y * job.dstpitch;
+			Sint32 total[4] = { 0, 0, 0, 0 };
+			for(int k = -radius; k <= radius; k++)
+			{
+				const Sint32 *s = &sums[Clamp(k, 0, w - 1) * 4];
+				for(int c = 0; c < 4; c++)
+					total[c] += s[c];
+			}
+
+		#if defined(__SSE2__)
+			{
+				__m128i sum = _mm_loadu_si128(reinterpret_cast<const __m128i *>(total));
+				__m128 factor = _mm_set1_ps(scale), half = _mm_set1_ps(0.5f);
+
+				for(int x = 0; x < w; x++)
+				{
+					__m128i v = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(sum), factor), half));
+					v = _mm_packs_epi32(v, v);
+					*reinterpret_cast<Sint32 *>(dst + x * 4) = _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+
+					const __m128i *in = reinterpret_cast<const __m128i *>(&sums[(x + radius + 1 < w ? x + radius + 1 : w - 1) * 4]);
+					const __m128i *out = reinterpret_cast<const __m128i *>(&sums[(x - radius > 0 ? x - radius : 0) * 4]);
+					sum = _mm_add_epi32(sum, _mm_sub_epi32(_mm_loadu_si128(in), _mm_loadu_si128(out)));
+				}
+			}
+		#else
+			for(int x = 0; x < w; x++)
+			{
+				const Sint32 *in = &sums[(x + radius + 1 < w ? x + radius + 1 : w - 1) * 4];
+				const Sint32 *out = &sums[(x - radius > 0 ? x - radius : 0) * 4];
+
+				for(int c = 0; c < 4; c++)
+				{
+					dst[x * 4 + c] = static_cast<int>(total[c] * scale + 0.5f);
+					total[c] += in[c] - out[c];
+				}
+			}
+		#endif
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_filter function
+	 *
+	 * Sharpen() rows y1 to y2: src + (src - blur) * amount.
+	 */
+	static void SharpenBand(const Job &job, int y1, int y2)
+	{
+		int n = job.w * 4;
+
+		for(int y = y1; y < y2; y++)
+		{
+			const Uint8 *src = job.src + y * job.srcpitch;
+			const Uint8 *blur = job.blur + y * job.blurpitch;
+			Uint8 *dst = job.dst + y * job.dstpitch;
+			int i = 0;
+
+		#if defined(__SSE2__)
+			{
+				__m128i zero = _mm_setzero_si128();
+				__m128i w = _mm_set1_epi32(256 | (job.amount << 16));
+				__m128i round = _mm_set1_epi32(128);
+
+				for(; i + 16 <= n; i += 16)
+				{
+					__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+					__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(blur + i));
+					__m128i slo = _mm_unpacklo_epi8(s, zero), shi = _mm_unpackhi_epi8(s, zero);
+					__m128i dlo = _mm_sub_epi16(slo, _mm_unpacklo_epi8(b, zero));
+					__m128i dhi = _mm_sub_epi16(shi, _mm_unpackhi_epi8(b, zero));
+
+					// src * 256 + difference * amount, two channels per madd
+					__m128i r0 = _mm_madd_epi16(_mm_unpacklo_epi16(slo, dlo), w);
+					__m128i r1 = _mm_madd_epi16(_mm_unpackhi_epi16(slo, dlo), w);
+					__m128i r2 = _mm_madd_epi16(_mm_unpacklo_epi16(shi, dhi), w);
+					__m128i r3 = _mm_madd_epi16(_mm_unpackhi_epi16(shi, dhi), w);
+
+					r0 = _mm_srai_epi32(_mm_add_epi32(r0, round), 8);
+					r1 = _mm_srai_epi32(_mm_add_epi32(r1, round), 8);
+					r2 = _mm_srai_epi32(_mm_add_epi32(r2, round), 8);
+					r3 = _mm_srai_epi32(_mm_add_epi32(r3, round), 8);
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+						_mm_packus_epi16(_mm_packs_epi32(r0, r1), _mm_packs_epi32(r2, r3)));
+				}
+			}
+		#endif
+
+			for(; i < n; i++)
+				dst[i] = Clamp((src[i] * 256 + (src[i] - blur[i]) * job.amount + 128) >> 8, 0, 255);
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_filter function
+	 *
+	 * Check src can be filtered, create dst like it if needed, and lock
+	 * both.
+	 */
+	static bool Begin(Surface &dst, Surface &src, const char *function)
+	{
+		SDL_Surface *s = src.Get();
+		if(s == NULL)
+			throw LogicError(std::string("src not initialized before call to ") + function);
+
+		if(s->format->BytesPerPixel != 4)
+		{
+			SDL_SetError("Only 32-bit surfaces can be filtered");
+			return false;
+		}
+
+		SDL_Surface *d = dst.Get();
+		if(d == NULL || d->w != s->w || d->h != s->h)
+		{
+			if(!dst.CreateRGB(SDL_SWSURFACE, s->w, s->h, 32, s->format->Rmask,
+							  s->format->Gmask, s->format->Bmask, s->format->Amask))
+				return false;
+		}
+		else if(d->format->BytesPerPixel != 4)
+		{
+			SDL_SetError("Only 32-bit surfaces can be filtered");
+			return false;
+		}
+
+		if(!src.Lock())
+			return false;
+		if(dst.Get() != src.Get() && !dst.Lock())
+		{
+			src.Unlock();
+			return false;
+		}
+
+		return true;
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_filter function
+	 */
+	static void End(Surface &dst, Surface &src)
+	{
+		if(dst.Get() != src.Get())
+			dst.Unlock();
+		src.Unlock();
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_filter function
+	 *
+	 * Point job at src and dst. Filtering in place reads from a copy of src
+	 * in scratch instead.
+	 */
+	static void Setup(Job &job, Surface &dst, Surface &src, std::vector<Uint8> *&scratch)
+	{
+		SDL_Surface *s = src.Get(), *d = dst.Get();
+
+		memset(&job, 0, sizeof(job));
+		job.w = s->w;
+		job.h = s->h;
+		job.dst = static_cast<Uint8 *>(d->pixels);
+		job.dstpitch = d->pitch;
+		job.src = static_cast<const Uint8 *>(s->pixels);
+		job.srcpitch = s->pitch;
+		scratch = NULL;
+
+		if(s == d)
+		{
+			int bytes = s->w * 4;
+			scratch = GetScratch(bytes * s->h);
+
+			for(int y = 0; y < s->h; y++)
+				memcpy(&(*scratch)[y * bytes], job.src + y * s->pitch, bytes);
+
+			job.src = &(*scratch)[0];
+			job.srcpitch = bytes;
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_filter function
+	 *
+	 * Kernel's fixed point weights, padded with a 0 to an even length for
+	 * the two taps at a time loops.
+	 */
+	static std::vector<Sint16> Pad(const Kernel &kernel)
+	{
+		std::vector<Sint16> weights(kernel.GetFixed());
+		weights.push_back(0);
+
+		return weights;
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_filter function
+	 *
+	 * Convolve() with the surfaces already checked and locked.
+	 */
+	static void RunConvolve(Job &job, const Kernel &horizontal, const Kernel &vertical,
+							MT::ThreadPool *pool)
+	{
+		std::vector<Sint16> h = Pad(horizontal), v = Pad(vertical);
+
+		job.horizontal = &h[0];
+		job.htaps = h.size();
+		job.vertical = &v[0];
+		job.vtaps = v.size();
+		job.run = ConvolveBand;
+		RunJob(job, pool);
+	}
+
+	Kernel::Kernel() : m_Weights(), m_Fixed()
+	{
+		double identity = 1.0;
+		SetWeights(&identity, 1);
+	}
+
+	Kernel::Kernel(const double *weights, int size) : m_Weights(), m_Fixed()
+	{
+		SetWeights(weights, size);
+	}
+
+	Kernel Kernel::Gaussian(double sigma)
+	{
+		if(sigma <= 0)
+			return Kernel();
+
+		int radius = static_cast<int>(ceil(sigma * 3));
+		std::vector<double> weights(2 * radius + 1);
+		double total = 0;
+
+		for(int i = -radius; i <= radius; i++)
+		{
+			weights[i + radius] = exp(-(i * i) / (2 * sigma * sigma));
+			total += weights[i + radius];
+		}
+
+		for(unsigned int i = 0; i < weights.size(); i++)
+			weights[i] /= total;
+
+		return Kernel(&weights[0], weights.size());
+	}
+
+	Kernel Kernel::Box(int radius)
+	{
+		if(radius < 0)
+			radius = 0;
+
+		std::vector<double> weights(2 * radius + 1, 1.0 / (2 * radius + 1));
+
+		return Kernel(&weights[0], weights.size());
+	}
+
+	int Kernel::GetRadius() const
+	{
+		return m_Weights.size() / 2;
+	}
+
+	double Kernel::GetWeight(int i) const
+	{
+		return m_Weights[i];
+	}
+
+	const std::vector<Sint16> &Kernel::GetFixed() const
+	{
+		return m_Fixed;
+	}
+
+	void Kernel::SetWeights(const double *weights, int size)
+	{
+		m_Weights.assign(weights, weights + (size > 0 ? size : 0));
+		if(m_Weights.size() % 2 == 0)
+			m_Weights.push_back(0);
+
+		m_Fixed.resize(m_Weights.size());
+
+		// Round each weight, then put what rounding lost or gained on the
+		// center so a flat color comes out exactly the same
+		double total = 0;
+		int fixed = 0;
+		for(unsigned int i = 0; i < m_Weights.size(); i++)
+		{
+			double weight = m_Weights[i] < -2 ? -2 : (m_Weights[i] > 2 ? 2 : m_Weights[i]);
+			m_Fixed[i] = static_cast<Sint16>(Clamp(static_cast<int>(floor(weight * 16384 + 0.5)), -32767, 32767));
+			total += weight;
+			fixed += m_Fixed[i];
+		}
+
+		int center = m_Fixed.size() / 2;
+		int error = static_cast<int>(floor(total * 16384 + 0.5)) - fixed;
+		m_Fixed[center] = static_cast<Sint16>(Clamp(m_Fixed[center] + error, -32767, 32767));
+	}
+
+	bool Convolve(Surface &dst, Surface &src, const Kernel &horizontal, const Kernel &vertical,
+				  MT::ThreadPool *pool)
+	{
+		if(!Begin(dst, src, "Convolve(Surface, Surface, Kernel, Kernel, ThreadPool)"))
+			return false;
+
+		Job job;
+		std::vector<Uint8> *scratch;
+		Setup(job, dst, src, scratch);
+		RunConvolve(job, horizontal, vertical, pool);
+
+		if(scratch)
+			ReleaseScratch(scratch);
+		End(dst, src);
+
+		return true;
+	}
+
+	bool Convolve(Surface &surface, const Kernel &horizontal, const Kernel &vertical,
+				  MT::ThreadPool *pool)
+	{
+		return Convolve(surface, surface, horizontal, vertical, pool);
+	}
+
+	bool GaussianBlur(Surface &dst, Surface &src, double sigma, MT::ThreadPool *pool)
+	{
+		Kernel kernel = Kernel::Gaussian(sigma);
+
+		return Convolve(dst, src, kernel, kernel, pool);
+	}
+
+	bool GaussianBlur(Surface &surface, double sigma, MT::ThreadPool *pool)
+	{
+		return GaussianBlur(surface, surface, sigma, pool);
+	}
+
+	bool BoxBlur(Surface &dst, Surface &src, int radius, MT::ThreadPool *pool)
+	{
+		if(!Begin(dst, src, "BoxBlur(Surface, Surface, int, ThreadPool)"))
+			return false;
+
+		Job job;
+		std::vector<Uint8> *scratch;
+		Setup(job, dst, src, scratch);
+		job.radius = Clamp(radius, 0, 1023);
+		job.run = BoxBand;
+		RunJob(job, pool);
+
+		if(scratch)
+			ReleaseScratch(scratch);
+		End(dst, src);
+
+		return true;
+	}
+
+	bool BoxBlur(Surface &surface, int radius, MT::ThreadPool *pool)
+	{
+		return BoxBlur(surface, surface, radius, pool);
+	}
+
+	bool Sharpen(Surface &dst, Surface &src, double amount, double sigma, MT::ThreadPool *pool)
+	{
+		if(!Begin(dst, src, "Sharpen(Surface, Surface, double, double, ThreadPool)"))
+			return false;
+
+		// Blur into scratch, then combine it with src row by row, which is
+		// safe to do in place
+		SDL_Surface *s = src.Get();
+		int bytes = s->w * 4;
+		std::vector<Uint8> *blur = GetScratch(bytes * s->h);
+		Kernel kernel = Kernel::Gaussian(sigma);
+
+		Job job;
+		memset(&job, 0, sizeof(job));
+		job.w = s->w;
+		job.h = s->h;
+		job.src = static_cast<const Uint8 *>(s->pixels);
+		job.srcpitch = s->pitch;
+		job.dst = &(*blur)[0];
+		job.dstpitch = bytes;
+		RunConvolve(job, kernel, kernel, pool);
+
+		job.blur = job.dst;
+		job.blurpitch = bytes;
+		job.dst = static_cast<Uint8 *>(dst.Get()->pixels);
+		job.dstpitch = dst.Get()->pitch;
+		job.amount = Clamp(static_cast<int>(floor(amount * 256 + 0.5)), 0, 32767);
+		job.run = SharpenBand;
+		RunJob(job, pool);
+
+		ReleaseScratch(blur);
+		End(dst, src);
+
+		return true;
+	}
+
+	bool Sharpen(Surface &surface, double amount, double sigma, MT::ThreadPool *pool)
+	{
+		return Sharpen(surface, surface, amount, sigma, pool);
+	}
+
+	void FreeFilterScratch()
+	{
+		for(std::vector<std::vector<Uint8> *>::iterator i = s_Scratch.begin(); i != s_Scratch.end(); ++i)
+			delete *i;
+
+		s_Scratch.clear();
+	}
+}
@@ -0,0 +1,312 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <vector>
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_indexed.h"
+#include "SDL4Cpp_blit.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace SDL
+{
+	/*!
+	 * \brief Private SDL4Cpp_indexed function
+	 *
+	 * Expand a row of palette indices to 32-bit pixels through lut.
+	 * SSE2 has no gather, so there the lookups are done four at a time and
+	 * stored as one 128-bit write. AVX2 builds use a real gather.
+	 */
+	static void ExpandRow32(const Uint8 *src, Uint32 *dst, int w, const Uint32 *lut)
+	{
+		int x = 0;
+
+	#if defined(__AVX2__)
+		for(; x + 8 <= w; x += 8)
+		{
+			__m128i index = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + x));
+			__m256i pixels = _mm256_i32gather_epi32(reinterpret_cast<const int *>(lut),
+				_mm256_cvtepu8_epi32(index), 4);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), pixels);
+		}
+	#elif defined(__SSE2__)
+		for(; x + 4 <= w; x += 4)
+		{
+			__m128i pixels = _mm_set_epi32(lut[src[x + 3]], lut[src[x + 2]],
+				lut[src[x + 1]], lut[src[x]]);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), pixels);
+		}
+	#endif
+
+		for(; x < w; x++)
+			dst[x] = lut[src[x]];
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_indexed function
+	 *
+	 * Expand a row of palette indices to 16-bit pixels through lut.
+	 */
+	static void ExpandRow16(const Uint8 *src, Uint16 *dst, int w, const Uint32 *lut)
+	{
+		int x = 0;
+
+	#if defined(__SSE2__)
+		for(; x + 8 <= w; x += 8)
+		{
+			__m128i pixels = _mm_set_epi16(lut[src[x + 7]], lut[src[x + 6]],
+				lut[src[x + 5]], lut[src[x + 4]], lut[src[x + 3]],
+				lut[src[x + 2]], lut[src[x + 1]], lut[src[x]]);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), pixels);
+		}
+	#endif
+
+		for(; x < w; x++)
+			dst[x] = static_cast<Uint16>(lut[src[x]]);
+	}
+
+	IndexedSurface::IndexedSurface() : Surface(), m_LUT(), m_LUTBitsPerPixel(0),
+		m_LUTRmask(0), m_LUTGmask(0), m_LUTBmask(0), m_LUTAmask(0),
+		m_DirtyFirst(0), m_DirtyLast(255)
+	{
+	}
+
+	IndexedSurface::IndexedSurface(int w, int h, Uint32 flags) : Surface(), m_LUT(),
+		m_LUTBitsPerPixel(0), m_LUTRmask(0), m_LUTGmask(0), m_LUTBmask(0),
+		m_LUTAmask(0), m_DirtyFirst(0), m_DirtyLast(255)
+	{
+		if(!Create(w, h, flags))
+			throw RuntimeError("Error creating 8-bit surface: " + GetError());
+	}
+
+	IndexedSurface::~IndexedSurface()
+	{
+	}
+
+	bool IndexedSurface::Create(int w, int h, Uint32 flags)
+	{
+		Invalidate();
+
+		return CreateRGB(flags, w, h, 8, 0, 0, 0, 0);
+	}
+
+	bool IndexedSurface::LoadBMP(std::string file)
+	{
+		Invalidate();
+
+		if(!Surface::LoadBMP(file))
+			return false;
+
+		if(m_Surface->format->BitsPerPixel != 8)
+		{
+			Free();
+			SDL_SetError("%s is not an 8-bit BMP", file.c_str());
+			return false;
+		}
+
+		return true;
+	}
+
+	int IndexedSurface::SetColors(Color &colors, int firstcolor, int ncolors)
+	{
+		MarkDirty(firstcolor, ncolors);
+
+		return Surface::SetColors(colors, firstcolor, ncolors);
+	}
+
+	int IndexedSurface::SetPalette(int flags, Color &colors, int firstcolor, int ncolors)
+	{
+		MarkDirty(firstcolor, ncolors);
+
+		return Surface::SetPalette(flags, colors, firstcolor, ncolors);
+	}
+
+	bool IndexedSurface::RotateColors(int firstcolor, int ncolors, int shift)
+	{
+		if(m_Surface == NULL)
+			throw LogicError("m_Surface not intialized before call to RotateColors()");
+
+		Palette *palette = m_Surface->format->palette;
+		if(palette == NULL || firstcolor < 0 || ncolors <= 0 ||
+			firstcolor + ncolors > palette->ncolors)
+			return false;
+
+		shift %= ncolors;
+		if(shift < 0)
+			shift += ncolors;
+		if(shift == 0)
+			return true;
+
+		// SDL_SetColors() can't be handed its own palette, so work on a copy
+		std::vector<Color> rotated(ncolors);
+		for(int i = 0; i < ncolors; i++)
+			rotated[(i + shift) % ncolors] = palette->colors[firstcolor + i];
+
+		return SetColors(rotated[0], firstcolor, ncolors) != 0;
+	}
+
+	void IndexedSurface::Invalidate()
+	{
+		m_LUTBitsPerPixel = 0;
+		m_DirtyFirst = 0;
+		m_DirtyLast = 255;
+	}
+
+	bool IndexedSurface::BlitTo(Surface &dest)
+	{
+		return DoBlit(NULL, dest, NULL);
+	}
+
+	bool IndexedSurface::BlitTo(Surface &dest, Rect &destrect)
+	{
+		return DoBlit(NULL, dest, &destrect);
+	}
+
+	bool IndexedSurface::BlitTo(Rect &srcrect, Surface &dest, Rect &destrect)
+	{
+		return DoBlit(&srcrect, dest, &destrect);
+	}
+
+	bool IndexedSurface::UpdateLUT(PixelFormat &format)
+	{
+		if(format.BytesPerPixel != 2 && format.BytesPerPixel != 4)
+			return false;
+
+		Palette *palette = m_Surface->format->palette;
+		if(palette == NULL)
+			return false;
+
+		// A new destination format means every entry has to be remapped
+		if(format.BitsPerPixel != m_LUTBitsPerPixel || format.Rmask != m_LUTRmask ||
+			format.Gmask != m_LUTGmask || format.Bmask != m_LUTBmask ||
+			format.Amask != m_LUTAmask)
+		{
+			m_LUTBitsPerPixel = format.BitsPerPixel;
+			m_LUTRmask = format.Rmask;
+			m_LUTGmask = format.Gmask;
+			m_LUTBmask = format.Bmask;
+			m_LUTAmask = format.Amask;
+			m_DirtyFirst = 0;
+			m_DirtyLast = 255;
+		}
+
+		if(m_DirtyLast >= palette->ncolors)
+			m_DirtyLast = palette->ncolors - 1;
+
+		for(int i = m_DirtyFirst; i <= m_DirtyLast; i++)
+		{
+			const Color &c = palette->colors[i];
+			m_LUT[i] = SDL_MapRGB(&format, c.r, c.g, c.b);
+		}
+
+		m_DirtyFirst = 256;
+		m_DirtyLast = -1;
+
+		return true;
+	}
+
+	bool IndexedSurface::DoBlit(SDL_Rect *srcrect, Surface &dest, SDL_Rect *destrect)
+	{
+		if(m_Surface == NULL)
+			throw LogicError("m_Surface not intialized before call to BlitTo()");
+
+		SDL_Surface *dst = *dest;
+		if(dst == NULL)
+			throw LogicError("dest not initialized before call to BlitTo()");
+
+		// Anything the lookup table can't express goes through SDL
+		if(m_Surface->format->BitsPerPixel != 8 || (m_Surface->flags & SDL_SRCALPHA) ||
+			!UpdateLUT(*dst->format))
+		{
+			if(SDL_BlitSurface(m_Surface, srcrect, dst, destrect) == 0)
+				return true;
+
+			return false;
+		}
+
+		SDL_Rect s, d;
+		if(!Private::ClipBlit(m_Surface, srcrect, dst, destrect, s, d))
+			return true;
+
+		if(!Lock())
+			return false;
+
+		if(!dest.Lock())
+		{
+			Unlock();
+			return false;
+		}
+
+		bool colorkey = (m_Surface->flags & SDL_SRCCOLORKEY) != 0;
+		Uint32 key = m_Surface->format->colorkey;
+		int bpp = dst->format->BytesPerPixel;
+
+		for(int y = 0; y < s.h; y++)
+		{
+			const Uint8 *srcrow = Private::PixelAddress(m_Surface, s.x, s.y + y);
+			Uint8 *dstrow = Private::PixelAddress(dst, d.x, d.y + y);
+
+			if(colorkey)
+			{
+				// Keyed pixels can't be written blindly, do them one at a time
+				for(int x = 0; x < s.w; x++)
+				{
+					if(srcrow[x] == key)
+						continue;
+
+					if(bpp == 4)
+						reinterpret_cast<Uint32 *>(dstrow)[x] = m_LUT[srcrow[x]];
+					else
+						reinterpret_cast<Uint16 *>(dstrow)[x] = static_cast<Uint16>(m_LUT[srcrow[x]]);
+				}
+			}
+			else if(bpp == 4)
+				ExpandRow32(srcrow, reinterpret_cast<Uint32 *>(dstrow), s.w, m_LUT);
+			else
+				ExpandRow16(srcrow, reinterpret_cast<Uint16 *>(dstrow), s.w, m_LUT);
+		}
+
+		dest.Unlock();
+		Unlock();
+
+		return true;
+	}
+
+	void IndexedSurface::MarkDirty(int first, int count)
+	{
+		if(count <= 0)
+			return;
+
+		if(first < 0)
+		{
+			count += first;
+			first = 0;
+		}
+
+		int last = first + count - 1;
+		if(last > 255)
+			last = 255;
+
+		if(first < m_DirtyFirst)
+			m_DirtyFirst = first;
+		if(last > m_DirtyLast)
+			m_DirtyLast = last;
+	}
+}
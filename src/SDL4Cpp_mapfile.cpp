@@ -0,0 +1,125 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "SDL_error.h"
+#include "SDL4Cpp_mapfile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace SDL
+{
+	namespace Private
+	{
+	#if defined(_WIN32)
+		void *MapFile(const std::string &file, size_t &size, bool copyonwrite)
+		{
+			HANDLE handle = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ,
+				NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if(handle == INVALID_HANDLE_VALUE)
+			{
+				SDL_SetError("Couldn't open %s", file.c_str());
+				return NULL;
+			}
+
+			LARGE_INTEGER length;
+			if(!GetFileSizeEx(handle, &length) || length.QuadPart == 0 ||
+				static_cast<ULONGLONG>(length.QuadPart) > static_cast<size_t>(-1))
+			{
+				CloseHandle(handle);
+				SDL_SetError("Couldn't map %s", file.c_str());
+				return NULL;
+			}
+
+			HANDLE mapping = CreateFileMappingA(handle, NULL,
+				copyonwrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+			CloseHandle(handle);
+			if(mapping == NULL)
+			{
+				SDL_SetError("Couldn't map %s", file.c_str());
+				return NULL;
+			}
+
+			// The view keeps the mapping object alive on its own
+			void *data = MapViewOfFile(mapping, copyonwrite ? FILE_MAP_COPY : FILE_MAP_READ,
+				0, 0, 0);
+			CloseHandle(mapping);
+			if(data == NULL)
+			{
+				SDL_SetError("Couldn't map %s", file.c_str());
+				return NULL;
+			}
+
+			size = static_cast<size_t>(length.QuadPart);
+
+			return data;
+		}
+
+		void UnmapFile(void *data, size_t size)
+		{
+			if(data)
+				UnmapViewOfFile(data);
+		}
+	#else
+		void *MapFile(const std::string &file, size_t &size, bool copyonwrite)
+		{
+			int fd = open(file.c_str(), O_RDONLY);
+			if(fd < 0)
+			{
+				SDL_SetError("Couldn't open %s", file.c_str());
+				return NULL;
+			}
+
+			struct stat info;
+			if(fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0)
+			{
+				close(fd);
+				SDL_SetError("Couldn't map %s", file.c_str());
+				return NULL;
+			}
+
+			int prot = PROT_READ;
+			if(copyonwrite)
+				prot |= PROT_WRITE;
+
+			// MAP_PRIVATE makes writes copy the page instead of reaching the file
+			void *data = mmap(NULL, info.st_size, prot, MAP_PRIVATE, fd, 0);
+			close(fd);
+			if(data == MAP_FAILED)
+			{
+				SDL_SetError("Couldn't map %s", file.c_str());
+				return NULL;
+			}
+
+			size = info.st_size;
+
+			return data;
+		}
+
+		void UnmapFile(void *data, size_t size)
+		{
+			if(data)
+				munmap(data, size);
+		}
+	#endif
+	}
+}
@@ -0,0 +1,50 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+/*
+ * Private helpers for mapping files into memory. This header is not
+ * installed.
+ */
+
+#ifndef SDL4CPP_MAPFILE_H
+#define SDL4CPP_MAPFILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace SDL
+{
+	namespace Private
+	{
+		/*!
+		 * \brief Map all of file into memory.
+		 *
+		 * With copyonwrite the pages can be written to without the changes
+		 * reaching the file, otherwise the mapping is read only.
+		 *
+		 * \return The mapping, or NULL with the SDL error set. Empty files
+		 * can't be mapped.
+		 */
+		void *MapFile(const std::string &file, size_t &size, bool copyonwrite);
+
+		/*!
+		 * \brief Undo MapFile().
+		 */
+		void UnmapFile(void *data, size_t size);
+	}
+}
+
+#endif
@@ -0,0 +1,186 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "SDL_endian.h"
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_mapped.h"
+#include "SDL4Cpp_mapfile.h"
+
+namespace SDL
+{
+	/*!
+	 * \brief Private SDL4Cpp_mapped function
+	 *
+	 * Read little endian values out of the BMP headers
+	 */
+	static Uint16 ReadLE16(const Uint8 *data)
+	{
+		return data[0] | (data[1] << 8);
+	}
+
+	static Uint32 ReadLE32(const Uint8 *data)
+	{
+		return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<Uint32>(data[3]) << 24);
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_mapped function
+	 *
+	 * Check if the BMP in data can be used without copying it. If it can,
+	 * pixels, width, height and the masks are filled in.
+	 */
+	static bool CanBorrow(const Uint8 *data, size_t size, Uint32 &offset,
+		int &width, int &height, Uint32 &Rmask, Uint32 &Gmask, Uint32 &Bmask, Uint32 &Amask)
+	{
+		// SDL wants pixels in host order, BMPs are always little endian
+		if(SDL_BYTEORDER != SDL_LIL_ENDIAN)
+			return false;
+
+		// BITMAPFILEHEADER + BITMAPINFOHEADER
+		if(size < 54 || data[0] != 'B' || data[1] != 'M')
+			return false;
+
+		offset = ReadLE32(data + 10);
+		Uint32 infosize = ReadLE32(data + 14);
+		Sint32 w = static_cast<Sint32>(ReadLE32(data + 18));
+		Sint32 h = static_cast<Sint32>(ReadLE32(data + 22));
+		Uint16 planes = ReadLE16(data + 26);
+		Uint16 bits = ReadLE16(data + 28);
+		Uint32 compression = ReadLE32(data + 30);
+
+		// Only top-down (negative height) images have rows in the order
+		// SDL expects, and SDL's pitch is 16 bits
+		if(infosize < 40 || planes != 1 || bits != 32 || w <= 0 || h >= 0 ||
+			w > 0xFFFF / 4)
+			return false;
+
+		// The usual headers leave the pixels 2 bytes off a 4 byte boundary,
+		// which only x86 is happy to read 32 bits at a time from
+	#if !defined(__i386__) && !defined(__x86_64__) && !defined(_M_IX86) && !defined(_M_X64)
+		if(offset % 4 != 0)
+			return false;
+	#endif
+
+		width = w;
+		height = -h;
+
+		if(offset > size || (size - offset) / (width * 4) < static_cast<size_t>(height))
+			return false;
+
+		if(compression == 0)	// BI_RGB
+		{
+			Rmask = 0x00FF0000;
+			Gmask = 0x0000FF00;
+			Bmask = 0x000000FF;
+			Amask = 0;
+		}
+		else if(compression == 3)	// BI_BITFIELDS
+		{
+			// The masks follow a plain info header, or are part of a V4/V5 one
+			if(size < 14 + 40 + 12 || offset < 14 + 40 + 12)
+				return false;
+
+			Rmask = ReadLE32(data + 54);
+			Gmask = ReadLE32(data + 58);
+			Bmask = ReadLE32(data + 62);
+			Amask = 0;
+
+			if(infosize >= 56 && size >= 14 + 56)
+				Amask = ReadLE32(data + 66);
+		}
+		else
+			return false;
+
+		return true;
+	}
+
+	MappedSurface::MappedSurface() : Surface(), m_Map(NULL), m_MapSize(0)
+	{
+	}
+
+	MappedSurface::MappedSurface(const MappedSurface &copy) : Surface(copy),
+		m_Map(NULL), m_MapSize(0)
+	{
+	}
+
+	MappedSurface::~MappedSurface()
+	{
+		Free();
+	}
+
+	MappedSurface &MappedSurface::operator =(const MappedSurface &copy)
+	{
+		if(this != &copy)
+			Surface::operator =(copy);
+
+		return *this;
+	}
+
+	bool MappedSurface::LoadBMP(std::string file)
+	{
+		Free();
+
+		size_t size = 0;
+		void *map = Private::MapFile(file, size, true);
+
+		// Things like pipes can't be mapped, let SDL read those
+		if(map == NULL)
+			return Surface::LoadBMP(file);
+
+		const Uint8 *data = static_cast<const Uint8 *>(map);
+		Uint32 offset, Rmask, Gmask, Bmask, Amask;
+		int width, height;
+
+		if(CanBorrow(data, size, offset, width, height, Rmask, Gmask, Bmask, Amask))
+		{
+			m_Surface = SDL_CreateRGBSurfaceFrom(static_cast<Uint8 *>(map) + offset,
+				width, height, 32, width * 4, Rmask, Gmask, Bmask, Amask);
+
+			if(m_Surface)
+			{
+				m_Map = map;
+				m_MapSize = size;
+				return true;
+			}
+		}
+		else
+		{
+			// Decode it from the mapping rather than reading the file again
+			m_Surface = SDL_LoadBMP_RW(SDL_RWFromConstMem(map, static_cast<int>(size)), 1);
+		}
+
+		Private::UnmapFile(map, size);
+
+		return m_Surface != NULL;
+	}
+
+	bool MappedSurface::IsMapped()
+	{
+		return m_Map != NULL;
+	}
+
+	void MappedSurface::Free()
+	{
+		Surface::Free();
+
+		if(m_Map)
+		{
+			Private::UnmapFile(m_Map, m_MapSize);
+			m_Map = NULL;
+			m_MapSize = 0;
+		}
+	}
+}
@@ -0,0 +1,337 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <cmath>
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_mipmap.h"
+#include "SDL4Cpp_blit.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace SDL
+{
+	/*!
+	 * \brief Private SDL4Cpp_mipmap variable
+	 *
+	 * sRGB bytes to linear light from 0 to 65535.
+	 */
+	static Uint16 s_ToLinear[256];
+
+	/*!
+	 * \brief Private SDL4Cpp_mipmap variable
+	 *
+	 * Linear light / 16 back to sRGB bytes.
+	 */
+	static Uint8 s_FromLinear[4097];
+
+	/*!
+	 * \brief Private SDL4Cpp_mipmap function
+	 */
+	static void MakeTables()
+	{
+		for(int i = 0; i < 256; i++)
+		{
+			double c = i / 255.0;
+			double l = c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+			s_ToLinear[i] = static_cast<Uint16>(l * 65535.0 + 0.5);
+		}
+
+		for(int i = 0; i <= 4096; i++)
+		{
+			double l = i * 16 / 65535.0;
+			if(l > 1.0)
+				l = 1.0;
+			double c = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+			s_FromLinear[i] = static_cast<Uint8>(c * 255.0 + 0.5);
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_mipmap structure
+	 *
+	 * Fills the tables during static initialization, before any thread
+	 * can build a chain.
+	 */
+	struct Tables
+	{
+		Tables()
+		{
+			MakeTables();
+		}
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_mipmap variable
+	 */
+	static Tables s_Tables;
+
+	/*!
+	 * \brief Private SDL4Cpp_mipmap function
+	 *
+	 * Average 2x2 blocks of row0 and row1 into w pixels of dst. srcw is
+	 * the width of the rows, and when it's odd the last column is dropped
+	 * unless it's the only one.
+	 */
+	static void HalveRow(const Uint32 *row0, const Uint32 *row1, Uint32 *dst, int w, int srcw)
+	{
+		int x = 0;
+
+#if defined(__SSE2__)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i two = _mm_set1_epi16(2);
+		for(; x + 4 <= w; x += 4)
+		{
+			__m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + x * 2));
+			__m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + x * 2 + 4));
+			__m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + x * 2));
+			__m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + x * 2 + 4));
+
+			// Columns added down, two source pixels per register
+			__m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+			__m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+			__m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+			__m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+			// Then each pair of pixels added across
+			s0 = _mm_add_epi16(s0, _mm_srli_si128(s0, 8));
+			s1 = _mm_add_epi16(s1, _mm_srli_si128(s1, 8));
+			s2 = _mm_add_epi16(s2, _mm_srli_si128(s2, 8));
+			s3 = _mm_add_epi16(s3, _mm_srli_si128(s3, 8));
+
+			__m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s0, s1), two), 2);
+			__m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s2, s3), two), 2);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(lo, hi));
+		}
+#endif
+
+		for(; x < w; x++)
+		{
+			int x0 = x * 2;
+			int x1 = x0 + 1 < srcw ? x0 + 1 : x0;
+			Uint32 p = row0[x0], q = row0[x1], r = row1[x0], s = row1[x1];
+
+			Uint32 result = 0;
+			for(int shift = 0; shift < 32; shift += 8)
+			{
+				Uint32 sum = ((p >> shift) & 0xff) + ((q >> shift) & 0xff) +
+							 ((r >> shift) & 0xff) + ((s >> shift) & 0xff);
+				result |= ((sum + 2) >> 2) << shift;
+			}
+			dst[x] = result;
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_mipmap function
+	 *
+	 * HalveRow() averaging the bytes of the pixel that are set in linear
+	 * as linear light.
+	 *
+	 * There's no SSE2 version: every byte is a table lookup both ways, and
+	 * SSE2 has no gather, so it would spend its time moving bytes in and
+	 * out of registers.
+	 */
+	static void HalveRowGamma(const Uint32 *row0, const Uint32 *row1, Uint32 *dst, int w, int srcw,
+							  Uint32 linear)
+	{
+		for(int x = 0; x < w; x++)
+		{
+			int x0 = x * 2;
+			int x1 = x0 + 1 < srcw ? x0 + 1 : x0;
+			Uint32 p = row0[x0], q = row0[x1], r = row1[x0], s = row1[x1];
+
+			Uint32 result = 0;
+			for(int shift = 0; shift < 32; shift += 8)
+			{
+				Uint32 sum;
+				if(linear & (0xffu << shift))
+				{
+					sum = ((p >> shift) & 0xff) + ((q >> shift) & 0xff) +
+						  ((r >> shift) & 0xff) + ((s >> shift) & 0xff);
+					sum = (sum + 2) >> 2;
+				}
+				else
+				{
+					sum = static_cast<Uint32>(s_ToLinear[(p >> shift) & 0xff]) + s_ToLinear[(q >> shift) & 0xff] +
+						  s_ToLinear[(r >> shift) & 0xff] + s_ToLinear[(s >> shift) & 0xff];
+					sum = s_FromLinear[(sum + 32) >> 6];
+				}
+				result |= sum << shift;
+			}
+			dst[x] = result;
+		}
+	}
+
+	MipChain::MipChain() : m_Pixels(), m_Levels()
+	{
+	}
+
+	MipChain::~MipChain()
+	{
+		Free();
+	}
+
+	void MipChain::Free()
+	{
+		for(size_t i = 0; i < m_Levels.size(); i++)
+			delete m_Levels[i];
+
+		m_Levels.clear();
+		std::vector<Uint8>().swap(m_Pixels);
+	}
+
+	int MipChain::GetLevelCount() const
+	{
+		return static_cast<int>(m_Levels.size());
+	}
+
+	Surface &MipChain::GetLevel(int level)
+	{
+		if(level < 0 || level >= GetLevelCount())
+			throw LogicError("level passed to MipChain::GetLevel(int) isn't in the chain");
+
+		return *m_Levels[level];
+	}
+
+	double MipChain::GetScale(int level) const
+	{
+		if(level < 0 || level >= GetLevelCount())
+			return 0.0;
+
+		// Along the longer side, since a side stops halving at 1
+		const SDL_Surface *full = m_Levels[0]->Get();
+		const SDL_Surface *part = m_Levels[level]->Get();
+		if(full->w >= full->h)
+			return static_cast<double>(part->w) / full->w;
+
+		return static_cast<double>(part->h) / full->h;
+	}
+
+	int MipChain::PickLevel(double scale) const
+	{
+		int level = 0;
+		while(level + 1 < GetLevelCount() && GetScale(level + 1) >= scale)
+			level++;
+
+		return level;
+	}
+
+	bool MipChain::Blit(Surface &dst, int x, int y, double scale, double angle, Filter filter)
+	{
+		if(m_Levels.empty())
+			throw LogicError("MipChain not built before call to MipChain::Blit(Surface, int, int, double, double, Filter)");
+
+		int level = PickLevel(scale);
+
+		return dst.BlitTransformed(*m_Levels[level], x, y, angle, scale / GetScale(level), filter);
+	}
+
+	bool MipChain::Build(SDL_Surface *source, bool gamma)
+	{
+		const SDL_PixelFormat *format = source->format;
+		if(format->BytesPerPixel != 4 || format->Rloss || format->Gloss || format->Bloss ||
+		   (format->Amask && format->Aloss))
+		{
+			SDL_SetError("Only 32-bit surfaces with 8-bit channels can be mipmapped");
+			return false;
+		}
+
+		// Every level after 0 goes in m_Pixels, with rows padded to 16 bytes
+		size_t total = 0;
+		for(int w = source->w, h = source->h; w > 1 || h > 1; )
+		{
+			w = w > 1 ? w / 2 : 1;
+			h = h > 1 ? h / 2 : 1;
+			total += static_cast<size_t>((w * 4 + 15) & ~15) * h;
+		}
+
+		for(size_t i = 0; i < m_Levels.size(); i++)
+			delete m_Levels[i];
+		m_Levels.clear();
+		m_Pixels.resize(total);
+
+		source->refcount++;
+		m_Levels.push_back(new Surface(source));
+
+		if(SDL_MUSTLOCK(source) && SDL_LockSurface(source) < 0)
+		{
+			Free();
+			return false;
+		}
+
+		// Bytes that are averaged as they are: alpha, or the spare byte
+		Uint32 linear = ~(format->Rmask | format->Gmask | format->Bmask);
+
+		bool ok = true;
+		size_t offset = 0;
+		SDL_Surface *previous = source;
+		while(previous->w > 1 || previous->h > 1)
+		{
+			int w = previous->w > 1 ? previous->w / 2 : 1;
+			int h = previous->h > 1 ? previous->h / 2 : 1;
+			int pitch = (w * 4 + 15) & ~15;
+
+			SDL_Surface *level = SDL_CreateRGBSurfaceFrom(&m_Pixels[offset], w, h, 32, pitch,
+														  format->Rmask, format->Gmask, format->Bmask,
+														  format->Amask);
+			if(level == NULL)
+			{
+				ok = false;
+				break;
+			}
+
+			SDL_SetColorKey(level, source->flags & SDL_SRCCOLORKEY, format->colorkey);
+			SDL_SetAlpha(level, source->flags & SDL_SRCALPHA, format->alpha);
+			level->flags |= source->flags & PREMULTIPLIED;
+			m_Levels.push_back(new Surface(level));
+
+			for(int y = 0; y < h; y++)
+			{
+				int y0 = y * 2;
+				int y1 = y0 + 1 < previous->h ? y0 + 1 : y0;
+				const Uint32 *row0 = reinterpret_cast<const Uint32 *>(Private::PixelAddress(previous, 0, y0));
+				const Uint32 *row1 = reinterpret_cast<const Uint32 *>(Private::PixelAddress(previous, 0, y1));
+				Uint32 *out = reinterpret_cast<Uint32 *>(Private::PixelAddress(level, 0, y));
+
+				if(gamma)
+					HalveRowGamma(row0, row1, out, w, previous->w, linear);
+				else
+					HalveRow(row0, row1, out, w, previous->w);
+			}
+
+			offset += static_cast<size_t>(pitch) * h;
+			previous = level;
+		}
+
+		if(SDL_MUSTLOCK(source))
+			SDL_UnlockSurface(source);
+
+		if(!ok)
+			Free();
+
+		return ok;
+	}
+
+	bool Surface::BuildMipChain(MipChain &chain, bool gamma)
+	{
+		if(m_Surface == NULL)
+			throw LogicError("m_Surface not intialized before call to BuildMipChain(MipChain, bool)");
+
+		return chain.Build(m_Surface, gamma);
+	}
+}
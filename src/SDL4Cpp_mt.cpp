@@ -14,8 +14,15 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  */
 
+#include "SDL4Cpp_main.h"
 #include "SDL4Cpp_mt.h"
 
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
 namespace SDL
 {
 	namespace MT
@@ -129,6 +136,164 @@ namespace SDL
 		{
 			return SDL_CondWaitTimeout(cond, mutex, ms);
 		}
+
+		int GetCPUCount(void)
+		{
+			int count = 1;
+
+		#if defined(_WIN32)
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			count = info.dwNumberOfProcessors;
+		#elif defined(_SC_NPROCESSORS_ONLN)
+			count = sysconf(_SC_NPROCESSORS_ONLN);
+		#endif
+
+			if(count < 1)
+				count = 1;
+
+			return count;
+		}
+
+		Locker::Locker(Mutex *mutex) : m_Mutex(mutex)
+		{
+			SDL_mutexP(m_Mutex);
+		}
+
+		Locker::~Locker()
+		{
+			SDL_mutexV(m_Mutex);
+		}
+
+		Task::~Task()
+		{
+		}
+
+		/*!
+		 * \brief Private SDL4Cpp_mt function
+		 *
+		 * Destroy whichever of mutex, work and idle were created.
+		 */
+		static void DestroySync(Mutex *mutex, Cond *work, Cond *idle)
+		{
+			if(idle)
+				SDL_DestroyCond(idle);
+			if(work)
+				SDL_DestroyCond(work);
+			if(mutex)
+				SDL_DestroyMutex(mutex);
+		}
+
+		ThreadPool::ThreadPool(int threads) : m_Threads(), m_Tasks(), m_Mutex(NULL),
+			m_Work(NULL), m_Idle(NULL), m_Running(0), m_Quit(false)
+		{
+			if(threads < 1)
+				threads = GetCPUCount();
+
+			m_Mutex = SDL_CreateMutex();
+			m_Work = SDL_CreateCond();
+			m_Idle = SDL_CreateCond();
+
+			// The destructor doesn't run when the constructor throws, so
+			// what was made has to be freed here
+			if(m_Mutex == NULL || m_Work == NULL || m_Idle == NULL)
+			{
+				std::string error = GetError();
+				DestroySync(m_Mutex, m_Work, m_Idle);
+				throw RuntimeError("Error creating ThreadPool: " + error);
+			}
+
+			for(int i = 0; i < threads; i++)
+			{
+				Thread *thread = SDL_CreateThread(Worker, this);
+				if(thread == NULL)
+					break;
+
+				m_Threads.push_back(thread);
+			}
+
+			if(m_Threads.empty())
+			{
+				std::string error = GetError();
+				DestroySync(m_Mutex, m_Work, m_Idle);
+				throw RuntimeError("Error creating ThreadPool threads: " + error);
+			}
+		}
+
+		ThreadPool::~ThreadPool()
+		{
+			SDL_mutexP(m_Mutex);
+			m_Quit = true;
+			SDL_CondBroadcast(m_Work);
+			SDL_mutexV(m_Mutex);
+
+			for(unsigned int i = 0; i < m_Threads.size(); i++)
+				SDL_WaitThread(m_Threads[i], NULL);
+
+			SDL_DestroyCond(m_Idle);
+			SDL_DestroyCond(m_Work);
+			SDL_DestroyMutex(m_Mutex);
+		}
+
+		void ThreadPool::Add(Task *task)
+		{
+			Locker lock(m_Mutex);
+
+			m_Tasks.push_back(task);
+			SDL_CondSignal(m_Work);
+		}
+
+		void ThreadPool::Wait()
+		{
+			Locker lock(m_Mutex);
+
+			while(!m_Tasks.empty() || m_Running != 0)
+				SDL_CondWait(m_Idle, m_Mutex);
+		}
+
+		int ThreadPool::Pending()
+		{
+			Locker lock(m_Mutex);
+
+			return m_Tasks.size() + m_Running;
+		}
+
+		int ThreadPool::GetThreads()
+		{
+			return m_Threads.size();
+		}
+
+		int ThreadPool::Worker(void *data)
+		{
+			ThreadPool *pool = static_cast<ThreadPool *>(data);
+
+			SDL_mutexP(pool->m_Mutex);
+			for(;;)
+			{
+				while(pool->m_Tasks.empty() && !pool->m_Quit)
+					SDL_CondWait(pool->m_Work, pool->m_Mutex);
+
+				// Only quit once everything queued has been run
+				if(pool->m_Tasks.empty())
+					break;
+
+				Task *task = pool->m_Tasks.front();
+				pool->m_Tasks.pop_front();
+				pool->m_Running++;
+				SDL_mutexV(pool->m_Mutex);
+
+				task->Run();
+				delete task;
+
+				SDL_mutexP(pool->m_Mutex);
+				pool->m_Running--;
+				if(pool->m_Tasks.empty() && pool->m_Running == 0)
+					SDL_CondBroadcast(pool->m_Idle);
+			}
+			SDL_mutexV(pool->m_Mutex);
+
+			return 0;
+		}
 	}
 }
 
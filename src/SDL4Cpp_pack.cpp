@@ -0,0 +1,604 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <cstring>
+#include "SDL_endian.h"
+#include "SDL_rwops.h"
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_pack.h"
+#include "SDL4Cpp_mapfile.h"
+
+/*
+ * File layout, all header fields are little endian:
+ *
+ * Header, 64 bytes
+ *   0  magic "SDL4CPK\x1a"
+ *   8  version
+ *  12  byte order of the pixel data (SDL_LIL_ENDIAN or SDL_BIG_ENDIAN)
+ *  16  number of entries
+ *  20  offset of the index
+ *
+ * Index entry, 96 bytes
+ *   0  name, NUL terminated
+ *  48  width, height, pitch, bits per pixel
+ *  64  Rmask, Gmask, Bmask, Amask
+ *  80  flags (see below, bits 8-15 are the per-surface alpha)
+ *  84  colorkey
+ *  88  offset of the pixels, a multiple of 64
+ *  92  size of the pixels as stored
+ */
+
+namespace SDL
+{
+	static const char PackMagic[8] = { 'S', 'D', 'L', '4', 'C', 'P', 'K', '\x1a' };
+	static const Uint32 PackVersion = 1;
+	static const Uint32 PackHeaderSize = 64;
+	static const Uint32 PackEntrySize = 96;
+	static const Uint32 PackNameSize = 48;
+	static const Uint32 PackAlign = 64;
+	/*! The most SDL_CreateRGBSurface() can size, since it multiplies in int */
+	static const size_t PackMaxUnpacked = 0x7FFFFFFF;
+
+	enum
+	{
+		PackCompressed = 0x01,
+		PackColorKey = 0x02,
+		PackSrcAlpha = 0x04
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_pack function
+	 *
+	 * Read a little endian value out of the mapping
+	 */
+	static Uint32 ReadLE32(const Uint8 *data)
+	{
+		return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<Uint32>(data[3]) << 24);
+	}
+
+	static Uint32 AlignPack(Uint32 value)
+	{
+		return (value + PackAlign - 1) & ~(PackAlign - 1);
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_pack function
+	 *
+	 * Largest size LZ4Compress() can produce for size bytes
+	 */
+	static size_t LZ4Bound(size_t size)
+	{
+		return size + size / 255 + 16;
+	}
+
+	static void LZ4Length(Uint8 *&out, size_t length)
+	{
+		for(; length >= 255; length -= 255)
+			*out++ = 255;
+		*out++ = static_cast<Uint8>(length);
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_pack function
+	 *
+	 * Compress src into dst using the LZ4 block format, with a greedy single
+	 * hash table match finder. dst must hold LZ4Bound(size) bytes.
+	 *
+	 * \return The compressed size.
+	 */
+	static size_t LZ4Compress(const Uint8 *src, size_t size, Uint8 *dst)
+	{
+		const int hashbits = 12;
+		std::vector<Uint32> table(1 << hashbits, 0);
+		Uint8 *out = dst;
+		size_t anchor = 0;
+
+		// The format wants the last 5 bytes as literals, and no match to
+		// start in the last 12
+		if(size >= 13)
+		{
+			size_t i = 0;
+			while(i < size - 12)
+			{
+				Uint32 sequence;
+				memcpy(&sequence, src + i, 4);
+
+				Uint32 hash = (sequence * 2654435761U) >> (32 - hashbits);
+				size_t ref = table[hash];
+				table[hash] = i;
+
+				if(ref >= i || i - ref > 65535 || memcmp(src + ref, src + i, 4) != 0)
+				{
+					i++;
+					continue;
+				}
+
+				size_t length = 4;
+				while(i + length < size - 5 && src[ref + length] == src[i + length])
+					length++;
+
+				size_t literals = i - anchor;
+				Uint8 *token = out++;
+				*token = (literals >= 15 ? 15 : literals) << 4;
+				if(literals >= 15)
+					LZ4Length(out, literals - 15);
+
+				memcpy(out, src + anchor, literals);
+				out += literals;
+
+				size_t offset = i - ref;
+				*out++ = offset & 0xFF;
+				*out++ = offset >> 8;
+
+				size_t match = length - 4;
+				*token |= match >= 15 ? 15 : match;
+				if(match >= 15)
+					LZ4Length(out, match - 15);
+
+				i += length;
+				anchor = i;
+			}
+		}
+
+		size_t literals = size - anchor;
+		*out++ = (literals >= 15 ? 15 : literals) << 4;
+		if(literals >= 15)
+			LZ4Length(out, literals - 15);
+
+		memcpy(out, src + anchor, literals);
+		out += literals;
+
+		return out - dst;
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_pack function
+	 *
+	 * Decompress an LZ4 block of exactly outsize bytes.
+	 *
+	 * \return False if the block is corrupt.
+	 */
+	static bool LZ4Decompress(const Uint8 *src, size_t size, Uint8 *dst, size_t outsize)
+	{
+		const Uint8 *in = src, *end = src + size;
+		Uint8 *out = dst, *outend = dst + outsize;
+
+		while(in < end)
+		{
+			Uint8 token = *in++;
+			size_t literals = token >> 4;
+			if(literals == 15)
+			{
+				Uint8 more;
+				do
+				{
+					if(in >= end)
+						return false;
+					more = *in++;
+					literals += more;
+				} while(more == 255);
+			}
+
+			if(literals > static_cast<size_t>(end - in) ||
+				literals > static_cast<size_t>(outend - out))
+				return false;
+
+			memcpy(out, in, literals);
+			in += literals;
+			out += literals;
+
+			// The last sequence has no match
+			if(in == end)
+				break;
+
+			if(end - in < 2)
+				return false;
+
+			size_t offset = in[0] | (in[1] << 8);
+			in += 2;
+			if(offset == 0 || offset > static_cast<size_t>(out - dst))
+				return false;
+
+			size_t length = token & 15;
+			if(length == 15)
+			{
+				Uint8 more;
+				do
+				{
+					if(in >= end)
+						return false;
+					more = *in++;
+					length += more;
+				} while(more == 255);
+			}
+			length += 4;
+
+			if(length > static_cast<size_t>(outend - out))
+				return false;
+
+			// Matches can overlap what they write, so go a byte at a time
+			const Uint8 *match = out - offset;
+			for(size_t i = 0; i < length; i++)
+				out[i] = match[i];
+			out += length;
+		}
+
+		return out == outend;
+	}
+
+	SurfacePack::SurfacePack() : m_Map(NULL), m_MapSize(0), m_Count(0)
+	{
+	}
+
+	SurfacePack::SurfacePack(std::string file) : m_Map(NULL), m_MapSize(0), m_Count(0)
+	{
+		if(!Open(file))
+			throw RuntimeError("Error opening surface pack: " + GetError());
+	}
+
+	SurfacePack::~SurfacePack()
+	{
+		Close();
+	}
+
+	bool SurfacePack::Open(std::string file)
+	{
+		Close();
+
+		size_t size = 0;
+		Uint8 *map = static_cast<Uint8 *>(Private::MapFile(file, size, true));
+		if(map == NULL)
+			return false;
+
+		if(size < PackHeaderSize || memcmp(map, PackMagic, sizeof(PackMagic)) != 0)
+		{
+			Private::UnmapFile(map, size);
+			SDL_SetError("%s is not a surface pack", file.c_str());
+			return false;
+		}
+
+		Uint32 count = ReadLE32(map + 16);
+		Uint32 index = ReadLE32(map + 20);
+
+		if(ReadLE32(map + 8) != PackVersion || ReadLE32(map + 12) != SDL_BYTEORDER ||
+			index < PackHeaderSize || index > size || count > (size - index) / PackEntrySize)
+		{
+			Private::UnmapFile(map, size);
+			SDL_SetError("%s is an unsupported or corrupt surface pack", file.c_str());
+			return false;
+		}
+
+		// Check everything up front, so Get() can trust the index
+		for(Uint32 i = 0; i < count; i++)
+		{
+			const Uint8 *entry = map + index + i * PackEntrySize;
+			Uint32 w = ReadLE32(entry + 48);
+			Uint32 h = ReadLE32(entry + 52);
+			Uint32 pitch = ReadLE32(entry + 56);
+			Uint32 bpp = ReadLE32(entry + 60);
+			Uint32 flags = ReadLE32(entry + 80);
+			Uint32 offset = ReadLE32(entry + 88);
+			Uint32 stored = ReadLE32(entry + 92);
+
+			bool valid = memchr(entry, 0, PackNameSize) != NULL &&
+				(bpp == 16 || bpp == 24 || bpp == 32) &&
+				w > 0 && h > 0 && w <= 0xFFFF && h <= 0xFFFF &&
+				pitch >= w * (bpp / 8) && pitch <= 0xFFFF &&
+				offset % PackAlign == 0 && offset <= size && stored <= size - offset;
+
+			if(valid && !(flags & PackCompressed))
+				valid = stored / pitch >= h;
+			else if(valid)
+				valid = static_cast<size_t>(pitch) * h <= PackMaxUnpacked;
+
+			if(!valid)
+			{
+				Private::UnmapFile(map, size);
+				SDL_SetError("%s has a corrupt entry %u", file.c_str(), i);
+				return false;
+			}
+		}
+
+		m_Map = map;
+		m_MapSize = size;
+		m_Count = count;
+
+		return true;
+	}
+
+	void SurfacePack::Close()
+	{
+		if(m_Map)
+		{
+			Private::UnmapFile(m_Map, m_MapSize);
+			m_Map = NULL;
+			m_MapSize = 0;
+			m_Count = 0;
+		}
+	}
+
+	int SurfacePack::GetCount()
+	{
+		return m_Count;
+	}
+
+	std::string SurfacePack::GetName(int index)
+	{
+		if(index < 0 || index >= m_Count)
+			return "";
+
+		return reinterpret_cast<const char *>(m_Map + ReadLE32(m_Map + 20) + index * PackEntrySize);
+	}
+
+	int SurfacePack::Find(std::string name)
+	{
+		if(name.size() >= PackNameSize)
+			return -1;
+
+		const Uint8 *entry = m_Map + (m_Map ? ReadLE32(m_Map + 20) : 0);
+		for(int i = 0; i < m_Count; i++, entry += PackEntrySize)
+		{
+			if(strcmp(reinterpret_cast<const char *>(entry), name.c_str()) == 0)
+				return i;
+		}
+
+		return -1;
+	}
+
+	bool SurfacePack::Get(int index, Surface &surface)
+	{
+		if(m_Map == NULL)
+			throw LogicError("SurfacePack not opened before call to Get()");
+
+		if(index < 0 || index >= m_Count)
+		{
+			SDL_SetError("No surface %d in the pack", index);
+			return false;
+		}
+
+		const Uint8 *entry = m_Map + ReadLE32(m_Map + 20) + index * PackEntrySize;
+		int w = ReadLE32(entry + 48);
+		int h = ReadLE32(entry + 52);
+		int pitch = ReadLE32(entry + 56);
+		int bpp = ReadLE32(entry + 60);
+		Uint32 Rmask = ReadLE32(entry + 64);
+		Uint32 Gmask = ReadLE32(entry + 68);
+		Uint32 Bmask = ReadLE32(entry + 72);
+		Uint32 Amask = ReadLE32(entry + 76);
+		Uint32 flags = ReadLE32(entry + 80);
+		Uint32 colorkey = ReadLE32(entry + 84);
+		Uint8 *pixels = m_Map + ReadLE32(entry + 88);
+		Uint32 stored = ReadLE32(entry + 92);
+
+		SDL_Surface *s;
+		if(flags & PackCompressed)
+		{
+			s = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, bpp, Rmask, Gmask, Bmask, Amask);
+			if(s == NULL)
+				return false;
+
+			bool unpacked;
+			size_t unpacksize = static_cast<size_t>(pitch) * h;
+			if(s->pitch == pitch)
+				unpacked = LZ4Decompress(pixels, stored, static_cast<Uint8 *>(s->pixels), unpacksize);
+			else
+			{
+				std::vector<Uint8> rows(unpacksize);
+				unpacked = LZ4Decompress(pixels, stored, &rows[0], rows.size());
+
+				for(int y = 0; unpacked && y < h; y++)
+					memcpy(static_cast<Uint8 *>(s->pixels) + static_cast<size_t>(y) * s->pitch,
+						   &rows[static_cast<size_t>(y) * pitch], w * (bpp / 8));
+			}
+
+			if(!unpacked)
+			{
+				SDL_FreeSurface(s);
+				SDL_SetError("Surface %d in the pack is corrupt", index);
+				return false;
+			}
+		}
+		else
+		{
+			s = SDL_CreateRGBSurfaceFrom(pixels, w, h, bpp, pitch, Rmask, Gmask, Bmask, Amask);
+			if(s == NULL)
+				return false;
+		}
+
+		if(flags & PackColorKey)
+			SDL_SetColorKey(s, SDL_SRCCOLORKEY, colorkey);
+
+		SDL_SetAlpha(s, (flags & PackSrcAlpha) ? SDL_SRCALPHA : 0, (flags >> 8) & 0xFF);
+
+		surface = s;
+
+		return true;
+	}
+
+	bool SurfacePack::Get(std::string name, Surface &surface)
+	{
+		int index = Find(name);
+		if(index < 0)
+		{
+			SDL_SetError("No surface named %s in the pack", name.c_str());
+			return false;
+		}
+
+		return Get(index, surface);
+	}
+
+	SurfacePackWriter::SurfacePackWriter() : m_Names(), m_Surfaces()
+	{
+	}
+
+	SurfacePackWriter::~SurfacePackWriter()
+	{
+		for(unsigned int i = 0; i < m_Surfaces.size(); i++)
+			SDL_FreeSurface(m_Surfaces[i]);
+	}
+
+	bool SurfacePackWriter::Add(std::string name, Surface &surface)
+	{
+		SDL_Surface *s = *surface;
+		if(s == NULL)
+			throw LogicError("surface not initialized before call to Add()");
+
+		if(name.empty() || name.size() >= PackNameSize)
+		{
+			SDL_SetError("Surface pack names have to be 1 to %u characters", PackNameSize - 1);
+			return false;
+		}
+
+		for(unsigned int i = 0; i < m_Names.size(); i++)
+		{
+			if(m_Names[i] == name)
+			{
+				SDL_SetError("%s is already in the surface pack", name.c_str());
+				return false;
+			}
+		}
+
+		if(s->format->BitsPerPixel != 16 && s->format->BitsPerPixel != 24 &&
+			s->format->BitsPerPixel != 32)
+		{
+			SDL_SetError("Surface packs only hold 16, 24 and 32-bit surfaces");
+			return false;
+		}
+
+		s->refcount++;
+		m_Names.push_back(name);
+		m_Surfaces.push_back(s);
+
+		return true;
+	}
+
+	bool SurfacePackWriter::Save(std::string file, bool compress)
+	{
+		SDL_RWops *out = SDL_RWFromFile(file.c_str(), "wb");
+		if(out == NULL)
+			return false;
+
+		Uint32 count = m_Surfaces.size();
+		Uint32 position = AlignPack(PackHeaderSize + count * PackEntrySize);
+		std::vector<Uint8> index(count * PackEntrySize, 0);
+		std::vector<Uint8> zero(PackAlign, 0);
+		bool ok = true;
+
+		// Leave room for the header and index, they're written last
+		if(SDL_RWseek(out, position, RW_SEEK_SET) < 0)
+			ok = false;
+
+		for(Uint32 i = 0; ok && i < count; i++)
+		{
+			SDL_Surface *s = m_Surfaces[i];
+			Uint32 row = s->w * s->format->BytesPerPixel;
+			Uint32 pitch = AlignPack(row);
+			std::vector<Uint8> pixels(pitch * s->h, 0);
+
+			if(SDL_LockSurface(s) != 0)
+			{
+				ok = false;
+				break;
+			}
+
+			for(int y = 0; y < s->h; y++)
+				memcpy(&pixels[y * pitch], static_cast<Uint8 *>(s->pixels) + y * s->pitch, row);
+
+			SDL_UnlockSurface(s);
+
+			Uint32 flags = 0;
+			std::vector<Uint8> packed;
+			const Uint8 *data = &pixels[0];
+			Uint32 stored = pixels.size();
+
+			if(compress)
+			{
+				packed.resize(LZ4Bound(pixels.size()));
+				size_t size = LZ4Compress(&pixels[0], pixels.size(), &packed[0]);
+
+				if(size < pixels.size())
+				{
+					flags |= PackCompressed;
+					data = &packed[0];
+					stored = size;
+				}
+			}
+
+			if(s->flags & SDL_SRCCOLORKEY)
+				flags |= PackColorKey;
+			if(s->flags & SDL_SRCALPHA)
+				flags |= PackSrcAlpha;
+			flags |= s->format->alpha << 8;
+
+			Uint32 fields[12] = { static_cast<Uint32>(s->w), static_cast<Uint32>(s->h), pitch, s->format->BitsPerPixel,
+				s->format->Rmask, s->format->Gmask, s->format->Bmask, s->format->Amask,
+				flags, s->format->colorkey, position, stored };
+
+			Uint8 *entry = &index[i * PackEntrySize];
+			memcpy(entry, m_Names[i].c_str(), m_Names[i].size());
+			for(int f = 0; f < 12; f++)
+			{
+				Uint8 *field = entry + PackNameSize + f * 4;
+				field[0] = fields[f] & 0xFF;
+				field[1] = (fields[f] >> 8) & 0xFF;
+				field[2] = (fields[f] >> 16) & 0xFF;
+				field[3] = fields[f] >> 24;
+			}
+
+			if(SDL_RWwrite(out, data, stored, 1) != 1)
+			{
+				ok = false;
+				break;
+			}
+
+			// Pad so the next surface starts on a boundary too
+			Uint32 next = AlignPack(position + stored);
+			if(next != position + stored &&
+				SDL_RWwrite(out, &zero[0], next - position - stored, 1) != 1)
+			{
+				ok = false;
+				break;
+			}
+
+			position = next;
+		}
+
+		if(ok)
+		{
+			Uint8 header[PackHeaderSize] = { 0 };
+			memcpy(header, PackMagic, sizeof(PackMagic));
+
+			ok = SDL_RWseek(out, 0, RW_SEEK_SET) == 0 &&
+				SDL_RWwrite(out, header, 8, 1) == 1 &&
+				SDL_WriteLE32(out, PackVersion) && SDL_WriteLE32(out, SDL_BYTEORDER) &&
+				SDL_WriteLE32(out, count) && SDL_WriteLE32(out, PackHeaderSize) &&
+				SDL_RWwrite(out, header + 24, PackHeaderSize - 24, 1) == 1 &&
+				(count == 0 || SDL_RWwrite(out, &index[0], index.size(), 1) == 1);
+		}
+
+		if(!ok)
+			SDL_SetError("Error writing surface pack %s", file.c_str());
+
+		SDL_RWclose(out);
+
+		return ok;
+	}
+
+	int SurfacePackWriter::GetCount()
+	{
+		return m_Surfaces.size();
+	}
+}
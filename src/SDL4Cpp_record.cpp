@@ -0,0 +1,474 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <cstring>
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_record.h"
+#include "SDL4Cpp_time.h"
+
+namespace SDL
+{
+	FrameRecorder::FrameRecorder() : m_Mutex(NULL), m_Ready(NULL), m_Space(NULL),
+		m_Thread(NULL), m_Free(), m_Queue(), m_Depth(0), m_Policy(DropNewest),
+		m_Recording(false), m_Stopping(false), m_Failed(false), m_Path(),
+		m_Format(FormatRaw), m_FPS(30), m_File(NULL), m_Width(0), m_Height(0),
+		m_Row(), m_Planes(), m_Captured(0), m_Dropped(0), m_Encoded(0),
+		m_Latency(0), m_MaxLatency(0), m_TotalLatency(0)
+	{
+		m_Mutex = SDL_CreateMutex();
+		m_Ready = SDL_CreateCond();
+		m_Space = SDL_CreateCond();
+
+		if(m_Mutex == NULL || m_Ready == NULL || m_Space == NULL)
+			throw RuntimeError("Error creating FrameRecorder: " + GetError());
+	}
+
+	FrameRecorder::~FrameRecorder()
+	{
+		if(Screen::GetRecorder() == this)
+			Screen::SetRecorder(NULL);
+
+		Stop();
+
+		SDL_DestroyCond(m_Space);
+		SDL_DestroyCond(m_Ready);
+		SDL_DestroyMutex(m_Mutex);
+	}
+
+	bool FrameRecorder::Start(std::string path, Format format, int fps, int depth,
+		DropPolicy policy)
+	{
+		Stop();
+
+		if(format != FormatPPM)
+		{
+			m_File = fopen(path.c_str(), "wb");
+			if(m_File == NULL)
+			{
+				SDL_SetError("Couldn't open %s for recording", path.c_str());
+				return false;
+			}
+		}
+
+		m_Path = path;
+		m_Format = format;
+		m_FPS = fps > 0 ? fps : 30;
+		m_Depth = depth > 0 ? depth : 1;
+		m_Policy = policy;
+		m_Width = m_Height = 0;
+		m_Captured = m_Dropped = m_Encoded = 0;
+		m_Latency = m_MaxLatency = 0;
+		m_TotalLatency = 0;
+		m_Failed = false;
+		m_Stopping = false;
+
+		// One buffer more than the queue holds, for the frame being written
+		for(int i = 0; i <= m_Depth; i++)
+			m_Free.push_back(new Frame());
+
+		m_Recording = true;
+		m_Thread = SDL_CreateThread(Writer, this);
+		if(m_Thread == NULL)
+		{
+			m_Recording = false;
+			Release();
+			return false;
+		}
+
+		return true;
+	}
+
+	void FrameRecorder::Stop()
+	{
+		if(m_Thread == NULL)
+			return;
+
+		SDL_mutexP(m_Mutex);
+		m_Recording = false;
+		m_Stopping = true;
+		SDL_CondBroadcast(m_Ready);
+		SDL_CondBroadcast(m_Space);
+		SDL_mutexV(m_Mutex);
+
+		// The writer finishes the queue before it quits
+		SDL_WaitThread(m_Thread, NULL);
+		m_Thread = NULL;
+
+		Release();
+	}
+
+	bool FrameRecorder::IsRecording()
+	{
+		MT::Locker lock(m_Mutex);
+
+		return m_Recording;
+	}
+
+	void FrameRecorder::Capture(Surface &frame)
+	{
+		SDL_Surface *surface = *frame;
+		if(surface == NULL)
+			throw LogicError("frame not initialized before call to Capture()");
+
+		Frame *buffer = NULL;
+
+		SDL_mutexP(m_Mutex);
+		if(!m_Recording)
+		{
+			SDL_mutexV(m_Mutex);
+			return;
+		}
+
+		m_Captured++;
+
+		while(buffer == NULL)
+		{
+			if(!m_Free.empty())
+			{
+				buffer = m_Free.back();
+				m_Free.pop_back();
+			}
+			else if(m_Policy == DropOldest && !m_Queue.empty())
+			{
+				buffer = m_Queue.front();
+				m_Queue.pop_front();
+				m_Dropped++;
+			}
+			else if(m_Policy == DropNone && m_Recording)
+				SDL_CondWait(m_Space, m_Mutex);
+			else
+			{
+				m_Dropped++;
+				SDL_mutexV(m_Mutex);
+				return;
+			}
+		}
+		SDL_mutexV(m_Mutex);
+
+		// The buffer is only ours now, so copy without holding the lock
+		int row = surface->w * surface->format->BytesPerPixel;
+		buffer->pixels.resize(row * surface->h);
+		buffer->format = *surface->format;
+		buffer->w = surface->w;
+		buffer->h = surface->h;
+		buffer->pitch = row;
+		buffer->captured = GetMicroTicks();
+
+		buffer->colors.clear();
+		if(surface->format->palette)
+		{
+			Palette *palette = surface->format->palette;
+			buffer->colors.assign(palette->colors, palette->colors + palette->ncolors);
+		}
+
+		bool copied = SDL_LockSurface(surface) == 0;
+		if(copied)
+		{
+			for(int y = 0; y < surface->h; y++)
+				memcpy(&buffer->pixels[y * row], static_cast<Uint8 *>(surface->pixels) +
+					y * surface->pitch, row);
+
+			SDL_UnlockSurface(surface);
+		}
+
+		SDL_mutexP(m_Mutex);
+		if(copied)
+		{
+			m_Queue.push_back(buffer);
+			SDL_CondSignal(m_Ready);
+		}
+		else
+		{
+			m_Free.push_back(buffer);
+			m_Dropped++;
+		}
+		SDL_mutexV(m_Mutex);
+	}
+
+	Uint32 FrameRecorder::GetCaptured()
+	{
+		MT::Locker lock(m_Mutex);
+
+		return m_Captured;
+	}
+
+	Uint32 FrameRecorder::GetDropped()
+	{
+		MT::Locker lock(m_Mutex);
+
+		return m_Dropped;
+	}
+
+	Uint32 FrameRecorder::GetEncoded()
+	{
+		MT::Locker lock(m_Mutex);
+
+		return m_Encoded;
+	}
+
+	int FrameRecorder::GetQueued()
+	{
+		MT::Locker lock(m_Mutex);
+
+		return m_Queue.size();
+	}
+
+	Uint32 FrameRecorder::GetLatency()
+	{
+		MT::Locker lock(m_Mutex);
+
+		return m_Latency;
+	}
+
+	Uint32 FrameRecorder::GetMaxLatency()
+	{
+		MT::Locker lock(m_Mutex);
+
+		return m_MaxLatency;
+	}
+
+	Uint32 FrameRecorder::GetAverageLatency()
+	{
+		MT::Locker lock(m_Mutex);
+
+		if(m_Encoded == 0)
+			return 0;
+
+		return static_cast<Uint32>(m_TotalLatency / m_Encoded);
+	}
+
+	bool FrameRecorder::HasFailed()
+	{
+		MT::Locker lock(m_Mutex);
+
+		return m_Failed;
+	}
+
+	int FrameRecorder::Writer(void *data)
+	{
+		FrameRecorder *recorder = static_cast<FrameRecorder *>(data);
+
+		SDL_mutexP(recorder->m_Mutex);
+		for(;;)
+		{
+			while(recorder->m_Queue.empty() && !recorder->m_Stopping)
+				SDL_CondWait(recorder->m_Ready, recorder->m_Mutex);
+
+			if(recorder->m_Queue.empty())
+				break;
+
+			Frame *frame = recorder->m_Queue.front();
+			recorder->m_Queue.pop_front();
+			bool failed = recorder->m_Failed;
+			SDL_mutexV(recorder->m_Mutex);
+
+			bool written = !failed && recorder->Write(*frame);
+			Uint32 latency = static_cast<Uint32>(GetMicroTicks() - frame->captured);
+
+			SDL_mutexP(recorder->m_Mutex);
+			if(written)
+			{
+				recorder->m_Encoded++;
+				recorder->m_Latency = latency;
+				recorder->m_TotalLatency += latency;
+				if(latency > recorder->m_MaxLatency)
+					recorder->m_MaxLatency = latency;
+			}
+			else
+				recorder->m_Dropped++;
+
+			recorder->m_Free.push_back(frame);
+			SDL_CondSignal(recorder->m_Space);
+		}
+		SDL_mutexV(recorder->m_Mutex);
+
+		return 0;
+	}
+
+	bool FrameRecorder::Write(Frame &frame)
+	{
+		if(m_Width == 0)
+		{
+			m_Width = frame.w;
+			m_Height = frame.h;
+
+			if(m_Format == FormatY4M && fprintf(m_File, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n",
+				m_Width, m_Height, m_FPS) < 0)
+			{
+				MT::Locker lock(m_Mutex);
+				m_Failed = true;
+				return false;
+			}
+		}
+
+		// Raw and Y4M streams can't change size part way through
+		if(m_Format != FormatPPM && (frame.w != m_Width || frame.h != m_Height))
+			return false;
+
+		bool ok = true;
+		m_Row.resize(frame.w * 3);
+
+		if(m_Format == FormatRaw)
+		{
+			for(int y = 0; ok && y < frame.h; y++)
+			{
+				ToRGB(frame, y, &m_Row[0]);
+				ok = fwrite(&m_Row[0], m_Row.size(), 1, m_File) == 1;
+			}
+		}
+		else if(m_Format == FormatPPM)
+		{
+			char number[16];
+			sprintf(number, "%06u.ppm", m_Encoded);
+
+			std::string name = m_Path + number;
+			FILE *file = fopen(name.c_str(), "wb");
+			ok = file != NULL && fprintf(file, "P6\n%d %d\n255\n", frame.w, frame.h) > 0;
+
+			for(int y = 0; ok && y < frame.h; y++)
+			{
+				ToRGB(frame, y, &m_Row[0]);
+				ok = fwrite(&m_Row[0], m_Row.size(), 1, file) == 1;
+			}
+
+			if(file && fclose(file) != 0)
+				ok = false;
+		}
+		else
+		{
+			// BT.601 with the chroma averaged over each 2x2 block
+			int cw = (frame.w + 1) / 2, ch = (frame.h + 1) / 2;
+			m_Planes.resize(frame.w * frame.h + cw * ch * 2);
+			Uint8 *Y = &m_Planes[0], *U = Y + frame.w * frame.h, *V = U + cw * ch;
+			std::vector<int> sums(cw * 3);
+
+			for(int y = 0; y < frame.h; y++)
+			{
+				ToRGB(frame, y, &m_Row[0]);
+
+				if(y % 2 == 0)
+					sums.assign(cw * 3, 0);
+
+				for(int x = 0; x < frame.w; x++)
+				{
+					int r = m_Row[x * 3], g = m_Row[x * 3 + 1], b = m_Row[x * 3 + 2];
+					Y[y * frame.w + x] = static_cast<Uint8>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+					sums[x / 2 * 3] += r;
+					sums[x / 2 * 3 + 1] += g;
+					sums[x / 2 * 3 + 2] += b;
+				}
+
+				if(y % 2 == 1 || y == frame.h - 1)
+				{
+					int rows = y % 2 + 1;
+					for(int x = 0; x < cw; x++)
+					{
+						int count = rows * (x * 2 + 1 < frame.w ? 2 : 1);
+						int r = sums[x * 3] / count, g = sums[x * 3 + 1] / count, b = sums[x * 3 + 2] / count;
+						U[y / 2 * cw + x] = static_cast<Uint8>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+						V[y / 2 * cw + x] = static_cast<Uint8>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+					}
+				}
+			}
+
+			ok = fputs("FRAME\n", m_File) >= 0 &&
+				fwrite(&m_Planes[0], m_Planes.size(), 1, m_File) == 1;
+		}
+
+		if(!ok)
+		{
+			MT::Locker lock(m_Mutex);
+			m_Failed = true;
+		}
+
+		return ok;
+	}
+
+	void FrameRecorder::ToRGB(Frame &frame, int y, Uint8 *rgb)
+	{
+		const Uint8 *src = &frame.pixels[y * frame.pitch];
+		PixelFormat &format = frame.format;
+
+		// The common case, 8 bits per channel
+		if(format.BytesPerPixel == 4 && format.Rloss == 0 && format.Gloss == 0 &&
+			format.Bloss == 0)
+		{
+			const Uint32 *pixels = reinterpret_cast<const Uint32 *>(src);
+			for(int x = 0; x < frame.w; x++)
+			{
+				rgb[x * 3] = static_cast<Uint8>(pixels[x] >> format.Rshift);
+				rgb[x * 3 + 1] = static_cast<Uint8>(pixels[x] >> format.Gshift);
+				rgb[x * 3 + 2] = static_cast<Uint8>(pixels[x] >> format.Bshift);
+			}
+			return;
+		}
+
+		Palette palette;
+		if(!frame.colors.empty())
+		{
+			palette.ncolors = frame.colors.size();
+			palette.colors = &frame.colors[0];
+			format.palette = &palette;
+		}
+
+		for(int x = 0; x < frame.w; x++)
+		{
+			Uint32 pixel;
+			const Uint8 *p = src + x * format.BytesPerPixel;
+
+			switch(format.BytesPerPixel)
+			{
+				case 1:
+					pixel = *p;
+					break;
+				case 2:
+					pixel = *reinterpret_cast<const Uint16 *>(p);
+					break;
+				case 3:
+				#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+					pixel = p[0] | (p[1] << 8) | (p[2] << 16);
+				#else
+					pixel = (p[0] << 16) | (p[1] << 8) | p[2];
+				#endif
+					break;
+				default:
+					pixel = *reinterpret_cast<const Uint32 *>(p);
+					break;
+			}
+
+			SDL_GetRGB(pixel, &format, &rgb[x * 3], &rgb[x * 3 + 1], &rgb[x * 3 + 2]);
+		}
+
+		format.palette = NULL;
+	}
+
+	void FrameRecorder::Release()
+	{
+		for(unsigned int i = 0; i < m_Free.size(); i++)
+			delete m_Free[i];
+		m_Free.clear();
+
+		for(unsigned int i = 0; i < m_Queue.size(); i++)
+			delete m_Queue[i];
+		m_Queue.clear();
+
+		if(m_File)
+		{
+			fclose(m_File);
+			m_File = NULL;
+		}
+	}
+}
@@ -0,0 +1,282 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_render.h"
+#include "SDL4Cpp_time.h"
+#include "SDL4Cpp_blit.h"
+
+namespace SDL
+{
+	RenderQueue::RenderQueue() : m_Recording(0), m_Ready(NULL), m_Thread(NULL),
+		m_Mutex(NULL), m_Work(NULL), m_Done(NULL), m_Submitted(0), m_Completed(0),
+		m_Quit(false), m_Stats(), m_Start(GetMicroTicks())
+	{
+		m_Mutex = SDL_CreateMutex();
+		m_Work = SDL_CreateCond();
+		m_Done = SDL_CreateCond();
+
+		if(m_Mutex != NULL && m_Work != NULL && m_Done != NULL)
+			m_Thread = SDL_CreateThread(Render, this);
+
+		if(m_Thread == NULL)
+		{
+			std::string error = GetError();
+
+			SDL_DestroyCond(m_Done);
+			SDL_DestroyCond(m_Work);
+			SDL_DestroyMutex(m_Mutex);
+			throw RuntimeError("Error creating RenderQueue: " + error);
+		}
+	}
+
+	RenderQueue::~RenderQueue()
+	{
+		Finish();
+
+		SDL_mutexP(m_Mutex);
+		m_Quit = true;
+		SDL_CondSignal(m_Work);
+		SDL_mutexV(m_Mutex);
+
+		SDL_WaitThread(m_Thread, NULL);
+
+		Release(m_Lists[0]);
+		Release(m_Lists[1]);
+
+		SDL_DestroyCond(m_Done);
+		SDL_DestroyCond(m_Work);
+		SDL_DestroyMutex(m_Mutex);
+	}
+
+	void RenderQueue::Add(Type type, SDL_Surface *surface, const SDL_Rect *src,
+						  Sint16 x, Sint16 y, Uint32 color)
+	{
+		CommandList &list = m_Lists[m_Recording];
+		Command command;
+
+		command.type = type;
+		command.surface = surface;
+		command.color = color;
+		command.first = command.count = 0;
+		command.dst.x = x;
+		command.dst.y = y;
+		command.dst.w = command.dst.h = 0;
+
+		if(src)
+			command.src = *src;
+		else if(surface)
+		{
+			command.src.x = command.src.y = 0;
+			command.src.w = surface->w;
+			command.src.h = surface->h;
+		}
+
+		// The list gets its own reference so the surface outlives the
+		// Surface it came from. Only this thread touches refcount.
+		if(surface)
+		{
+			surface->refcount++;
+			list.surfaces.push_back(surface);
+		}
+
+		list.commands.push_back(command);
+	}
+
+	void RenderQueue::Blit(Surface &src, Sint16 x, Sint16 y)
+	{
+		if(src.Get() == NULL)
+			throw LogicError("src not initialized before call to RenderQueue::Blit(Surface, Sint16, Sint16)");
+
+		Add(CommandBlit, src.Get(), NULL, x, y, 0);
+	}
+
+	void RenderQueue::Blit(const Rect &srcrect, Surface &src, Sint16 x, Sint16 y)
+	{
+		if(src.Get() == NULL)
+			throw LogicError("src not initialized before call to RenderQueue::Blit(Rect, Surface, Sint16, Sint16)");
+
+		Add(CommandBlit, src.Get(), &srcrect, x, y, 0);
+	}
+
+	void RenderQueue::Draw(const std::vector<SpriteDraw> &draws)
+	{
+		for(std::vector<SpriteDraw>::const_iterator i = draws.begin(); i != draws.end(); ++i)
+		{
+			// Surface::Get() isn't const, but only the pointer is wanted
+			SDL_Surface *surface = const_cast<Surface *>(i->surface)->Get();
+			if(surface)
+				Add(CommandBlit, surface, &i->src, i->x, i->y, 0);
+		}
+	}
+
+	void RenderQueue::FillRect(const Rect &rect, Uint32 color)
+	{
+		Add(CommandFill, NULL, NULL, rect.x, rect.y, color);
+
+		Command &command = m_Lists[m_Recording].commands.back();
+		command.dst.w = rect.w;
+		command.dst.h = rect.h;
+	}
+
+	void RenderQueue::UpdateRects(int numrects, const Rect *rects)
+	{
+		CommandList &list = m_Lists[m_Recording];
+
+		Add(CommandUpdate, NULL, NULL, 0, 0, 0);
+
+		Command &command = list.commands.back();
+		command.first = list.rects.size();
+		command.count = numrects;
+		list.rects.insert(list.rects.end(), rects, rects + numrects);
+	}
+
+	void RenderQueue::Flip()
+	{
+		Add(CommandFlip, NULL, NULL, 0, 0, 0);
+	}
+
+	Uint32 RenderQueue::Submit()
+	{
+		MT::Locker lock(m_Mutex);
+
+		// Double buffered, so the other list has to be finished before the
+		// render thread can have this one
+		Uint64 start = GetMicroTicks();
+		while(m_Completed != m_Submitted)
+			SDL_CondWait(m_Done, m_Mutex);
+		m_Stats.stalltime += GetMicroTicks() - start;
+
+		CommandList &list = m_Lists[m_Recording];
+		list.fence = ++m_Submitted;
+		m_Stats.commands = list.commands.size();
+		m_Ready = &list;
+		SDL_CondSignal(m_Work);
+
+		// The other list has run, so its surfaces can go
+		m_Recording ^= 1;
+		Release(m_Lists[m_Recording]);
+
+		return list.fence;
+	}
+
+	bool RenderQueue::IsDone(Uint32 fence)
+	{
+		MT::Locker lock(m_Mutex);
+
+		return static_cast<Sint32>(m_Completed - fence) >= 0;
+	}
+
+	void RenderQueue::Wait(Uint32 fence)
+	{
+		MT::Locker lock(m_Mutex);
+
+		while(static_cast<Sint32>(m_Completed - fence) < 0)
+			SDL_CondWait(m_Done, m_Mutex);
+	}
+
+	void RenderQueue::Finish()
+	{
+		MT::Locker lock(m_Mutex);
+
+		while(m_Completed != m_Submitted)
+			SDL_CondWait(m_Done, m_Mutex);
+	}
+
+	RenderStats RenderQueue::GetStats()
+	{
+		MT::Locker lock(m_Mutex);
+		RenderStats stats = m_Stats;
+
+		stats.depth = m_Submitted - m_Completed;
+		stats.elapsed = GetMicroTicks() - m_Start;
+
+		return stats;
+	}
+
+	void RenderQueue::Release(CommandList &list)
+	{
+		for(std::vector<SDL_Surface *>::iterator i = list.surfaces.begin(); i != list.surfaces.end(); ++i)
+			SDL_FreeSurface(*i);
+
+		list.surfaces.clear();
+		list.commands.clear();
+		list.rects.clear();
+	}
+
+	void RenderQueue::Run(CommandList &list)
+	{
+		Screen screen;
+		if(!GetVideoSurface(screen))
+			return;
+
+		SDL_Surface *video = screen.Get();
+
+		for(std::vector<Command>::iterator i = list.commands.begin(); i != list.commands.end(); ++i)
+		{
+			SDL_Rect dst = i->dst;
+
+			switch(i->type)
+			{
+				case CommandBlit:
+					Private::BlitSurface(i->surface, &i->src, video, &dst);
+					break;
+				case CommandFill:
+					SDL_FillRect(video, &dst, i->color);
+					break;
+				case CommandUpdate:
+					if(i->count > 0)
+						screen.UpdateRects(i->count, &list.rects[i->first]);
+					break;
+				case CommandFlip:
+					screen.Flip();
+					break;
+			}
+		}
+	}
+
+	int RenderQueue::Render(void *data)
+	{
+		RenderQueue *queue = static_cast<RenderQueue *>(data);
+
+		SDL_mutexP(queue->m_Mutex);
+		for(;;)
+		{
+			while(queue->m_Ready == NULL && !queue->m_Quit)
+				SDL_CondWait(queue->m_Work, queue->m_Mutex);
+
+			if(queue->m_Ready == NULL)
+				break;
+
+			CommandList *list = queue->m_Ready;
+			queue->m_Ready = NULL;
+			SDL_mutexV(queue->m_Mutex);
+
+			Uint64 start = GetMicroTicks();
+			queue->Run(*list);
+			Uint64 busy = GetMicroTicks() - start;
+
+			SDL_mutexP(queue->m_Mutex);
+			queue->m_Stats.busytime += busy;
+			queue->m_Stats.frames++;
+			queue->m_Completed = list->fence;
+			SDL_CondBroadcast(queue->m_Done);
+		}
+		SDL_mutexV(queue->m_Mutex);
+
+		return 0;
+	}
+}
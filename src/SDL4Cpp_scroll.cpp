@@ -0,0 +1,165 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <cstring>
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_scroll.h"
+#include "SDL4Cpp_blit.h"
+
+namespace SDL
+{
+	int Surface::Scroll(int dx, int dy, Rect exposed[2])
+	{
+		if(m_Surface == NULL)
+			throw LogicError("m_Surface not intialized before call to Scroll(int, int, Rect[])");
+
+		return Scroll(dx, dy, Rect(0, 0, m_Surface->w, m_Surface->h), exposed);
+	}
+
+	int Surface::Scroll(int dx, int dy, const Rect &rect, Rect exposed[2])
+	{
+		if(m_Surface == NULL)
+			throw LogicError("m_Surface not intialized before call to Scroll(int, int, Rect, Rect[])");
+
+		int x = rect.x < 0 ? 0 : rect.x;
+		int y = rect.y < 0 ? 0 : rect.y;
+		int w = (rect.x + rect.w < m_Surface->w ? rect.x + rect.w : m_Surface->w) - x;
+		int h = (rect.y + rect.h < m_Surface->h ? rect.y + rect.h : m_Surface->h) - y;
+
+		if(w <= 0 || h <= 0 || (dx == 0 && dy == 0))
+			return 0;
+
+		// Moved entirely out, nothing is worth copying
+		if(dx <= -w || dx >= w || dy <= -h || dy >= h)
+		{
+			exposed[0] = Rect(x, y, w, h);
+			return 1;
+		}
+
+		int copyw = w - (dx < 0 ? -dx : dx);
+		int copyh = h - (dy < 0 ? -dy : dy);
+		int srcx = dx < 0 ? x - dx : x, dstx = dx < 0 ? x : x + dx;
+		int srcy = dy < 0 ? y - dy : y, dsty = dy < 0 ? y : y + dy;
+		size_t bytes = copyw * m_Surface->format->BytesPerPixel;
+
+		if(!Lock())
+			return -1;
+
+		// Going down, copy from the bottom up so no row is overwritten
+		// before it's moved. memmove takes care of overlap within a row.
+		if(dy > 0)
+		{
+			for(int row = copyh - 1; row >= 0; row--)
+				memmove(Private::PixelAddress(m_Surface, dstx, dsty + row),
+						Private::PixelAddress(m_Surface, srcx, srcy + row), bytes);
+		}
+		else
+		{
+			for(int row = 0; row < copyh; row++)
+				memmove(Private::PixelAddress(m_Surface, dstx, dsty + row),
+						Private::PixelAddress(m_Surface, srcx, srcy + row), bytes);
+		}
+
+		Unlock();
+
+		int count = 0;
+		if(dy > 0)
+			exposed[count++] = Rect(x, y, w, dy);
+		else if(dy < 0)
+			exposed[count++] = Rect(x, y + copyh, w, -dy);
+
+		// The columns, without the rows already exposed
+		if(dx > 0)
+			exposed[count++] = Rect(x, dsty, dx, copyh);
+		else if(dx < 0)
+			exposed[count++] = Rect(x + copyw, dsty, -dx, copyh);
+
+		return count;
+	}
+
+	Scroller::Scroller(Surface &surface, const Rect &view) : m_Surface(&surface),
+		m_View(view), m_X(0), m_Y(0), m_All(true), m_Exposed()
+	{
+	}
+
+	bool Scroller::ScrollTo(Sint32 x, Sint32 y)
+	{
+		bool ok = true;
+
+		m_Exposed.clear();
+
+		// A flipped back buffer holds the frame from two flips ago, so
+		// copying it would scroll stale pixels
+		SDL_Surface *surface = m_Surface->Get();
+		bool flipped = surface && (surface->flags & SDL_DOUBLEBUF) == SDL_DOUBLEBUF;
+
+		if(!m_All && !flipped)
+		{
+			// The playfield moves the opposite way to the view
+			Rect strips[2];
+			int count = m_Surface->Scroll(m_X - x, m_Y - y, m_View, strips);
+
+			if(count < 0)
+				ok = false;
+			else
+				m_Exposed.insert(m_Exposed.end(), strips, strips + count);
+		}
+
+		if(m_All || flipped || !ok)
+			m_Exposed.push_back(m_View);
+
+		m_X = x;
+		m_Y = y;
+		m_All = false;
+
+		return ok;
+	}
+
+	bool Scroller::ScrollBy(int dx, int dy)
+	{
+		return ScrollTo(m_X + dx, m_Y + dy);
+	}
+
+	void Scroller::Invalidate()
+	{
+		m_All = true;
+	}
+
+	const std::vector<Rect> &Scroller::GetExposed() const
+	{
+		return m_Exposed;
+	}
+
+	Sint32 Scroller::GetX() const
+	{
+		return m_X;
+	}
+
+	Sint32 Scroller::GetY() const
+	{
+		return m_Y;
+	}
+
+	Sint32 Scroller::ToWorldX(int x) const
+	{
+		return x - m_View.x + m_X;
+	}
+
+	Sint32 Scroller::ToWorldY(int y) const
+	{
+		return y - m_View.y + m_Y;
+	}
+}
@@ -0,0 +1,341 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <algorithm>
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_sprite.h"
+
+namespace SDL
+{
+	SpriteSheet::SpriteSheet() : m_Surface(), m_Frames()
+	{
+	}
+
+	SpriteSheet::SpriteSheet(Surface &surface) : m_Surface(), m_Frames()
+	{
+		SetSurface(surface);
+	}
+
+	SpriteSheet::~SpriteSheet()
+	{
+	}
+
+	void SpriteSheet::SetSurface(Surface &surface)
+	{
+		SDL_Surface *s = surface.Get();
+		if(s == NULL)
+			throw LogicError("Surface passed to SpriteSheet::SetSurface was empty");
+
+		// The sheet gets its own reference, Surface::operator= drops
+		// whatever it held before
+		s->refcount++;
+		m_Surface = s;
+	}
+
+	const Surface &SpriteSheet::GetSurface() const
+	{
+		return m_Surface;
+	}
+
+	int SpriteSheet::AddFrame(const Rect &rect)
+	{
+		m_Frames.push_back(rect);
+
+		return m_Frames.size() - 1;
+	}
+
+	int SpriteSheet::AddFrames(int w, int h, int count)
+	{
+		const SDL_Surface *s = m_Surface.Get();
+		if(s == NULL || w <= 0 || h <= 0 || w > s->w || h > s->h)
+			return -1;
+
+		int columns = s->w / w;
+		if(count <= 0)
+			count = columns * (s->h / h);
+
+		int first = m_Frames.size();
+		for(int i = 0; i < count && (i / columns + 1) * h <= s->h; i++)
+			m_Frames.push_back(Rect((i % columns) * w, (i / columns) * h, w, h));
+
+		return first;
+	}
+
+	int SpriteSheet::GetFrameCount() const
+	{
+		return m_Frames.size();
+	}
+
+	const Rect &SpriteSheet::GetFrame(int frame) const
+	{
+		return m_Frames[frame];
+	}
+
+	Animation::Animation(const SpriteSheet &sheet, Mode mode) :
+		m_Sheet(&sheet), m_Mode(mode), m_Frames(), m_Ends(), m_Uniform(0)
+	{
+	}
+
+	void Animation::AddFrame(int frame, Uint32 duration)
+	{
+		if(duration == 0)
+			return;
+
+		if(m_Frames.empty())
+			m_Uniform = duration;
+		else if(duration != m_Uniform)
+			m_Uniform = 0;
+
+		m_Frames.push_back(frame);
+		m_Ends.push_back(GetLength() + duration);
+	}
+
+	void Animation::AddFrames(int first, int count, Uint32 duration)
+	{
+		for(int i = 0; i < count; i++)
+			AddFrame(first + i, duration);
+	}
+
+	void Animation::SetMode(Mode mode)
+	{
+		m_Mode = mode;
+	}
+
+	Animation::Mode Animation::GetMode() const
+	{
+		return m_Mode;
+	}
+
+	const SpriteSheet &Animation::GetSheet() const
+	{
+		return *m_Sheet;
+	}
+
+	int Animation::GetFrameCount() const
+	{
+		return m_Frames.size();
+	}
+
+	Uint32 Animation::GetLength() const
+	{
+		return m_Ends.empty() ? 0 : m_Ends.back();
+	}
+
+	int Animation::GetFrameAt(Uint32 time) const
+	{
+		if(m_Frames.empty())
+			return -1;
+
+		size_t index;
+		if(m_Uniform)
+			index = time / m_Uniform;
+		else
+			index = std::upper_bound(m_Ends.begin(), m_Ends.end(), time) - m_Ends.begin();
+
+		if(index >= m_Frames.size())
+			index = m_Frames.size() - 1;
+
+		return m_Frames[index];
+	}
+
+	AnimatedSprite::AnimatedSprite() :
+		m_Animation(NULL), m_Time(0), m_X(0), m_Y(0), m_Speed(256), m_Frame(-1), m_Flags(0)
+	{
+	}
+
+	AnimatedSprite::AnimatedSprite(const Animation &animation, Sint16 x, Sint16 y) :
+		m_Animation(NULL), m_Time(0), m_X(x), m_Y(y), m_Speed(256), m_Frame(-1), m_Flags(0)
+	{
+		Play(animation);
+	}
+
+	void AnimatedSprite::Play(const Animation &animation)
+	{
+		m_Animation = &animation;
+		m_Time = 0;
+		m_Frame = animation.GetFrameAt(0);
+		m_Flags = Playing;
+	}
+
+	void AnimatedSprite::Pause()
+	{
+		m_Flags &= ~Playing;
+	}
+
+	void AnimatedSprite::Resume()
+	{
+		if(m_Animation && !(m_Flags & Finished))
+			m_Flags |= Playing;
+	}
+
+	bool AnimatedSprite::IsPlaying() const
+	{
+		return (m_Flags & Playing) != 0;
+	}
+
+	bool AnimatedSprite::IsFinished() const
+	{
+		return (m_Flags & Finished) != 0;
+	}
+
+	void AnimatedSprite::SetSpeed(double speed)
+	{
+		if(speed < 0)
+			speed = 0;
+		if(speed > 255)
+			speed = 255;
+
+		m_Speed = static_cast<Uint16>(speed * 256 + 0.5);
+	}
+
+	void AnimatedSprite::SetPosition(Sint16 x, Sint16 y)
+	{
+		m_X = x;
+		m_Y = y;
+	}
+
+	Sint16 AnimatedSprite::GetX() const
+	{
+		return m_X;
+	}
+
+	Sint16 AnimatedSprite::GetY() const
+	{
+		return m_Y;
+	}
+
+	void AnimatedSprite::Update(Uint32 ms)
+	{
+		if(!(m_Flags & Playing))
+			return;
+
+		// Scaled by 256 so fractional speeds don't lose time between
+		// updates, which limits animations to about 2.3 hours
+		Uint32 length = m_Animation->GetLength() << 8;
+		if(length == 0)
+			return;
+
+		Uint64 time = m_Time + static_cast<Uint64>(ms) * m_Speed;
+
+		switch(m_Animation->GetMode())
+		{
+			case Animation::Once:
+				if(time >= length)
+				{
+					time = length - 1;
+					m_Flags = Finished;
+				}
+				m_Time = time;
+				break;
+			case Animation::Loop:
+				m_Time = time % length;
+				break;
+			case Animation::PingPong:
+				m_Time = time % (static_cast<Uint64>(length) * 2);
+				break;
+		}
+
+		Uint32 at = m_Time < length ? m_Time : length * 2 - 1 - m_Time;
+		m_Frame = m_Animation->GetFrameAt(at >> 8);
+	}
+
+	int AnimatedSprite::GetFrame() const
+	{
+		return m_Frame;
+	}
+
+	const Animation *AnimatedSprite::GetAnimation() const
+	{
+		return m_Animation;
+	}
+
+	SpriteBatch::SpriteBatch() : m_Sprites(), m_Draws()
+	{
+	}
+
+	int SpriteBatch::Add(const Animation &animation, Sint16 x, Sint16 y)
+	{
+		m_Sprites.push_back(AnimatedSprite(animation, x, y));
+
+		return m_Sprites.size() - 1;
+	}
+
+	void SpriteBatch::Remove(int index)
+	{
+		m_Sprites[index] = m_Sprites.back();
+		m_Sprites.pop_back();
+	}
+
+	void SpriteBatch::Clear()
+	{
+		m_Sprites.clear();
+	}
+
+	int SpriteBatch::GetCount() const
+	{
+		return m_Sprites.size();
+	}
+
+	AnimatedSprite &SpriteBatch::operator [](int index)
+	{
+		return m_Sprites[index];
+	}
+
+	void SpriteBatch::Update(Uint32 ms)
+	{
+		for(std::vector<AnimatedSprite>::iterator i = m_Sprites.begin(); i != m_Sprites.end(); ++i)
+			i->Update(ms);
+	}
+
+	const std::vector<SpriteDraw> &SpriteBatch::GetDraws()
+	{
+		m_Draws.clear();
+
+		for(std::vector<AnimatedSprite>::const_iterator i = m_Sprites.begin(); i != m_Sprites.end(); ++i)
+		{
+			int frame = i->GetFrame();
+			if(frame < 0)
+				continue;
+
+			const SpriteSheet &sheet = i->GetAnimation()->GetSheet();
+			SpriteDraw draw;
+			draw.surface = &sheet.GetSurface();
+			draw.src = sheet.GetFrame(frame);
+			draw.x = i->GetX();
+			draw.y = i->GetY();
+			m_Draws.push_back(draw);
+		}
+
+		return m_Draws;
+	}
+
+	bool SpriteBatch::Draw(Surface &dst)
+	{
+		const std::vector<SpriteDraw> &draws = GetDraws();
+		bool ok = true;
+
+		for(std::vector<SpriteDraw>::const_iterator i = draws.begin(); i != draws.end(); ++i)
+		{
+			Rect src(i->src);
+			Rect dest(i->x, i->y, 0, 0);
+
+			if(!dst.Blit(src, *i->surface, dest))
+				ok = false;
+		}
+
+		return ok;
+	}
+}
@@ -0,0 +1,528 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <cstdio>
+#include <cstring>
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_texture.h"
+#include "SDL4Cpp_blit.h"
+#include "SDL_opengl.h"
+
+namespace SDL
+{
+	namespace GL
+	{
+		typedef void (APIENTRY *GenTexturesProc)(GLsizei, GLuint *);
+		typedef void (APIENTRY *DeleteTexturesProc)(GLsizei, const GLuint *);
+		typedef void (APIENTRY *BindTextureProc)(GLenum, GLuint);
+		typedef void (APIENTRY *TexImage2DProc)(GLenum, GLint, GLint, GLsizei, GLsizei, GLint,
+												GLenum, GLenum, const GLvoid *);
+		typedef void (APIENTRY *TexSubImage2DProc)(GLenum, GLint, GLint, GLint, GLsizei, GLsizei,
+												   GLenum, GLenum, const GLvoid *);
+		typedef void (APIENTRY *TexParameteriProc)(GLenum, GLenum, GLint);
+		typedef void (APIENTRY *PixelStoreiProc)(GLenum, GLint);
+		typedef void (APIENTRY *GetIntegervProc)(GLenum, GLint *);
+		typedef const GLubyte *(APIENTRY *GetStringProc)(GLenum);
+
+		/*!
+		 * \brief Private SDL4Cpp_texture structure
+		 *
+		 * The GL functions Texture uses, and what the context can do.
+		 */
+		struct Functions
+		{
+			/*! GL::GetContext() they were looked up for */
+			Uint32 context;
+			bool loaded;
+
+			GenTexturesProc GenTextures;
+			DeleteTexturesProc DeleteTextures;
+			BindTextureProc BindTexture;
+			TexImage2DProc TexImage2D;
+			TexSubImage2DProc TexSubImage2D;
+			TexParameteriProc TexParameteri;
+			PixelStoreiProc PixelStorei;
+			GetIntegervProc GetIntegerv;
+			GetStringProc GetString;
+
+			/*! GL 1.2 packed pixel types, GL_BGR(A) and GL_CLAMP_TO_EDGE */
+			bool packed;
+			/*! Sizes that aren't powers of two */
+			bool npot;
+			GLint maxsize;
+		};
+
+		/*!
+		 * \brief Private SDL4Cpp_texture variable
+		 */
+		static Functions s_GL;
+
+		/*!
+		 * \brief Private SDL4Cpp_texture structure
+		 *
+		 * A surface layout GL can read as it is.
+		 */
+		struct Layout
+		{
+			Uint8 bpp;
+			Uint32 Rmask, Gmask, Bmask, Amask;
+			GLenum format, type;
+			/*! Used with Amask, or for the pad bits without one */
+			GLint internal, opaque;
+			/*! Needs Functions::packed */
+			bool packed;
+		};
+
+		/*!
+		 * \brief Private SDL4Cpp_texture variable
+		 *
+		 * Masks are of the pixel as a number, so packed types cover both
+		 * byte orders. 24-bit layouts are in memory order.
+		 */
+		static const Layout s_Layouts[] =
+		{
+		#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+			{ 32, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000, GL_RGBA, GL_UNSIGNED_BYTE, GL_RGBA8, GL_RGB8, false },
+			{ 24, 0x000000FF, 0x0000FF00, 0x00FF0000, 0, GL_RGB, GL_UNSIGNED_BYTE, GL_RGB8, GL_RGB8, false },
+			{ 24, 0x00FF0000, 0x0000FF00, 0x000000FF, 0, GL_BGR, GL_UNSIGNED_BYTE, GL_RGB8, GL_RGB8, true },
+		#else
+			{ 32, 0xFF000000, 0x00FF0000, 0x0000FF00, 0x000000FF, GL_RGBA, GL_UNSIGNED_BYTE, GL_RGBA8, GL_RGB8, false },
+			{ 24, 0x00FF0000, 0x0000FF00, 0x000000FF, 0, GL_RGB, GL_UNSIGNED_BYTE, GL_RGB8, GL_RGB8, false },
+			{ 24, 0x000000FF, 0x0000FF00, 0x00FF0000, 0, GL_BGR, GL_UNSIGNED_BYTE, GL_RGB8, GL_RGB8, true },
+		#endif
+			{ 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, GL_RGBA8, GL_RGB8, true },
+			{ 32, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, GL_RGBA8, GL_RGB8, true },
+			{ 32, 0xFF000000, 0x00FF0000, 0x0000FF00, 0x000000FF, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, GL_RGBA8, GL_RGB8, true },
+			{ 32, 0x0000FF00, 0x00FF0000, 0xFF000000, 0x000000FF, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8, GL_RGBA8, GL_RGB8, true },
+			{ 16, 0xF800, 0x07E0, 0x001F, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, GL_RGB5, GL_RGB5, true },
+			{ 16, 0x7C00, 0x03E0, 0x001F, 0x8000, GL_BGRA, GL_UNSIGNED_SHORT_1_5_5_5_REV, GL_RGB5_A1, GL_RGB5, true },
+			{ 16, 0x0F00, 0x00F0, 0x000F, 0xF000, GL_BGRA, GL_UNSIGNED_SHORT_4_4_4_4_REV, GL_RGBA4, GL_RGB4, true }
+		};
+
+		/*!
+		 * \brief Private SDL4Cpp_texture function
+		 *
+		 * \return True if name is a whole word of the extensions string.
+		 */
+		static bool HasExtension(const char *extensions, const char *name)
+		{
+			if(extensions == NULL)
+				return false;
+
+			size_t length = strlen(name);
+			for(const char *p = strstr(extensions, name); p; p = strstr(p + length, name))
+			{
+				if((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0'))
+					return true;
+			}
+
+			return false;
+		}
+
+		/*!
+		 * \brief Private SDL4Cpp_texture function
+		 *
+		 * Look up s_GL for the current context, once per context.
+		 *
+		 * \throws SDL::LogicError if no Screen has been set.
+		 */
+		static bool LoadFunctions()
+		{
+			if(s_GL.loaded && s_GL.context == GetContext())
+				return true;
+
+			s_GL.loaded = false;
+			s_GL.GenTextures = GetProc<GenTexturesProc>("glGenTextures");
+			s_GL.DeleteTextures = GetProc<DeleteTexturesProc>("glDeleteTextures");
+			s_GL.BindTexture = GetProc<BindTextureProc>("glBindTexture");
+			s_GL.TexImage2D = GetProc<TexImage2DProc>("glTexImage2D");
+			s_GL.TexSubImage2D = GetProc<TexSubImage2DProc>("glTexSubImage2D");
+			s_GL.TexParameteri = GetProc<TexParameteriProc>("glTexParameteri");
+			s_GL.PixelStorei = GetProc<PixelStoreiProc>("glPixelStorei");
+			s_GL.GetIntegerv = GetProc<GetIntegervProc>("glGetIntegerv");
+			s_GL.GetString = GetProc<GetStringProc>("glGetString");
+
+			if(!s_GL.GenTextures || !s_GL.DeleteTextures || !s_GL.BindTexture || !s_GL.TexImage2D ||
+			   !s_GL.TexSubImage2D || !s_GL.TexParameteri || !s_GL.PixelStorei || !s_GL.GetIntegerv ||
+			   !s_GL.GetString)
+			{
+				SDL_SetError("Couldn't find the GL texture functions");
+				return false;
+			}
+
+			int major = 1, minor = 0;
+			const char *version = reinterpret_cast<const char *>(s_GL.GetString(GL_VERSION));
+			if(version)
+				sscanf(version, "%d.%d", &major, &minor);
+			const char *extensions = reinterpret_cast<const char *>(s_GL.GetString(GL_EXTENSIONS));
+
+			s_GL.packed = major > 1 || minor >= 2 ||
+				(HasExtension(extensions, "GL_EXT_bgra") && HasExtension(extensions, "GL_EXT_packed_pixels"));
+			s_GL.npot = major >= 2 || HasExtension(extensions, "GL_ARB_texture_non_power_of_two");
+
+			s_GL.maxsize = 64;
+			s_GL.GetIntegerv(GL_MAX_TEXTURE_SIZE, &s_GL.maxsize);
+
+			s_GL.context = GetContext();
+			s_GL.loaded = true;
+
+			return true;
+		}
+
+		/*!
+		 * \brief Private SDL4Cpp_texture function
+		 */
+		static int PowerOfTwo(int size)
+		{
+			int power = 1;
+			while(power < size)
+				power <<= 1;
+
+			return power;
+		}
+
+		Texture::Texture() :
+			m_Names(), m_Pending(), m_Current(0), m_Context(0), m_Width(0), m_Height(0),
+			m_TextureWidth(0), m_TextureHeight(0), m_Bpp(0), m_Rmask(0), m_Gmask(0), m_Bmask(0),
+			m_Amask(0), m_Format(0), m_Type(0), m_Convert(false), m_Buffer()
+		{
+		}
+
+		Texture::~Texture()
+		{
+			Free();
+		}
+
+		void Texture::Free()
+		{
+			// Textures of an old context went with it
+			if(!m_Names.empty() && m_Context == GetContext() && s_GL.loaded && s_GL.context == m_Context)
+				s_GL.DeleteTextures(m_Names.size(), reinterpret_cast<const GLuint *>(&m_Names[0]));
+
+			m_Names.clear();
+			m_Pending.clear();
+			m_Current = 0;
+			m_Width = m_Height = 0;
+		}
+
+		bool Texture::Matches(const SDL_Surface *s) const
+		{
+			return s->w == m_Width && s->h == m_Height && s->format->BitsPerPixel == m_Bpp &&
+				s->format->Rmask == m_Rmask && s->format->Gmask == m_Gmask &&
+				s->format->Bmask == m_Bmask && s->format->Amask == m_Amask;
+		}
+
+		bool Texture::FromSurface(Surface &surface, int buffers)
+		{
+			SDL_Surface *s = surface.Get();
+			if(s == NULL)
+				throw LogicError("surface not initialized before call to GL::Texture::FromSurface(Surface, int)");
+
+			if(!LoadFunctions())
+				return false;
+
+			Free();
+
+			// Find a format and type that reads the pixels as they are
+			const SDL_PixelFormat *format = s->format;
+			const Layout *layout = NULL;
+			for(unsigned int i = 0; i < sizeof(s_Layouts) / sizeof(s_Layouts[0]) && !layout; i++)
+			{
+				const Layout &l = s_Layouts[i];
+				if(l.bpp == format->BitsPerPixel && l.Rmask == format->Rmask &&
+				   l.Gmask == format->Gmask && l.Bmask == format->Bmask &&
+				   (format->Amask == 0 || format->Amask == l.Amask) && (!l.packed || s_GL.packed))
+					layout = &l;
+			}
+
+			GLint internal;
+			m_Convert = layout == NULL;
+			if(m_Convert)
+			{
+				m_Format = GL_RGBA;
+				m_Type = GL_UNSIGNED_BYTE;
+				internal = GL_RGBA8;
+			}
+			else
+			{
+				m_Format = layout->format;
+				m_Type = layout->type;
+				internal = format->Amask ? layout->internal : layout->opaque;
+			}
+
+			int w = s_GL.npot ? s->w : PowerOfTwo(s->w);
+			int h = s_GL.npot ? s->h : PowerOfTwo(s->h);
+			if(w > s_GL.maxsize || h > s_GL.maxsize)
+			{
+				SDL_SetError("Surface is bigger than the largest GL texture");
+				return false;
+			}
+
+			if(!surface.Lock())
+				return false;
+
+			if(buffers < 1)
+				buffers = 1;
+			m_Names.resize(buffers);
+			s_GL.GenTextures(buffers, reinterpret_cast<GLuint *>(&m_Names[0]));
+			m_Pending.assign(buffers, std::vector<SDL_Rect>());
+			m_Current = 0;
+			m_Context = GetContext();
+
+			m_Width = s->w;
+			m_Height = s->h;
+			m_TextureWidth = w;
+			m_TextureHeight = h;
+			m_Bpp = format->BitsPerPixel;
+			m_Rmask = format->Rmask;
+			m_Gmask = format->Gmask;
+			m_Bmask = format->Bmask;
+			m_Amask = format->Amask;
+
+			GLint clamp = s_GL.packed ? GL_CLAMP_TO_EDGE : GL_CLAMP;
+			SDL_Rect all = { 0, 0, static_cast<Uint16>(s->w), static_cast<Uint16>(s->h) };
+			for(int i = 0; i < buffers; i++)
+			{
+				s_GL.BindTexture(GL_TEXTURE_2D, m_Names[i]);
+				s_GL.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+				s_GL.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+				s_GL.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, clamp);
+				s_GL.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, clamp);
+				s_GL.TexImage2D(GL_TEXTURE_2D, 0, internal, w, h, 0, m_Format, m_Type, NULL);
+				Upload(s, i, all);
+			}
+
+			surface.Unlock();
+
+			return true;
+		}
+
+		bool Texture::Update(Surface &surface)
+		{
+			if(surface.Get() == NULL)
+				throw LogicError("surface not initialized before call to GL::Texture::Update(Surface)");
+
+			Rect all(0, 0, static_cast<Uint16>(surface.Get()->w), static_cast<Uint16>(surface.Get()->h));
+			return Update(surface, 1, &all);
+		}
+
+		bool Texture::Update(Surface &surface, const Rect &rect)
+		{
+			return Update(surface, 1, &rect);
+		}
+
+		bool Texture::Update(Surface &surface, int numrects, const Rect *rects)
+		{
+			SDL_Surface *s = surface.Get();
+			if(s == NULL)
+				throw LogicError("surface not initialized before call to GL::Texture::Update(Surface, int, Rect)");
+
+			if(m_Names.empty() || m_Context != GetContext() || !Matches(s))
+			{
+				int buffers = m_Names.empty() ? 1 : m_Names.size();
+				return FromSurface(surface, buffers);
+			}
+
+			if(!LoadFunctions())
+				return false;
+
+			std::vector<SDL_Rect> changed;
+			for(int i = 0; i < numrects; i++)
+			{
+				int x1 = rects[i].x < 0 ? 0 : rects[i].x;
+				int y1 = rects[i].y < 0 ? 0 : rects[i].y;
+				int x2 = rects[i].x + rects[i].w < s->w ? rects[i].x + rects[i].w : s->w;
+				int y2 = rects[i].y + rects[i].h < s->h ? rects[i].y + rects[i].h : s->h;
+				if(x2 > x1 && y2 > y1)
+				{
+					SDL_Rect r = { static_cast<Sint16>(x1), static_cast<Sint16>(y1),
+								   static_cast<Uint16>(x2 - x1), static_cast<Uint16>(y2 - y1) };
+					changed.push_back(r);
+				}
+			}
+
+			if(!surface.Lock())
+				return false;
+
+			int buffers = m_Names.size();
+			int next = (m_Current + 1) % buffers;
+
+			// The next buffer gets what it missed and what changed now, the
+			// others remember what changed for when it's their turn
+			std::vector<SDL_Rect> send;
+			send.swap(m_Pending[next]);
+			send.insert(send.end(), changed.begin(), changed.end());
+
+			for(int i = 0; i < buffers; i++)
+			{
+				if(i == next || changed.empty())
+					continue;
+
+				std::vector<SDL_Rect> &pending = m_Pending[i];
+				pending.insert(pending.end(), changed.begin(), changed.end());
+
+				// Too many to be worth sending one by one, so send their
+				// bounding box
+				if(pending.size() > 16)
+				{
+					int x1 = pending[0].x, y1 = pending[0].y;
+					int x2 = x1 + pending[0].w, y2 = y1 + pending[0].h;
+					for(unsigned int j = 1; j < pending.size(); j++)
+					{
+						x1 = pending[j].x < x1 ? pending[j].x : x1;
+						y1 = pending[j].y < y1 ? pending[j].y : y1;
+						x2 = pending[j].x + pending[j].w > x2 ? pending[j].x + pending[j].w : x2;
+						y2 = pending[j].y + pending[j].h > y2 ? pending[j].y + pending[j].h : y2;
+					}
+					SDL_Rect box = { static_cast<Sint16>(x1), static_cast<Sint16>(y1),
+									 static_cast<Uint16>(x2 - x1), static_cast<Uint16>(y2 - y1) };
+					pending.assign(1, box);
+				}
+			}
+
+			for(unsigned int i = 0; i < send.size(); i++)
+				Upload(s, next, send[i]);
+
+			surface.Unlock();
+			m_Current = next;
+
+			return true;
+		}
+
+		void Texture::Upload(SDL_Surface *s, int buffer, const SDL_Rect &rect)
+		{
+			s_GL.BindTexture(GL_TEXTURE_2D, m_Names[buffer]);
+			Send(s, rect, rect.x, rect.y);
+
+			// GL_LINEAR reads a texel past the edge, so a padded texture
+			// gets the last column and row again instead of undefined texels
+			bool right = m_TextureWidth > s->w && rect.x + rect.w == s->w;
+			bool bottom = m_TextureHeight > s->h && rect.y + rect.h == s->h;
+			if(right)
+			{
+				SDL_Rect column = { static_cast<Sint16>(s->w - 1), rect.y, 1, rect.h };
+				Send(s, column, s->w, rect.y);
+			}
+			if(bottom)
+			{
+				SDL_Rect row = { rect.x, static_cast<Sint16>(s->h - 1), rect.w, 1 };
+				Send(s, row, rect.x, s->h);
+			}
+			if(right && bottom)
+			{
+				SDL_Rect corner = { static_cast<Sint16>(s->w - 1), static_cast<Sint16>(s->h - 1), 1, 1 };
+				Send(s, corner, s->w, s->h);
+			}
+		}
+
+		void Texture::Send(SDL_Surface *s, const SDL_Rect &rect, int x, int y)
+		{
+			if(m_Convert)
+			{
+				// Turn whatever the surface is into RGBA bytes
+				m_Buffer.resize(rect.w * rect.h * 4);
+				Uint8 *out = &m_Buffer[0];
+				int bpp = s->format->BytesPerPixel;
+				for(int row = rect.y; row < rect.y + rect.h; row++)
+				{
+					const Uint8 *p = Private::PixelAddress(s, rect.x, row);
+					for(int i = 0; i < rect.w; i++, p += bpp, out += 4)
+						SDL_GetRGBA(Private::ReadPixel(p, bpp), s->format, &out[0], &out[1], &out[2], &out[3]);
+				}
+
+				s_GL.TexSubImage2D(GL_TEXTURE_2D, 0, x, y, rect.w, rect.h, m_Format, m_Type, &m_Buffer[0]);
+				return;
+			}
+
+			// Let GL step over the pitch and skip to rect by itself
+			int bpp = s->format->BytesPerPixel;
+			if(s->pitch % bpp == 0)
+			{
+				s_GL.PixelStorei(GL_UNPACK_ALIGNMENT, 1);
+				s_GL.PixelStorei(GL_UNPACK_ROW_LENGTH, s->pitch / bpp);
+			}
+			else
+			{
+				// 24-bit rows padded to 4 bytes, as SDL makes them
+				s_GL.PixelStorei(GL_UNPACK_ALIGNMENT, 4);
+				s_GL.PixelStorei(GL_UNPACK_ROW_LENGTH, s->w);
+			}
+
+			if(s->pitch % bpp == 0 || s->pitch == ((s->w * bpp + 3) & ~3))
+			{
+				s_GL.PixelStorei(GL_UNPACK_SKIP_PIXELS, rect.x);
+				s_GL.PixelStorei(GL_UNPACK_SKIP_ROWS, rect.y);
+				s_GL.TexSubImage2D(GL_TEXTURE_2D, 0, x, y, rect.w, rect.h, m_Format, m_Type, s->pixels);
+			}
+			else
+			{
+				// Some other pitch, so a row at a time
+				s_GL.PixelStorei(GL_UNPACK_ALIGNMENT, 1);
+				s_GL.PixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+				for(int row = 0; row < rect.h; row++)
+					s_GL.TexSubImage2D(GL_TEXTURE_2D, 0, x, y + row, rect.w, 1, m_Format, m_Type,
+									   Private::PixelAddress(s, rect.x, rect.y + row));
+			}
+
+			s_GL.PixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+			s_GL.PixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+			s_GL.PixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+			s_GL.PixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		}
+
+		void Texture::Bind()
+		{
+			if(m_Names.empty() || m_Context != GetContext() || !LoadFunctions())
+				return;
+
+			s_GL.BindTexture(GL_TEXTURE_2D, m_Names[m_Current]);
+		}
+
+		Uint32 Texture::GetName() const
+		{
+			if(m_Names.empty())
+				return 0;
+
+			return m_Names[m_Current];
+		}
+
+		int Texture::GetWidth() const
+		{
+			return m_Width;
+		}
+
+		int Texture::GetHeight() const
+		{
+			return m_Height;
+		}
+
+		float Texture::GetMaxU() const
+		{
+			if(m_TextureWidth == 0)
+				return 0.0f;
+
+			return static_cast<float>(m_Width) / m_TextureWidth;
+		}
+
+		float Texture::GetMaxV() const
+		{
+			if(m_TextureHeight == 0)
+				return 0.0f;
+
+			return static_cast<float>(m_Height) / m_TextureHeight;
+		}
+	}
+}
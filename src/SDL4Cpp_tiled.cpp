@@ -0,0 +1,476 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <cstring>
+#include <algorithm>
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_tiled.h"
+#include "SDL4Cpp_blit.h"
+
+namespace SDL
+{
+	/*!
+	 * \brief Private SDL4Cpp_tiled variable
+	 *
+	 * The bits of 0 to 31 spread out to the even bits, for Morton order.
+	 */
+	static const Uint16 s_Spread[32] =
+	{
+		0x000, 0x001, 0x004, 0x005, 0x010, 0x011, 0x014, 0x015,
+		0x040, 0x041, 0x044, 0x045, 0x050, 0x051, 0x054, 0x055,
+		0x100, 0x101, 0x104, 0x105, 0x110, 0x111, 0x114, 0x115,
+		0x140, 0x141, 0x144, 0x145, 0x150, 0x151, 0x154, 0x155
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_tiled variable
+	 *
+	 * Size of the blocks Convolve() works on, a multiple of every tile
+	 * size.
+	 */
+	static const int s_Block = 64;
+
+	/*!
+	 * \brief Private SDL4Cpp_tiled function
+	 */
+	static inline int Clamp(int value, int low, int high)
+	{
+		return value < low ? low : (value > high ? high : value);
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_tiled function
+	 *
+	 * Kernel's fixed point weights, padded with a 0 to an even length for
+	 * Private::VerticalRow() and Private::HorizontalRow().
+	 */
+	static std::vector<Sint16> Pad(const Kernel &kernel)
+	{
+		std::vector<Sint16> weights(kernel.GetFixed());
+		weights.push_back(0);
+
+		return weights;
+	}
+
+	TiledSurface::TiledSurface(TileLayout layout) :
+		m_Layout(layout), m_Shift(layout == TileLayout8x8 ? 3 : (layout == TileLayout16x16 ? 4 : 5)),
+		m_Width(0), m_Height(0), m_Across(0), m_Pixels(),
+		m_Rmask(0), m_Gmask(0), m_Bmask(0), m_Amask(0),
+		m_Flags(0), m_ColorKey(0), m_Alpha(SDL_ALPHA_OPAQUE)
+	{
+	}
+
+	TiledSurface::~TiledSurface()
+	{
+	}
+
+	void TiledSurface::Create(int width, int height, Uint32 Rmask, Uint32 Gmask,
+							  Uint32 Bmask, Uint32 Amask)
+	{
+		int size = 1 << m_Shift;
+		m_Width = width > 0 ? width : 0;
+		m_Height = height > 0 ? height : 0;
+		m_Across = (m_Width + size - 1) >> m_Shift;
+		int down = (m_Height + size - 1) >> m_Shift;
+
+		m_Pixels.assign(static_cast<size_t>(m_Across) * down << (m_Shift * 2), 0);
+		m_Rmask = Rmask;
+		m_Gmask = Gmask;
+		m_Bmask = Bmask;
+		m_Amask = Amask;
+		m_Flags = 0;
+		m_ColorKey = 0;
+		m_Alpha = SDL_ALPHA_OPAQUE;
+	}
+
+	void TiledSurface::Free()
+	{
+		std::vector<Uint32>().swap(m_Pixels);
+		m_Width = m_Height = m_Across = 0;
+	}
+
+	inline size_t TiledSurface::Index(int x, int y) const
+	{
+		size_t tile = static_cast<size_t>(y >> m_Shift) * m_Across + (x >> m_Shift);
+		int mask = (1 << m_Shift) - 1;
+		size_t inside;
+		if(m_Layout == TileLayoutMorton)
+			inside = s_Spread[x & mask] | (s_Spread[y & mask] << 1);
+		else
+			inside = ((y & mask) << m_Shift) | (x & mask);
+
+		return (tile << (m_Shift * 2)) + inside;
+	}
+
+	void TiledSurface::ReadRow(const Uint32 *pixels, int x, int y, int n, Uint32 *out) const
+	{
+		if(m_Layout == TileLayoutMorton)
+		{
+			for(int i = 0; i < n; i++)
+				out[i] = pixels[Index(x + i, y)];
+			return;
+		}
+
+		// Rows are in order inside a tile, so copy a tile width at a time
+		int size = 1 << m_Shift;
+		while(n > 0)
+		{
+			int run = size - (x & (size - 1));
+			if(run > n)
+				run = n;
+
+			memcpy(out, pixels + Index(x, y), run * sizeof(Uint32));
+			out += run;
+			x += run;
+			n -= run;
+		}
+	}
+
+	void TiledSurface::WriteRow(Uint32 *pixels, int x, int y, int n, const Uint32 *in) const
+	{
+		if(m_Layout == TileLayoutMorton)
+		{
+			for(int i = 0; i < n; i++)
+				pixels[Index(x + i, y)] = in[i];
+			return;
+		}
+
+		int size = 1 << m_Shift;
+		while(n > 0)
+		{
+			int run = size - (x & (size - 1));
+			if(run > n)
+				run = n;
+
+			memcpy(pixels + Index(x, y), in, run * sizeof(Uint32));
+			in += run;
+			x += run;
+			n -= run;
+		}
+	}
+
+	void TiledSurface::Swap(TiledSurface &other)
+	{
+		std::swap(m_Layout, other.m_Layout);
+		std::swap(m_Shift, other.m_Shift);
+		std::swap(m_Width, other.m_Width);
+		std::swap(m_Height, other.m_Height);
+		std::swap(m_Across, other.m_Across);
+		m_Pixels.swap(other.m_Pixels);
+		std::swap(m_Rmask, other.m_Rmask);
+		std::swap(m_Gmask, other.m_Gmask);
+		std::swap(m_Bmask, other.m_Bmask);
+		std::swap(m_Amask, other.m_Amask);
+		std::swap(m_Flags, other.m_Flags);
+		std::swap(m_ColorKey, other.m_ColorKey);
+		std::swap(m_Alpha, other.m_Alpha);
+	}
+
+	bool TiledSurface::Load(Surface &src)
+	{
+		SDL_Surface *s = src.Get();
+		if(s == NULL)
+			throw LogicError("src not initialized before call to TiledSurface::Load(Surface)");
+
+		if(s->format->BytesPerPixel != 4)
+		{
+			SDL_SetError("Only 32-bit surfaces can be tiled");
+			return false;
+		}
+
+		if(!src.Lock())
+			return false;
+
+		Create(s->w, s->h, s->format->Rmask, s->format->Gmask, s->format->Bmask, s->format->Amask);
+		for(int y = 0; y < m_Height; y++)
+			WriteRow(&m_Pixels[0], 0, y, m_Width, reinterpret_cast<const Uint32 *>(Private::PixelAddress(s, 0, y)));
+
+		src.Unlock();
+
+		m_Flags = s->flags & (SDL_SRCCOLORKEY | SDL_SRCALPHA | PREMULTIPLIED);
+		m_ColorKey = s->format->colorkey;
+		m_Alpha = s->format->alpha;
+
+		return true;
+	}
+
+	bool TiledSurface::Store(Surface &dst) const
+	{
+		if(m_Pixels.empty())
+			throw LogicError("TiledSurface not initialized before call to TiledSurface::Store(Surface)");
+
+		SDL_Surface *d = dst.Get();
+		if(d == NULL || d->w != m_Width || d->h != m_Height || d->format->BytesPerPixel != 4 ||
+		   d->format->Rmask != m_Rmask || d->format->Gmask != m_Gmask ||
+		   d->format->Bmask != m_Bmask || d->format->Amask != m_Amask)
+		{
+			if(!dst.CreateRGB(SDL_SWSURFACE, m_Width, m_Height, 32, m_Rmask, m_Gmask, m_Bmask, m_Amask))
+				return false;
+			d = dst.Get();
+		}
+
+		if(!dst.Lock())
+			return false;
+
+		for(int y = 0; y < m_Height; y++)
+			ReadRow(&m_Pixels[0], 0, y, m_Width, reinterpret_cast<Uint32 *>(Private::PixelAddress(d, 0, y)));
+
+		dst.Unlock();
+
+		SDL_SetColorKey(d, m_Flags & SDL_SRCCOLORKEY, m_ColorKey);
+		SDL_SetAlpha(d, m_Flags & SDL_SRCALPHA, m_Alpha);
+		d->flags = (d->flags & ~PREMULTIPLIED) | (m_Flags & PREMULTIPLIED);
+
+		return true;
+	}
+
+	bool TiledSurface::Blit(Surface &dst, Sint16 x, Sint16 y) const
+	{
+		if(m_Pixels.empty())
+			throw LogicError("TiledSurface not initialized before call to TiledSurface::Blit(Surface, Sint16, Sint16)");
+		if(dst.Get() == NULL)
+			throw LogicError("dst not initialized before call to TiledSurface::Blit(Surface, Sint16, Sint16)");
+
+		// One band of tiles at a time, with the same colorkey and alpha
+		int rows = 1 << m_Shift;
+		SDL_Surface *strip = SDL_CreateRGBSurface(SDL_SWSURFACE, m_Width, rows, 32, m_Rmask,
+												  m_Gmask, m_Bmask, m_Amask);
+		if(strip == NULL)
+			return false;
+
+		SDL_SetColorKey(strip, m_Flags & SDL_SRCCOLORKEY, m_ColorKey);
+		SDL_SetAlpha(strip, m_Flags & SDL_SRCALPHA, m_Alpha);
+		strip->flags |= m_Flags & PREMULTIPLIED;
+
+		bool ok = true;
+		for(int row = 0; row < m_Height && ok; row += rows)
+		{
+			int n = m_Height - row < rows ? m_Height - row : rows;
+			for(int i = 0; i < n; i++)
+				ReadRow(&m_Pixels[0], 0, row + i, m_Width, reinterpret_cast<Uint32 *>(Private::PixelAddress(strip, 0, i)));
+
+			SDL_Rect part = { 0, 0, static_cast<Uint16>(m_Width), static_cast<Uint16>(n) };
+			SDL_Rect to = { static_cast<Sint16>(x), static_cast<Sint16>(y + row), 0, 0 };
+			if(Private::BlitSurface(strip, &part, dst.Get(), &to) < 0)
+				ok = false;
+		}
+
+		SDL_FreeSurface(strip);
+
+		return ok;
+	}
+
+	bool TiledSurface::Blit(const TiledSurface &src, int x, int y)
+	{
+		if(m_Pixels.empty())
+			throw LogicError("TiledSurface not initialized before call to TiledSurface::Blit(TiledSurface, int, int)");
+		if(src.m_Pixels.empty())
+			throw LogicError("src not initialized before call to TiledSurface::Blit(TiledSurface, int, int)");
+
+		if(src.m_Rmask != m_Rmask || src.m_Gmask != m_Gmask || src.m_Bmask != m_Bmask ||
+		   src.m_Amask != m_Amask)
+		{
+			SDL_SetError("TiledSurface::Blit() needs surfaces with the same masks");
+			return false;
+		}
+
+		int sx = x < 0 ? -x : 0, sy = y < 0 ? -y : 0;
+		int dx = x + sx, dy = y + sy;
+		int w = std::min(src.m_Width - sx, m_Width - dx);
+		int h = std::min(src.m_Height - sy, m_Height - dy);
+		if(w <= 0 || h <= 0)
+			return true;
+
+		std::vector<Uint32> row(w);
+		bool keyed = (src.m_Flags & SDL_SRCCOLORKEY) != 0;
+		Uint32 keymask = m_Rmask | m_Gmask | m_Bmask;
+		Uint32 key = src.m_ColorKey & keymask;
+
+		for(int i = 0; i < h; i++)
+		{
+			src.ReadRow(&src.m_Pixels[0], sx, sy + i, w, &row[0]);
+			if(!keyed)
+			{
+				WriteRow(&m_Pixels[0], dx, dy + i, w, &row[0]);
+				continue;
+			}
+
+			for(int j = 0; j < w; j++)
+			{
+				if((row[j] & keymask) != key)
+					m_Pixels[Index(dx + j, dy + i)] = row[j];
+			}
+		}
+
+		return true;
+	}
+
+	void TiledSurface::Rotate90(TiledSurface &dst, int turns) const
+	{
+		if(m_Pixels.empty())
+			throw LogicError("TiledSurface not initialized before call to TiledSurface::Rotate90(TiledSurface, int)");
+
+		if(&dst == this)
+		{
+			TiledSurface rotated(m_Layout);
+			Rotate90(rotated, turns);
+			dst.Swap(rotated);
+			return;
+		}
+
+		turns &= 3;
+		int w = turns & 1 ? m_Height : m_Width;
+		int h = turns & 1 ? m_Width : m_Height;
+		dst.Create(w, h, m_Rmask, m_Gmask, m_Bmask, m_Amask);
+		dst.m_Flags = m_Flags;
+		dst.m_ColorKey = m_ColorKey;
+		dst.m_Alpha = m_Alpha;
+
+		// A tile of dst at a time, which comes out of a tile or two of
+		// this surface whichever way it's turned
+		int size = 1 << dst.m_Shift;
+		for(int ty = 0; ty < h; ty += size)
+		{
+			for(int tx = 0; tx < w; tx += size)
+			{
+				int y2 = ty + size < h ? ty + size : h;
+				int x2 = tx + size < w ? tx + size : w;
+
+				for(int y = ty; y < y2; y++)
+				{
+					for(int x = tx; x < x2; x++)
+					{
+						int sx, sy;
+						switch(turns)
+						{
+							case 1:
+								sx = y;
+								sy = m_Height - 1 - x;
+								break;
+							case 2:
+								sx = m_Width - 1 - x;
+								sy = m_Height - 1 - y;
+								break;
+							case 3:
+								sx = m_Width - 1 - y;
+								sy = x;
+								break;
+							default:
+								sx = x;
+								sy = y;
+								break;
+						}
+						dst.m_Pixels[dst.Index(x, y)] = m_Pixels[Index(sx, sy)];
+					}
+				}
+			}
+		}
+	}
+
+	void TiledSurface::Convolve(const Kernel &horizontal, const Kernel &vertical)
+	{
+		if(m_Pixels.empty())
+			throw LogicError("TiledSurface not initialized before call to TiledSurface::Convolve(Kernel, Kernel)");
+
+		std::vector<Sint16> hweights = Pad(horizontal), vweights = Pad(vertical);
+		int htaps = hweights.size(), vtaps = vweights.size();
+		// The last tap is padding, so the radius is one less than half
+		int hradius = htaps / 2 - 1, vradius = vtaps / 2 - 1;
+
+		std::vector<Uint32> result(m_Pixels.size());
+		std::vector<Uint32> window;
+		std::vector<Sint16> row((s_Block + htaps + 1) * 4);
+		std::vector<const Uint8 *> rows(vtaps);
+		std::vector<Uint32> out(s_Block);
+
+		for(int by = 0; by < m_Height; by += s_Block)
+		{
+			for(int bx = 0; bx < m_Width; bx += s_Block)
+			{
+				int bw = bx + s_Block < m_Width ? s_Block : m_Width - bx;
+				int bh = by + s_Block < m_Height ? s_Block : m_Height - by;
+
+				// The block's columns plus the horizontal kernel's reach,
+				// and rows plus the vertical kernel's, clamped to the edges
+				int left = bx - hradius;
+				int c1 = left > 0 ? left : 0;
+				int c2 = bx + bw + hradius < m_Width ? bx + bw + hradius : m_Width;
+				int ww = c2 - c1, wh = bh + vtaps - 1;
+
+				window.resize(static_cast<size_t>(ww) * wh);
+				for(int j = 0; j < wh; j++)
+					ReadRow(&m_Pixels[0], c1, Clamp(by - vradius + j, 0, m_Height - 1), ww, &window[j * ww]);
+
+				for(int y = 0; y < bh; y++)
+				{
+					for(int k = 0; k < vtaps; k++)
+						rows[k] = reinterpret_cast<const Uint8 *>(&window[(y + k) * ww]);
+
+					Sint16 *start = &row[(c1 - left) * 4];
+					Private::VerticalRow(&rows[0], &vweights[0], vtaps, 0, start, ww * 4);
+
+					// Repeat the edge pixels out past the image
+					for(Sint16 *p = &row[0]; p < start; p += 4)
+						memcpy(p, start, 4 * sizeof(Sint16));
+					for(Sint16 *p = start + ww * 4; p < &row[0] + row.size(); p += 4)
+						memcpy(p, p - 4, 4 * sizeof(Sint16));
+
+					Private::HorizontalRow(&row[0], &hweights[0], htaps, reinterpret_cast<Uint8 *>(&out[0]), bw);
+					WriteRow(&result[0], bx, by + y, bw, &out[0]);
+				}
+			}
+		}
+
+		m_Pixels.swap(result);
+	}
+
+	void TiledSurface::GaussianBlur(double sigma)
+	{
+		Kernel kernel = Kernel::Gaussian(sigma);
+		Convolve(kernel, kernel);
+	}
+
+	void TiledSurface::BoxBlur(int radius)
+	{
+		Kernel kernel = Kernel::Box(radius);
+		Convolve(kernel, kernel);
+	}
+
+	Uint32 TiledSurface::GetPixel(int x, int y) const
+	{
+		return m_Pixels[Index(x, y)];
+	}
+
+	void TiledSurface::SetPixel(int x, int y, Uint32 pixel)
+	{
+		m_Pixels[Index(x, y)] = pixel;
+	}
+
+	int TiledSurface::GetWidth() const
+	{
+		return m_Width;
+	}
+
+	int TiledSurface::GetHeight() const
+	{
+		return m_Height;
+	}
+
+	TileLayout TiledSurface::GetLayout() const
+	{
+		return m_Layout;
+	}
+}
@@ -17,6 +17,13 @@
 #include "SDL4Cpp_main.h"
 #include "SDL4Cpp_time.h"
 
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#include <unistd.h>
+#endif
+
 namespace SDL
 {
 	Uint32 GetTicks(void)
@@ -24,6 +31,22 @@ namespace SDL
 		return SDL_GetTicks();
 	}
 
+	Uint64 GetMicroTicks(void)
+	{
+	#if defined(_WIN32)
+		LARGE_INTEGER frequency, now;
+		if(QueryPerformanceFrequency(&frequency) && QueryPerformanceCounter(&now))
+			return now.QuadPart / frequency.QuadPart * 1000000 +
+				now.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart;
+	#elif defined(_POSIX_MONOTONIC_CLOCK) && _POSIX_MONOTONIC_CLOCK >= 0
+		struct timespec now;
+		if(clock_gettime(CLOCK_MONOTONIC, &now) == 0)
+			return static_cast<Uint64>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+	#endif
+
+		return static_cast<Uint64>(SDL_GetTicks()) * 1000;
+	}
+
 	void Delay(Uint32 ms)
 	{
 		SDL_Delay(ms);
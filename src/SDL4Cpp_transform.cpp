@@ -0,0 +1,428 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <cmath>
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_video.h"
+#include "SDL4Cpp_blit.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace SDL
+{
+	/*!
+	 * \brief Private SDL4Cpp_transform structure
+	 *
+	 * The part of the source surface being drawn, and how it's blended.
+	 */
+	struct Source
+	{
+		SDL_PixelFormat *format;
+		const Uint8 *pixels;
+		int pitch, bpp;
+		int w, h;
+		bool colorkey;
+		Uint32 key;
+		/*! Use the alpha channel */
+		bool perpixel;
+		/*! The per-surface alpha, 255 when unused */
+		unsigned int alpha;
+		/*! Colors are already multiplied by alpha */
+		bool premultiplied;
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_transform function
+	 *
+	 * One channel of pixel widened to 8 bits.
+	 */
+	static inline unsigned int Channel(Uint32 pixel, Uint32 mask, Uint8 shift, Uint8 loss)
+	{
+		unsigned int value = ((pixel & mask) >> shift) << loss;
+
+		// Repeat the top bits in the low ones so the maximum becomes 255
+		if(loss)
+			value |= value >> (8 - loss);
+
+		return value;
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_transform function
+	 */
+	static inline void Unpack(const SDL_PixelFormat *format, Uint32 pixel, unsigned int rgba[4])
+	{
+		if(format->palette)
+		{
+			const SDL_Color &color = format->palette->colors[pixel & 0xFF];
+			rgba[0] = color.r;
+			rgba[1] = color.g;
+			rgba[2] = color.b;
+			rgba[3] = 255;
+			return;
+		}
+
+		rgba[0] = Channel(pixel, format->Rmask, format->Rshift, format->Rloss);
+		rgba[1] = Channel(pixel, format->Gmask, format->Gshift, format->Gloss);
+		rgba[2] = Channel(pixel, format->Bmask, format->Bshift, format->Bloss);
+		rgba[3] = format->Amask ? Channel(pixel, format->Amask, format->Ashift, format->Aloss) : 255;
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_transform function
+	 */
+	static inline Uint32 Pack(SDL_PixelFormat *format, const unsigned int rgba[4])
+	{
+		if(format->palette)
+		{
+			return SDL_MapRGBA(format, static_cast<Uint8>(rgba[0]), static_cast<Uint8>(rgba[1]),
+				static_cast<Uint8>(rgba[2]), static_cast<Uint8>(rgba[3]));
+		}
+
+		Uint32 pixel = ((rgba[0] >> format->Rloss) << format->Rshift) |
+			((rgba[1] >> format->Gloss) << format->Gshift) |
+			((rgba[2] >> format->Bloss) << format->Bshift);
+
+		if(format->Amask)
+			pixel |= (rgba[3] >> format->Aloss) << format->Ashift;
+
+		return pixel;
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_transform function
+	 *
+	 * Source pixel (x, y) premultiplied by its alpha, pixels outside the
+	 * source are transparent.
+	 */
+	static inline void Fetch(const Source &src, int x, int y, unsigned int rgba[4])
+	{
+		if(static_cast<unsigned int>(x) >= static_cast<unsigned int>(src.w) ||
+			static_cast<unsigned int>(y) >= static_cast<unsigned int>(src.h))
+		{
+			rgba[0] = rgba[1] = rgba[2] = rgba[3] = 0;
+			return;
+		}
+
+		Uint32 pixel = Private::ReadPixel(src.pixels + y * src.pitch + x * src.bpp, src.bpp);
+		if(src.colorkey && pixel == src.key)
+		{
+			rgba[0] = rgba[1] = rgba[2] = rgba[3] = 0;
+			return;
+		}
+
+		Unpack(src.format, pixel, rgba);
+		if(!src.perpixel)
+			rgba[3] = 255;
+		if(src.alpha != 255)
+			rgba[3] = (rgba[3] * src.alpha + 127) / 255;
+
+		if(src.premultiplied)
+		{
+			if(src.alpha != 255)
+			{
+				rgba[0] = (rgba[0] * src.alpha + 127) / 255;
+				rgba[1] = (rgba[1] * src.alpha + 127) / 255;
+				rgba[2] = (rgba[2] * src.alpha + 127) / 255;
+			}
+		}
+		else if(rgba[3] != 255)
+		{
+			rgba[0] = (rgba[0] * rgba[3] + 127) / 255;
+			rgba[1] = (rgba[1] * rgba[3] + 127) / 255;
+			rgba[2] = (rgba[2] * rgba[3] + 127) / 255;
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_transform function
+	 *
+	 * Draw the premultiplied rgba over the pixel at p.
+	 */
+	static inline void Store(SDL_PixelFormat *format, Uint8 *p, int bpp, unsigned int rgba[4])
+	{
+		if(rgba[3] == 0)
+			return;
+
+		if(rgba[3] != 255)
+		{
+			unsigned int under[4];
+			unsigned int inverse = 255 - rgba[3];
+
+			Unpack(format, Private::ReadPixel(p, bpp), under);
+			for(int i = 0; i < 4; i++)
+				rgba[i] += (under[i] * inverse + 127) / 255;
+		}
+
+		Private::WritePixel(p, bpp, Pack(format, rgba));
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_transform function
+	 *
+	 * Raw 32-bit source pixel (x, y), or 0 (clear) outside the source.
+	 */
+	static inline Uint32 Texel32(const Source &src, int x, int y)
+	{
+		if(static_cast<unsigned int>(x) >= static_cast<unsigned int>(src.w) ||
+			static_cast<unsigned int>(y) >= static_cast<unsigned int>(src.h))
+			return 0;
+
+		return *reinterpret_cast<const Uint32 *>(src.pixels + y * src.pitch + x * 4);
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_transform function
+	 *
+	 * Bilinear blend of four premultiplied 32-bit pixels, every byte is a
+	 * channel. fx and fy are 0 to 255. SSE2 does a whole pixel per multiply
+	 * by putting the left and right (then top and bottom) pixels side by
+	 * side.
+	 */
+	static inline Uint32 Bilinear32(Uint32 t00, Uint32 t01, Uint32 t10, Uint32 t11,
+		unsigned int fx, unsigned int fy)
+	{
+	#if defined(__SSE2__)
+		__m128i zero = _mm_setzero_si128();
+		short lx = static_cast<short>(256 - fx), rx = static_cast<short>(fx);
+		short ty = static_cast<short>(256 - fy), by = static_cast<short>(fy);
+		__m128i wx = _mm_set_epi16(rx, rx, rx, rx, lx, lx, lx, lx);
+		__m128i wy = _mm_set_epi16(by, by, by, by, ty, ty, ty, ty);
+
+		__m128i top = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set_epi32(0, 0, t01, t00), zero), wx);
+		__m128i bottom = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set_epi32(0, 0, t11, t10), zero), wx);
+		top = _mm_srli_epi16(_mm_add_epi16(top, _mm_srli_si128(top, 8)), 8);
+		bottom = _mm_srli_epi16(_mm_add_epi16(bottom, _mm_srli_si128(bottom, 8)), 8);
+
+		__m128i both = _mm_mullo_epi16(_mm_unpacklo_epi64(top, bottom), wy);
+		both = _mm_srli_epi16(_mm_add_epi16(both, _mm_srli_si128(both, 8)), 8);
+
+		return _mm_cvtsi128_si32(_mm_packus_epi16(both, both));
+	#else
+		Uint32 result = 0;
+
+		for(int c = 0; c < 32; c += 8)
+		{
+			unsigned int top = (((t00 >> c) & 0xFF) * (256 - fx) + ((t01 >> c) & 0xFF) * fx) >> 8;
+			unsigned int bottom = (((t10 >> c) & 0xFF) * (256 - fx) + ((t11 >> c) & 0xFF) * fx) >> 8;
+			result |= ((top * (256 - fy) + bottom * fy) >> 8) << c;
+		}
+
+		return result;
+	#endif
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_transform function
+	 *
+	 * Draw a premultiplied pixel over *p, both in the same format.
+	 */
+	static inline void Over32(Uint32 *p, Uint32 pixel, int ashift)
+	{
+		Uint32 alpha = (pixel >> ashift) & 0xFF;
+
+		if(alpha == 255)
+			*p = pixel;
+		else if(pixel != 0)
+		{
+			Uint32 d = *p;
+			Uint32 inverse = 256 - (alpha + (alpha >> 7));
+
+			*p = pixel + ((((d & 0x00FF00FF) * inverse) >> 8) & 0x00FF00FF) +
+				((((d >> 8) & 0x00FF00FF) * inverse) & 0xFF00FF00);
+		}
+	}
+
+	bool Surface::BlitTransformed(const Surface &src, int x, int y, double angle, double scale, Filter filter)
+	{
+		if(src.m_Surface == NULL)
+			throw LogicError("src.m_Surface not initialized before call to BlitTransformed(const Surface, int, int, double, double, Filter)");
+
+		Rect srcrect(0, 0, src.m_Surface->w, src.m_Surface->h);
+		return BlitTransformed(srcrect, src, x, y, angle, scale, filter);
+	}
+
+	bool Surface::BlitTransformed(Rect &srcrect, const Surface &src, int x, int y, double angle, double scale, Filter filter)
+	{
+		if(m_Surface == NULL)
+			throw LogicError("m_Surface not intialized before call to BlitTransformed(Rect, const Surface, int, int, double, double, Filter)");
+		if(src.m_Surface == NULL)
+			throw LogicError("src.m_Surface not initialized before call to BlitTransformed(Rect, const Surface, int, int, double, double, Filter)");
+
+		// Only the part of srcrect that's inside src
+		int sx = srcrect.x < 0 ? 0 : srcrect.x;
+		int sy = srcrect.y < 0 ? 0 : srcrect.y;
+		int sw = (srcrect.x + srcrect.w < src.m_Surface->w ? srcrect.x + srcrect.w : src.m_Surface->w) - sx;
+		int sh = (srcrect.y + srcrect.h < src.m_Surface->h ? srcrect.y + srcrect.h : src.m_Surface->h) - sy;
+
+		if(sw <= 0 || sh <= 0 || scale <= 0)
+			return true;
+
+		double radians = angle * 3.14159265358979323846 / 180.0;
+		double c = cos(radians), s = sin(radians);
+
+		// Bounding box of the rotated rectangle, plus a pixel of filtered edge
+		double extentx = (fabs(c) * sw + fabs(s) * sh) * scale / 2;
+		double extenty = (fabs(s) * sw + fabs(c) * sh) * scale / 2;
+		if(filter == FilterBilinear)
+		{
+			extentx += 1;
+			extenty += 1;
+		}
+
+		const SDL_Rect &clip = m_Surface->clip_rect;
+		int x1 = static_cast<int>(floor(x - extentx));
+		int y1 = static_cast<int>(floor(y - extenty));
+		int x2 = static_cast<int>(ceil(x + extentx));
+		int y2 = static_cast<int>(ceil(y + extenty));
+
+		if(x1 < clip.x)
+			x1 = clip.x;
+		if(y1 < clip.y)
+			y1 = clip.y;
+		if(x2 > clip.x + clip.w)
+			x2 = clip.x + clip.w;
+		if(y2 > clip.y + clip.h)
+			y2 = clip.y + clip.h;
+		if(x1 >= x2 || y1 >= y2)
+			return true;
+
+		if(!Lock())
+			return false;
+		if(SDL_MUSTLOCK(src.m_Surface) && SDL_LockSurface(src.m_Surface) != 0)
+		{
+			Unlock();
+			return false;
+		}
+
+		Source source;
+		SDL_PixelFormat *format = src.m_Surface->format;
+		source.format = format;
+		source.bpp = format->BytesPerPixel;
+		source.pitch = src.m_Surface->pitch;
+		source.pixels = static_cast<const Uint8 *>(src.m_Surface->pixels) + sy * source.pitch + sx * source.bpp;
+		source.w = sw;
+		source.h = sh;
+		source.colorkey = (src.m_Surface->flags & SDL_SRCCOLORKEY) != 0;
+		source.key = format->colorkey;
+		source.perpixel = (src.m_Surface->flags & SDL_SRCALPHA) && format->Amask;
+		source.alpha = (src.m_Surface->flags & SDL_SRCALPHA) && !format->Amask ? format->alpha : 255;
+		source.premultiplied = (src.m_Surface->flags & PREMULTIPLIED) != 0;
+
+		SDL_PixelFormat *dstformat = m_Surface->format;
+		int bpp = dstformat->BytesPerPixel;
+
+		// Nothing to blend or convert, so pixels can just be copied
+		bool copy = filter == FilterNearest && !source.colorkey && !source.perpixel &&
+			source.alpha == 255 && !format->palette && !dstformat->palette &&
+			format->BitsPerPixel == dstformat->BitsPerPixel &&
+			format->Rmask == dstformat->Rmask && format->Gmask == dstformat->Gmask &&
+			format->Bmask == dstformat->Bmask && format->Amask == dstformat->Amask;
+
+		// Premultiplied 32-bit onto the same format, blended a byte at a time
+		bool premultiplied = source.premultiplied && source.perpixel && !source.colorkey &&
+			format->BytesPerPixel == 4 && format->Rloss == 0 && format->Gloss == 0 &&
+			format->Bloss == 0 && format->Aloss == 0 && dstformat->BytesPerPixel == 4 &&
+			format->Rmask == dstformat->Rmask && format->Gmask == dstformat->Gmask &&
+			format->Bmask == dstformat->Bmask &&
+			(dstformat->Amask == 0 || dstformat->Amask == format->Amask);
+
+		// Source coordinates step by these for each destination pixel right
+		// and down. Bilinear samples are centered between source pixels.
+		double ustep = c / scale, vstep = s / scale;
+		double offset = filter == FilterBilinear ? 0.5 : 0.0;
+		Sint32 du = static_cast<Sint32>(floor(ustep * 65536 + 0.5));
+		Sint32 dv = static_cast<Sint32>(floor(vstep * 65536 + 0.5));
+
+		for(int py = y1; py < y2; py++)
+		{
+			// Each row starts from an exact position so errors don't add up
+			double qx = x1 + 0.5 - x, qy = py + 0.5 - y;
+			double u = ustep * qx - vstep * qy + sw / 2.0 - offset;
+			double v = vstep * qx + ustep * qy + sh / 2.0 - offset;
+			Sint32 fu = static_cast<Sint32>(floor(u * 65536 + 0.5));
+			Sint32 fv = static_cast<Sint32>(floor(v * 65536 + 0.5));
+
+			Uint8 *p = Private::PixelAddress(m_Surface, x1, py);
+
+			for(int px = x1; px < x2; px++, p += bpp, fu += du, fv += dv)
+			{
+				int iu = fu >> 16, iv = fv >> 16;
+				unsigned int rgba[4];
+
+				if(filter == FilterNearest)
+				{
+					if(static_cast<unsigned int>(iu) >= static_cast<unsigned int>(sw) ||
+						static_cast<unsigned int>(iv) >= static_cast<unsigned int>(sh))
+						continue;
+
+					if(premultiplied)
+					{
+						Over32(reinterpret_cast<Uint32 *>(p), Texel32(source, iu, iv), format->Ashift);
+						continue;
+					}
+
+					if(copy)
+					{
+						const Uint8 *texel = source.pixels + iv * source.pitch + iu * source.bpp;
+						Private::WritePixel(p, bpp, Private::ReadPixel(texel, bpp));
+						continue;
+					}
+
+					Fetch(source, iu, iv, rgba);
+				}
+				else
+				{
+					if(iu < -1 || iu >= sw || iv < -1 || iv >= sh)
+						continue;
+
+					unsigned int fx = (fu >> 8) & 0xFF, fy = (fv >> 8) & 0xFF;
+					unsigned int t00[4], t01[4], t10[4], t11[4];
+
+					if(premultiplied)
+					{
+						Uint32 pixel = Bilinear32(Texel32(source, iu, iv), Texel32(source, iu + 1, iv),
+							Texel32(source, iu, iv + 1), Texel32(source, iu + 1, iv + 1), fx, fy);
+						Over32(reinterpret_cast<Uint32 *>(p), pixel, format->Ashift);
+						continue;
+					}
+
+					Fetch(source, iu, iv, t00);
+					Fetch(source, iu + 1, iv, t01);
+					Fetch(source, iu, iv + 1, t10);
+					Fetch(source, iu + 1, iv + 1, t11);
+
+					for(int i = 0; i < 4; i++)
+					{
+						unsigned int top = (t00[i] * (256 - fx) + t01[i] * fx) >> 8;
+						unsigned int bottom = (t10[i] * (256 - fx) + t11[i] * fx) >> 8;
+						rgba[i] = (top * (256 - fy) + bottom * fy) >> 8;
+					}
+				}
+
+				Store(dstformat, p, bpp, rgba);
+			}
+		}
+
+		if(SDL_MUSTLOCK(src.m_Surface))
+			SDL_UnlockSurface(src.m_Surface);
+		Unlock();
+
+		return true;
+	}
+}
@@ -14,8 +14,14 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  */
 
+#include <cstring>
+#include <map>
+#include <algorithm>
 #include "SDL4Cpp_main.h"
 #include "SDL4Cpp_video.h"
+#include "SDL4Cpp_record.h"
+#include "SDL4Cpp_damage.h"
+#include "SDL4Cpp_blit.h"
 
 namespace SDL
 {
@@ -250,10 +256,9 @@ namespace SDL
 	{
 		if(copy.m_Surface != NULL)
 		{
-			// get the surface information from this
-			m_Surface = SDL_ConvertSurface(copy.m_Surface, copy.m_Surface->format, copy.m_Surface->flags);
-			// then copy the data here
-			if(!Blit(copy))
+			// copies the pixels too, and keeps PREMULTIPLIED
+			m_Surface = Private::ConvertSurface(copy.m_Surface, copy.m_Surface->format, copy.m_Surface->flags);
+			if(m_Surface == NULL)
 				throw RuntimeError("Error copying surface in constructor: " + GetError());
 		}
 		else
@@ -319,10 +324,8 @@ namespace SDL
 				if(m_Surface)
 					Free();
 
-				// get the surface information from the copy
-				Convert((SDL::Surface &)copy);
-				// then copy the data here
-				if(!Blit(copy))
+				// copies the pixels too (see the copy constructor)
+				if(!Convert((SDL::Surface &)copy))
 					throw RuntimeError("Error copying a surface" + GetError());
 			}
 		}
@@ -409,6 +412,14 @@ namespace SDL
 		return Get();
 	}
 
+	int Private::BlitSurface(SDL_Surface *src, SDL_Rect *srcrect, SDL_Surface *dst, SDL_Rect *dstrect)
+	{
+		if((src->flags & (PREMULTIPLIED|SDL_SRCALPHA)) == (PREMULTIPLIED|SDL_SRCALPHA))
+			return Private::BlitPremultiplied(src, srcrect, dst, dstrect);
+
+		return SDL_BlitSurface(src, srcrect, dst, dstrect);
+	}
+
 	bool Surface::Blit(const Surface &src)
 	{
 		if(m_Surface == NULL)
@@ -417,7 +428,7 @@ namespace SDL
 		if(src.m_Surface == NULL)
 			throw LogicError("src.m_Surface not initialized before call to Blit(const Surface)");
 
-		if(SDL_BlitSurface(src.m_Surface, NULL, m_Surface, NULL) == 0)
+		if(Private::BlitSurface(src.m_Surface, NULL, m_Surface, NULL) == 0)
 			return true;
 
 		return false;
@@ -431,7 +442,7 @@ namespace SDL
 		if(src.m_Surface == NULL)
 			throw LogicError("src.m_Surface not initialized before call to Blit(Rect, const Surface, Rect)");
 
-		if(SDL_BlitSurface(src.m_Surface, &srcrect, m_Surface, NULL) == 0)
+		if(Private::BlitSurface(src.m_Surface, &srcrect, m_Surface, NULL) == 0)
 			return true;
 
 		return false;
@@ -446,7 +457,7 @@ namespace SDL
 		if(src.m_Surface == NULL)
 			throw LogicError("src.m_Surface not initialized before call to Blit(const Surface, Rect)");
 
-		if(SDL_BlitSurface(src.m_Surface, NULL, m_Surface, &destrect) == 0)
+		if(Private::BlitSurface(src.m_Surface, NULL, m_Surface, &destrect) == 0)
 			return true;
 
 		return false;
@@ -460,7 +471,7 @@ namespace SDL
 		if(src.m_Surface == NULL)
 			throw LogicError("src.m_Surface not initialized before call to Blit(const Surface, Rect, Rect)");
 
-		if(SDL_BlitSurface(src.m_Surface, &srcrect, m_Surface, &destrect) == 0)
+		if(Private::BlitSurface(src.m_Surface, &srcrect, m_Surface, &destrect) == 0)
 			return true;
 
 		return false;
@@ -474,7 +485,7 @@ namespace SDL
 		if(dest.m_Surface == NULL)
 			throw LogicError("dest.m_Surface not initialized before call to Blit(const Surface, Rect, Surface, Rect)");
 
-		if(SDL_BlitSurface(src.m_Surface, &srcrect, dest.m_Surface, &destrect) == 0)
+		if(Private::BlitSurface(src.m_Surface, &srcrect, dest.m_Surface, &destrect) == 0)
 			return true;
 
 		return false;
@@ -559,11 +570,48 @@ namespace SDL
 
 	bool Surface::Convert(Surface &surface)
 	{
-		m_Surface = SDL_ConvertSurface(*surface, (*surface)->format, (*surface)->flags);
+		return Convert(surface, *(*surface)->format, (*surface)->flags);
+	}
 
-		if(m_Surface == NULL)
+	bool Surface::Convert(Surface &surface, PixelFormat &format, Uint32 flags, bool dither)
+	{
+		SDL_Surface *converted = Private::ConvertSurface(*surface, &format, flags, dither);
+
+		if(converted == NULL)
 			return false;
 
+		if(m_Surface)
+			Free();
+		m_Surface = converted;
+
+		return true;
+	}
+
+	bool Surface::DisplayFormat(Surface &surface, bool dither)
+	{
+		SDL_Surface *converted = Private::DisplayFormat(*surface, false, dither);
+
+		if(converted == NULL)
+			return false;
+
+		if(m_Surface)
+			Free();
+		m_Surface = converted;
+
+		return true;
+	}
+
+	bool Surface::DisplayFormatAlpha(Surface &surface)
+	{
+		SDL_Surface *converted = Private::DisplayFormat(*surface, true);
+
+		if(converted == NULL)
+			return false;
+
+		if(m_Surface)
+			Free();
+		m_Surface = converted;
+
 		return true;
 	}
 
@@ -661,15 +709,34 @@ namespace SDL
 		return m_Surface->pitch;
 	}
 
+	/*!
+	 * \brief Private SDL4Cpp_video variable
+	 *
+	 * Bumped by Screen::SetVideoMode(), see GL::GetContext()
+	 */
+	static Uint32 s_GLContext = 0;
+
+	/*!
+	 * \brief Private SDL4Cpp_video variable
+	 *
+	 * GL functions looked up since the last Screen::SetVideoMode()
+	 */
+	static std::map<std::string, void *> s_GLProcs;
+
+	/*!
+	 * \brief Private SDL4Cpp_video variable
+	 *
+	 * GL attributes read since the last Screen::SetVideoMode(), a bit in
+	 * s_GLRead for each one in s_GLAttributes
+	 */
+	static int s_GLAttributes[32];
+	static Uint32 s_GLRead = 0;
+
 	namespace GL
 	{
 		bool LoadLibrary(const std::string path)
 		{
-			Screen screen;
-			if(!GetVideoSurface(screen))
-				throw LogicError("You must not setup a Screen before calling GL::LibraryLoad");
-
-			if(screen.m_Surface)
+			if(SDL_GetVideoSurface())
 				throw LogicError("You must not setup a Screen before calling GL::LibraryLoad");
 
 			if(SDL_GL_LoadLibrary(path.c_str()) < 0)
@@ -680,38 +747,64 @@ namespace SDL
 
 		void *GetProcAddress(const std::string proc)
 		{
-			Screen screen;
-			if(!GetVideoSurface(screen))
+			if(SDL_GetVideoSurface() == NULL)
 				throw LogicError("You must setup a Screen before calling GL::GetProcAddress");
 
-			if(!screen.m_Surface)
-				throw LogicError("You must setup a Screen before calling GL::GetGetProcAddress");
+			std::map<std::string, void *>::iterator found = s_GLProcs.find(proc);
+			if(found != s_GLProcs.end())
+				return found->second;
+
+			void *address = SDL_GL_GetProcAddress(proc.c_str());
+			s_GLProcs[proc] = address;
+
+			return address;
+		}
+
+		bool LoadProcs(const char *const *names)
+		{
+			bool ok = true;
+			for(int i = 0; names[i]; i++)
+			{
+				if(GetProcAddress(names[i]) == NULL)
+					ok = false;
+			}
 
-			return SDL_GL_GetProcAddress(proc.c_str());
+			return ok;
+		}
+
+		Uint32 GetContext()
+		{
+			return s_GLContext;
 		}
 
 		bool GetAttribute(Attr attr, int &value)
 		{
-			Screen screen;
-			if(!GetVideoSurface(screen))
+			if(SDL_GetVideoSurface() == NULL)
 				throw LogicError("You must setup a Screen before calling GL::GetAttribute");
 
-			if(!screen.m_Surface)
-				throw LogicError("You must setup a Screen before calling GL::GetAttribute");
+			int index = static_cast<int>(attr);
+			bool cached = index >= 0 && index < 32;
+			if(cached && (s_GLRead & (1u << index)))
+			{
+				value = s_GLAttributes[index];
+				return true;
+			}
 
 			if(SDL_GL_GetAttribute(attr, &value) < 0)
 				return false;
 
+			if(cached)
+			{
+				s_GLAttributes[index] = value;
+				s_GLRead |= 1u << index;
+			}
+
 			return true;
 		}
 
 		bool SetAttribute(Attr attr, int value)
 		{
-			Screen screen;
-			if(GetVideoSurface(screen))
-				throw LogicError("You must not setup a Screen before calling GL::SetAttribute");
-
-			if(screen.m_Surface)
+			if(SDL_GetVideoSurface())
 				throw LogicError("You must not setup a Screen before calling GL::SetAttribute");
 
 			if(SDL_GL_SetAttribute(attr, value) < 0)
@@ -760,8 +853,32 @@ namespace SDL
 		return true;
 	}
 
+	/*!
+	 * \brief Private SDL4Cpp_video variable
+	 *
+	 * There's only one video surface, so there's only one recorder for it
+	 */
+	static FrameRecorder *s_Recorder = NULL;
+
+	/*!
+	 * \brief Private SDL4Cpp_video variable
+	 *
+	 * Set while damage tracking is on
+	 */
+	static Private::DamageTracker *s_Damage = NULL;
+
 	bool Screen::Flip()
 	{
+		if(s_Recorder)
+			s_Recorder->Capture(*this);
+
+		// Hardware page flipping always swaps the whole screen
+		if(s_Damage && m_Surface && !(m_Surface->flags & SDL_DOUBLEBUF))
+		{
+			s_Damage->Present(m_Surface, 0, NULL);
+			return true;
+		}
+
 		if(SDL_Flip(m_Surface) == 0)
 			return true;
 
@@ -770,18 +887,38 @@ namespace SDL
 
 	void Screen::UpdateRect(Rect &rect)
 	{
-		SDL_UpdateRect(m_Surface, rect.x, rect.y, rect.w, rect.h);
+		UpdateRect(rect.x, rect.y, rect.w, rect.h);
 	}
 
 	void Screen::UpdateRect(Sint32 x, Sint32 y, Sint32 w, Sint32 h)
 	{
-		SDL_UpdateRect(m_Surface, x, y, w, h);
+		if(m_Surface == NULL)
+			return;
+
+		// Same as SDL_UpdateRect(), but through UpdateRects() so recording
+		// and damage tracking see the frame
+		if(w == 0)
+			w = m_Surface->w;
+		if(h == 0)
+			h = m_Surface->h;
+		if(x + w > m_Surface->w || y + h > m_Surface->h)
+			return;
+
+		Rect rect(static_cast<Sint16>(x), static_cast<Sint16>(y),
+				  static_cast<Uint16>(w), static_cast<Uint16>(h));
+		UpdateRects(1, &rect);
 	}
 
 	// Uses a pionter because rects will be an array
 	void Screen::UpdateRects(int numrects, Rect *rects)
 	{
-		SDL_UpdateRects(m_Surface, numrects, rects);
+		if(s_Recorder)
+			s_Recorder->Capture(*this);
+
+		if(s_Damage && m_Surface && !(m_Surface->flags & SDL_DOUBLEBUF))
+			s_Damage->Present(m_Surface, numrects, rects);
+		else
+			SDL_UpdateRects(m_Surface, numrects, rects);
 	}
 
 
@@ -809,11 +946,194 @@ namespace SDL
 		return true;
 	}
 
+	void Screen::SetRecorder(FrameRecorder *recorder)
+	{
+		s_Recorder = recorder;
+	}
+
+	FrameRecorder *Screen::GetRecorder()
+	{
+		return s_Recorder;
+	}
+
+	void Screen::SetDamageTracking(bool enable, int tilesize)
+	{
+		delete s_Damage;
+		s_Damage = NULL;
+
+		if(enable)
+			s_Damage = new Private::DamageTracker(tilesize);
+	}
+
+	bool Screen::GetDamageTracking()
+	{
+		return s_Damage != NULL;
+	}
+
+	DamageStats Screen::GetDamageStats()
+	{
+		if(s_Damage)
+			return s_Damage->GetStats();
+
+		DamageStats stats = { 0, 0, 0, 0, 0, 0 };
+		return stats;
+	}
+
 	int Screen::VideoModeOK(int width, int height, int bpp, Uint32 flags)
 	{
 		return SDL_VideoModeOK(width, height, bpp, flags);
 	}
 
+	/*!
+	 * \brief Private SDL4Cpp_video structure
+	 *
+	 * What a ListModes() list was asked for with
+	 */
+	struct ModeKey
+	{
+		Uint8 bpp;
+		Uint32 Rmask, Gmask, Bmask, Amask;
+		Uint32 flags;
+
+		bool operator <(const ModeKey &other) const
+		{
+			if(bpp != other.bpp)
+				return bpp < other.bpp;
+			if(Rmask != other.Rmask)
+				return Rmask < other.Rmask;
+			if(Gmask != other.Gmask)
+				return Gmask < other.Gmask;
+			if(Bmask != other.Bmask)
+				return Bmask < other.Bmask;
+			if(Amask != other.Amask)
+				return Amask < other.Amask;
+			return flags < other.flags;
+		}
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_video structure
+	 */
+	struct ModeList
+	{
+		ModeList() : any(false), modes()
+		{
+		}
+
+		bool any;
+		std::vector<Rect> modes;
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_video variable
+	 *
+	 * Every ListModes() list asked for so far
+	 */
+	static std::map<ModeKey, ModeList> s_Modes;
+
+	/*!
+	 * \brief Private SDL4Cpp_video function
+	 *
+	 * Largest first, by width then height
+	 */
+	static bool LargerMode(const Rect &a, const Rect &b)
+	{
+		if(a.w != b.w)
+			return a.w > b.w;
+		return a.h > b.h;
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_video function
+	 */
+	static bool SameMode(const Rect &a, const Rect &b)
+	{
+		return a.w == b.w && a.h == b.h;
+	}
+
+	const std::vector<Rect> &Screen::ListModes(PixelFormat *format, Uint32 flags, bool *any)
+	{
+		const PixelFormat *key = format;
+		if(key == NULL)
+		{
+			const VideoInfo *info = SDL_GetVideoInfo();
+			key = info ? info->vfmt : NULL;
+		}
+
+		ModeKey modekey = { 0, 0, 0, 0, 0, flags };
+		if(key)
+		{
+			modekey.bpp = key->BitsPerPixel;
+			modekey.Rmask = key->Rmask;
+			modekey.Gmask = key->Gmask;
+			modekey.Bmask = key->Bmask;
+			modekey.Amask = key->Amask;
+		}
+
+		std::map<ModeKey, ModeList>::iterator found = s_Modes.find(modekey);
+		if(found == s_Modes.end())
+		{
+			ModeList &list = s_Modes[modekey];
+			SDL_Rect **modes = SDL_ListModes(format, flags);
+
+			if(modes == reinterpret_cast<SDL_Rect **>(-1))
+				list.any = true;
+			else if(modes)
+			{
+				for(int i = 0; modes[i]; i++)
+					list.modes.push_back(*modes[i]);
+
+				std::sort(list.modes.begin(), list.modes.end(), LargerMode);
+				list.modes.erase(std::unique(list.modes.begin(), list.modes.end(), SameMode),
+								 list.modes.end());
+			}
+
+			found = s_Modes.find(modekey);
+		}
+
+		if(any)
+			*any = found->second.any;
+
+		return found->second.modes;
+	}
+
+	bool Screen::BestMode(int w, int h, int bpp, Uint32 flags, Rect &mode)
+	{
+		PixelFormat format;
+		memset(&format, 0, sizeof(format));
+		format.BitsPerPixel = static_cast<Uint8>(bpp);
+		format.BytesPerPixel = static_cast<Uint8>((bpp + 7) / 8);
+
+		bool any;
+		const std::vector<Rect> &modes = ListModes(&format, flags, &any);
+
+		if(any)
+		{
+			mode = Rect(0, 0, static_cast<Uint16>(w), static_cast<Uint16>(h));
+			return true;
+		}
+
+		if(modes.empty())
+			return false;
+
+		// The smallest that fits, or else the largest
+		const Rect *best = NULL;
+		for(unsigned int i = 0; i < modes.size(); i++)
+		{
+			if(modes[i].w >= w && modes[i].h >= h &&
+			   (best == NULL || modes[i].w * modes[i].h < best->w * best->h))
+				best = &modes[i];
+		}
+
+		mode = best ? *best : modes.front();
+		return true;
+	}
+
+	void Screen::FlushModes()
+	{
+		s_Modes.clear();
+	}
+
 	std::string Screen::VideoDriverName()
 	{
 		char namebuf[1000];
@@ -836,6 +1156,15 @@ namespace SDL
 	{
 		m_Surface = SDL_SetVideoMode(width, height, bpp, flags);
 
+		// The GL context may be a new one
+		s_GLContext++;
+		s_GLProcs.clear();
+		s_GLRead = 0;
+
+		// Whatever the shadow holds isn't on the new screen
+		if(s_Damage)
+			s_Damage->Invalidate();
+
 		if(m_Surface == NULL)
 			return false;
 		return true;
@@ -874,16 +1203,16 @@ namespace SDL
 
 		return true;
 	}
-	Overlay::Overlay() : m_Overlay(NULL)
+	Overlay::Overlay() : m_Overlay(NULL), m_Display(NULL), m_Filter(FilterNearest)
 	{
 	}
 
-	Overlay::Overlay(const Overlay &copy) : m_Overlay(NULL)
+	Overlay::Overlay(const Overlay &copy) : m_Overlay(NULL), m_Display(NULL), m_Filter(copy.m_Filter)
 	{
 		// XXX TODO Overlay copy constructor... Should there be an equal operator too?
 	}
 
-	Overlay::Overlay(SDL_Overlay *overlay) : m_Overlay(overlay)
+	Overlay::Overlay(SDL_Overlay *overlay) : m_Overlay(overlay), m_Display(NULL), m_Filter(FilterNearest)
 	{
 	}
 
@@ -898,6 +1227,7 @@ namespace SDL
 			Free();
 
 		m_Overlay = SDL_CreateYUVOverlay(width, height, format, display);
+		m_Display = display;
 	}
 
 	bool Overlay::Lock()
@@ -915,18 +1245,70 @@ namespace SDL
 
 	bool Overlay::Display(Rect &destrect)
 	{
+		if(m_Overlay == NULL)
+			throw LogicError("m_Overlay not intialized before call to Display(Rect)");
+
+		// SDL's software conversion is slow, so do it here instead
+		SDL_Surface *display = m_Display ? m_Display : SDL_GetVideoSurface();
+		if(!m_Overlay->hw_overlay && display)
+		{
+			SDL_Rect area = destrect;
+			if(Private::BlitYUV(m_Overlay, display, area, m_Filter == FilterBilinear))
+			{
+				// Through Screen so recording and damage tracking see it
+				if(display == SDL_GetVideoSurface() && area.w && area.h &&
+				   (display->flags & SDL_DOUBLEBUF) != SDL_DOUBLEBUF)
+				{
+					Screen screen;
+					GetVideoSurface(screen);
+
+					Rect rect(area);
+					screen.UpdateRects(1, &rect);
+				}
+
+				return true;
+			}
+		}
+
 		if(SDL_DisplayYUVOverlay(m_Overlay, &destrect) == 0)
 			return true;
 
 		return false;
 	}
 
+	bool Overlay::Blit(Surface &dst, Rect &destrect, Filter filter)
+	{
+		if(m_Overlay == NULL)
+			throw LogicError("m_Overlay not intialized before call to Blit(Surface, Rect, Filter)");
+
+		if(dst.Get() == NULL)
+			throw LogicError("dst not initialized before call to Overlay::Blit(Surface, Rect, Filter)");
+
+		return Private::BlitYUV(m_Overlay, dst.Get(), destrect, filter == FilterBilinear);
+	}
+
+	void Overlay::SetFilter(Filter filter)
+	{
+		m_Filter = filter;
+	}
+
+	Filter Overlay::GetFilter() const
+	{
+		return m_Filter;
+	}
+
+	SDL_Overlay *Overlay::Get()
+	{
+		return m_Overlay;
+	}
+
 	void Overlay::Free()
 	{
 		if(m_Overlay)
 		{
 			SDL_FreeYUVOverlay(m_Overlay);
 			m_Overlay = NULL;
+			m_Display = NULL;
 		}
 	}
 }
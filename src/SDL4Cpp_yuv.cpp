@@ -0,0 +1,490 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <cmath>
+#include <vector>
+#include "SDL4Cpp_main.h"
+#include "SDL4Cpp_blit.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace SDL
+{
+	/*!
+	 * \brief Private SDL4Cpp_yuv structure
+	 *
+	 * Where to put 8-bit r, g and b in a pixel of the destination.
+	 */
+	struct Pack
+	{
+		int Rloss, Gloss, Bloss;
+		int Rshift, Gshift, Bshift;
+		/*! Set in every pixel, so alpha is opaque */
+		Uint32 Amask;
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_yuv function
+	 */
+	static inline int Clamp(int value)
+	{
+		return value < 0 ? 0 : (value > 255 ? 255 : value);
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_yuv function
+	 *
+	 * BT.601 studio range YUV to RGB for n pixels, in 8.8 fixed point:
+	 *
+	 * r = (298 (y - 16) + 409 (v - 128) + 128) >> 8
+	 * g = (298 (y - 16) - 100 (u - 128) - 208 (v - 128) + 128) >> 8
+	 * b = (298 (y - 16) + 516 (u - 128) + 128) >> 8
+	 *
+	 * u and v are one per pixel. The SSE2 loop does 8 pixels at a time with
+	 * madd and gives the same results as the plain one.
+	 */
+	static void ConvertRow(const Uint8 *y, const Uint8 *u, const Uint8 *v, int n,
+						   const Pack &pack, Uint32 *out)
+	{
+		int x = 0;
+
+	#if defined(__SSE2__)
+		{
+			__m128i zero = _mm_setzero_si128();
+			__m128i sixteen = _mm_set1_epi16(16);
+			__m128i half = _mm_set1_epi16(128);
+			__m128i round = _mm_set1_epi32(128);
+			__m128i max = _mm_set1_epi16(255);
+			// Pairs of (c, e), (c, d) and (e, 0) weights for madd
+			__m128i wr = _mm_set_epi16(409, 298, 409, 298, 409, 298, 409, 298);
+			__m128i wg = _mm_set_epi16(-100, 298, -100, 298, -100, 298, -100, 298);
+			__m128i wge = _mm_set_epi16(0, -208, 0, -208, 0, -208, 0, -208);
+			__m128i wb = _mm_set_epi16(516, 298, 516, 298, 516, 298, 516, 298);
+			__m128i rloss = _mm_cvtsi32_si128(pack.Rloss), rshift = _mm_cvtsi32_si128(pack.Rshift);
+			__m128i gloss = _mm_cvtsi32_si128(pack.Gloss), gshift = _mm_cvtsi32_si128(pack.Gshift);
+			__m128i bloss = _mm_cvtsi32_si128(pack.Bloss), bshift = _mm_cvtsi32_si128(pack.Bshift);
+			__m128i amask = _mm_set1_epi32(pack.Amask);
+
+			for(; x + 8 <= n; x += 8)
+			{
+				__m128i c = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(y + x)), zero), sixteen);
+				__m128i d = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(u + x)), zero), half);
+				__m128i e = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(v + x)), zero), half);
+
+				__m128i ce0 = _mm_unpacklo_epi16(c, e), ce1 = _mm_unpackhi_epi16(c, e);
+				__m128i cd0 = _mm_unpacklo_epi16(c, d), cd1 = _mm_unpackhi_epi16(c, d);
+				__m128i e0 = _mm_unpacklo_epi16(e, zero), e1 = _mm_unpackhi_epi16(e, zero);
+
+				__m128i r = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ce0, wr), round), 8),
+											_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ce1, wr), round), 8));
+				__m128i g = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(cd0, wg),
+																					   _mm_madd_epi16(e0, wge)), round), 8),
+											_mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(cd1, wg),
+																					   _mm_madd_epi16(e1, wge)), round), 8));
+				__m128i b = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cd0, wb), round), 8),
+											_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cd1, wb), round), 8));
+
+				r = _mm_srl_epi16(_mm_max_epi16(_mm_min_epi16(r, max), zero), rloss);
+				g = _mm_srl_epi16(_mm_max_epi16(_mm_min_epi16(g, max), zero), gloss);
+				b = _mm_srl_epi16(_mm_max_epi16(_mm_min_epi16(b, max), zero), bloss);
+
+				__m128i p0 = _mm_or_si128(_mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(r, zero), rshift),
+													   _mm_sll_epi32(_mm_unpacklo_epi16(g, zero), gshift)),
+										  _mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(b, zero), bshift), amask));
+				__m128i p1 = _mm_or_si128(_mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(r, zero), rshift),
+													   _mm_sll_epi32(_mm_unpackhi_epi16(g, zero), gshift)),
+										  _mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(b, zero), bshift), amask));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + x), p0);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + x + 4), p1);
+			}
+		}
+	#endif
+
+		for(; x < n; x++)
+		{
+			int c = y[x] - 16, d = u[x] - 128, e = v[x] - 128;
+			Uint32 r = Clamp((298 * c + 409 * e + 128) >> 8);
+			Uint32 g = Clamp((298 * c - 100 * d - 208 * e + 128) >> 8);
+			Uint32 b = Clamp((298 * c + 516 * d + 128) >> 8);
+			out[x] = ((r >> pack.Rloss) << pack.Rshift) | ((g >> pack.Gloss) << pack.Gshift) |
+				((b >> pack.Bloss) << pack.Bshift) | pack.Amask;
+		}
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_yuv function
+	 *
+	 * out = (a * (256 - f) + b * f + 128) >> 8 for n bytes.
+	 */
+	static void LerpRow(const Uint8 *a, const Uint8 *b, int f, int n, Uint8 *out)
+	{
+		int x = 0;
+
+	#if defined(__SSE2__)
+		{
+			__m128i zero = _mm_setzero_si128();
+			__m128i fa = _mm_set1_epi16(256 - f), fb = _mm_set1_epi16(f);
+			__m128i round = _mm_set1_epi16(128);
+
+			for(; x + 16 <= n; x += 16)
+			{
+				__m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + x));
+				__m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+				__m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), fa),
+														 _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), fb)), round);
+				__m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), fa),
+														 _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), fb)), round);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + x),
+								 _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+			}
+		}
+	#endif
+
+		for(; x < n; x++)
+			out[x] = static_cast<Uint8>((a[x] * (256 - f) + b[x] * f + 128) >> 8);
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_yuv function
+	 *
+	 * Double each of n bytes of in into out, for 4:2:x chroma at 1:1.
+	 */
+	static void DoubleRow(const Uint8 *in, int n, Uint8 *out)
+	{
+		int x = 0;
+
+	#if defined(__SSE2__)
+		for(; x + 16 <= n; x += 16)
+		{
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + x));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * x), _mm_unpacklo_epi8(v, v));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * x + 16), _mm_unpackhi_epi8(v, v));
+		}
+	#endif
+
+		for(; x < n; x++)
+			out[2 * x] = out[2 * x + 1] = in[x];
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_yuv structure
+	 *
+	 * Where an output column or row samples from: a and b blended by f / 256.
+	 */
+	struct Tap
+	{
+		int a, b, f;
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_yuv function
+	 *
+	 * Where output i of outputs stretched over inputs samples from, with
+	 * pixel centers lined up.
+	 */
+	static Tap MakeTap(int i, int outputs, int inputs, bool bilinear)
+	{
+		Tap tap;
+
+		if(!bilinear)
+		{
+			tap.a = tap.b = (2 * i + 1) * inputs / (2 * outputs);
+			tap.f = 0;
+			return tap;
+		}
+
+		int position = static_cast<int>(std::floor(((i + 0.5) * inputs / outputs - 0.5) * 256.0 + 0.5));
+		if(position < 0)
+			position = 0;
+
+		tap.a = position >> 8;
+		tap.f = position & 255;
+		if(tap.a >= inputs - 1)
+		{
+			tap.a = inputs - 1;
+			tap.f = 0;
+		}
+		tap.b = tap.f ? tap.a + 1 : tap.a;
+
+		return tap;
+	}
+
+	/*!
+	 * \brief Private SDL4Cpp_yuv class
+	 *
+	 * Rows of an overlay as separate y, u and v, unpacking packed formats
+	 * into scratch space.
+	 */
+	class Planes
+	{
+		public:
+			Planes(SDL_Overlay *overlay) :
+				m_Overlay(overlay), m_Packed(true), m_Y(0), m_U(0), m_V(0), m_Scratch()
+			{
+				switch(overlay->format)
+				{
+					case SDL_YV12_OVERLAY:
+						m_Packed = false;
+						m_U = 2;
+						m_V = 1;
+						break;
+					case SDL_IYUV_OVERLAY:
+						m_Packed = false;
+						m_U = 1;
+						m_V = 2;
+						break;
+					case SDL_YUY2_OVERLAY:
+						m_Y = 0;
+						m_U = 1;
+						m_V = 3;
+						break;
+					case SDL_UYVY_OVERLAY:
+						m_Y = 1;
+						m_U = 0;
+						m_V = 2;
+						break;
+					default:
+						// SDL_YVYU_OVERLAY
+						m_Y = 0;
+						m_U = 3;
+						m_V = 1;
+						break;
+				}
+
+				if(m_Packed)
+				{
+					int chroma = (overlay->w + 1) / 2;
+					for(int i = 0; i < 2; i++)
+						m_Scratch[i].resize(2 * chroma * 2);
+				}
+			}
+
+			/*!
+			 * \brief Chroma rows are half as many as luma rows.
+			 */
+			bool HalfHeight() const
+			{
+				return !m_Packed;
+			}
+
+			/*!
+			 * \brief Luma row row and chroma row chroma, using scratch
+			 * space slot (0 or 1) if the overlay is packed.
+			 */
+			void Row(int row, int chroma, int slot, const Uint8 *&y, const Uint8 *&u, const Uint8 *&v)
+			{
+				if(!m_Packed)
+				{
+					y = m_Overlay->pixels[0] + row * m_Overlay->pitches[0];
+					u = m_Overlay->pixels[m_U] + chroma * m_Overlay->pitches[m_U];
+					v = m_Overlay->pixels[m_V] + chroma * m_Overlay->pitches[m_V];
+					return;
+				}
+
+				int pairs = (m_Overlay->w + 1) / 2;
+				Uint8 *out = &m_Scratch[slot][0];
+				const Uint8 *p = m_Overlay->pixels[0] + row * m_Overlay->pitches[0];
+				for(int i = 0; i < pairs; i++, p += 4)
+				{
+					out[2 * i] = p[m_Y];
+					out[2 * i + 1] = p[m_Y + 2];
+					out[2 * pairs + i] = p[m_U];
+					out[3 * pairs + i] = p[m_V];
+				}
+
+				y = out;
+				u = out + 2 * pairs;
+				v = out + 3 * pairs;
+			}
+		private:
+			Planes(const Planes &copy);
+			Planes &operator =(const Planes &copy);
+
+			SDL_Overlay *m_Overlay;
+			bool m_Packed;
+			/*! Plane of y, u and v, or their byte in a packed pair */
+			int m_Y, m_U, m_V;
+			std::vector<Uint8> m_Scratch[2];
+	};
+
+	namespace Private
+	{
+		bool BlitYUV(SDL_Overlay *overlay, SDL_Surface *dst, SDL_Rect &dstrect, bool bilinear)
+		{
+			switch(overlay->format)
+			{
+				case SDL_YV12_OVERLAY:
+				case SDL_IYUV_OVERLAY:
+				case SDL_YUY2_OVERLAY:
+				case SDL_UYVY_OVERLAY:
+				case SDL_YVYU_OVERLAY:
+					break;
+				default:
+					SDL_SetError("Unsupported YUV format");
+					return false;
+			}
+
+			SDL_PixelFormat *format = dst->format;
+			if(format->BytesPerPixel < 2 || format->palette)
+			{
+				SDL_SetError("YUV can only be converted to 16, 24 or 32-bit RGB");
+				return false;
+			}
+
+			// Scale to all of dstrect, then draw only what's inside the
+			// clip rectangle
+			int width = dstrect.w, height = dstrect.h;
+			int x1 = dstrect.x, y1 = dstrect.y;
+			int x2 = x1 + width, y2 = y1 + height;
+			const SDL_Rect &clip = dst->clip_rect;
+			int left = x1, top = y1;
+			x1 = x1 < clip.x ? clip.x : x1;
+			y1 = y1 < clip.y ? clip.y : y1;
+			x2 = x2 > clip.x + clip.w ? clip.x + clip.w : x2;
+			y2 = y2 > clip.y + clip.h ? clip.y + clip.h : y2;
+			if(x2 <= x1 || y2 <= y1)
+			{
+				dstrect.w = dstrect.h = 0;
+				return true;
+			}
+
+			// Offsets of the clipped area inside the full scaled one
+			left = x1 - left;
+			top = y1 - top;
+			int n = x2 - x1;
+			dstrect.x = x1;
+			dstrect.y = y1;
+			dstrect.w = n;
+			dstrect.h = y2 - y1;
+
+			int w = overlay->w, h = overlay->h;
+			int cw = (w + 1) / 2;
+			Planes planes(overlay);
+			int ch = planes.HalfHeight() ? (h + 1) / 2 : h;
+
+			// At 1:1 luma is used as it is and chroma just doubled
+			bool unscaled = width == w && height == h;
+			if(unscaled)
+				bilinear = false;
+
+			std::vector<Tap> luma(n), chroma(n);
+			for(int i = 0; i < n; i++)
+			{
+				luma[i] = MakeTap(left + i, width, w, bilinear);
+				chroma[i] = bilinear ? MakeTap(left + i, width, cw, true) : luma[i];
+				if(!bilinear)
+					chroma[i].a = chroma[i].b = luma[i].a >> 1;
+			}
+
+			Pack pack;
+			pack.Rloss = format->Rloss;
+			pack.Gloss = format->Gloss;
+			pack.Bloss = format->Bloss;
+			pack.Rshift = format->Rshift;
+			pack.Gshift = format->Gshift;
+			pack.Bshift = format->Bshift;
+			pack.Amask = format->Amask;
+
+			// y, u and v blended down, then across, then the RGB pixels
+			// Chroma doubled at 1:1 may start a byte early and end a byte
+			// late
+			std::vector<Uint8> rows(w + 2 * cw), ly(n), lu(n + 2), lv(n + 2);
+			std::vector<Uint32> pixels(format->BytesPerPixel == 4 ? 0 : n);
+
+			if(SDL_MUSTLOCK(dst) && SDL_LockSurface(dst) < 0)
+				return false;
+
+			int bpp = format->BytesPerPixel;
+			for(int row = 0; row < dstrect.h; row++)
+			{
+				const Uint8 *y, *u, *v;
+				Tap ty = MakeTap(top + row, height, h, bilinear);
+				Tap tc = ty;
+				if(bilinear && planes.HalfHeight())
+					tc = MakeTap(top + row, height, ch, true);
+				else if(planes.HalfHeight())
+					tc.a = tc.b = ty.a >> 1;
+
+				if(ty.f || tc.f)
+				{
+					const Uint8 *y0, *u0, *v0, *y1, *u1, *v1;
+					planes.Row(ty.a, tc.a, 0, y0, u0, v0);
+					planes.Row(ty.b, tc.b, 1, y1, u1, v1);
+
+					// Packed rows have their chroma with their luma, so
+					// both blend by ty.f
+					int cf = planes.HalfHeight() ? tc.f : ty.f;
+					LerpRow(y0, y1, ty.f, w, &rows[0]);
+					LerpRow(u0, u1, cf, cw, &rows[w]);
+					LerpRow(v0, v1, cf, cw, &rows[w + cw]);
+					y = &rows[0];
+					u = &rows[w];
+					v = &rows[w + cw];
+				}
+				else
+					planes.Row(ty.a, tc.a, 0, y, u, v);
+
+				const Uint8 *cy = &ly[0], *cu = &lu[0], *cv = &lv[0];
+				if(unscaled)
+				{
+					// Double from the pair left starts in
+					int pairs = (n + (left & 1) + 1) >> 1;
+					DoubleRow(u + (left >> 1), pairs, &lu[0]);
+					DoubleRow(v + (left >> 1), pairs, &lv[0]);
+					cy = y + left;
+					cu += left & 1;
+					cv += left & 1;
+				}
+				else if(!bilinear)
+				{
+					for(int i = 0; i < n; i++)
+					{
+						ly[i] = y[luma[i].a];
+						lu[i] = u[chroma[i].a];
+						lv[i] = v[chroma[i].a];
+					}
+				}
+				else
+				{
+					for(int i = 0; i < n; i++)
+					{
+						const Tap &l = luma[i], &c = chroma[i];
+						ly[i] = static_cast<Uint8>((y[l.a] * (256 - l.f) + y[l.b] * l.f + 128) >> 8);
+						lu[i] = static_cast<Uint8>((u[c.a] * (256 - c.f) + u[c.b] * c.f + 128) >> 8);
+						lv[i] = static_cast<Uint8>((v[c.a] * (256 - c.f) + v[c.b] * c.f + 128) >> 8);
+					}
+				}
+
+				Uint8 *out = PixelAddress(dst, x1, y1 + row);
+				if(bpp == 4)
+					ConvertRow(cy, cu, cv, n, pack, reinterpret_cast<Uint32 *>(out));
+				else
+				{
+					ConvertRow(cy, cu, cv, n, pack, &pixels[0]);
+					for(int i = 0; i < n; i++, out += bpp)
+						WritePixel(out, bpp, pixels[i]);
+				}
+			}
+
+			if(SDL_MUSTLOCK(dst))
+				SDL_UnlockSurface(dst);
+
+			return true;
+		}
+	}
+}
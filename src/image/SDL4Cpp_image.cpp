@@ -14,12 +14,265 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  */
 
+#include <cctype>
+#include <cstring>
 #include "SDL4Cpp.h"
 #include "SDL4Cpp_image.h"
 #include "SDL_image.h"
+#include "../SDL4Cpp_blit.h"
 
 namespace SDL
 {
+	/*!
+	 * \brief Private SDL4Cpp_image structure
+	 *
+	 * Everything shared between the ImageLoad handles and the loader thread.
+	 * m_Refs counts both, and whoever drops it to zero deletes the State.
+	 */
+	struct ImageLoad::State
+	{
+		State(const std::string &file, Conversion convert, SDL_Surface *target, int code, Uint32 id) :
+			mutex(SDL_CreateMutex()), done(SDL_CreateCond()), refs(1),
+			finished(false), surface(NULL), error(), file(file),
+			convert(convert), target(target), code(code), id(id)
+		{
+			if(mutex == NULL || done == NULL)
+			{
+				std::string message = SDL::GetError();
+				Destroy();
+				throw RuntimeError("Error creating ImageLoad: " + message);
+			}
+		}
+
+		~State()
+		{
+			if(surface)
+				SDL_FreeSurface(surface);
+
+			Destroy();
+		}
+
+		void Destroy()
+		{
+			if(target)
+				SDL_FreeSurface(target);
+			if(done)
+				SDL_DestroyCond(done);
+			if(mutex)
+				SDL_DestroyMutex(mutex);
+		}
+
+		MT::Mutex *mutex;
+		MT::Cond *done;
+		int refs;
+		bool finished;
+		SDL_Surface *surface;
+		std::string error;
+		std::string file;
+		Conversion convert;
+		/*! Holds the display format from when the load started, since
+		 * the video surface can't be touched from the loader thread */
+		SDL_Surface *target;
+		int code;
+		Uint32 id;
+
+		private:
+			State(const State &copy);
+			State &operator =(const State &copy);
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_image class
+	 *
+	 * Decodes one file on a loader thread.
+	 */
+	class LoadTask : public MT::Task
+	{
+		public:
+			explicit LoadTask(ImageLoad &handle) : m_Handle(handle)
+			{
+			}
+
+			void Run()
+			{
+				ImageLoad::State *state = m_Handle.m_State;
+				SDL_Surface *surface = IMG_Load(state->file.c_str());
+				std::string error;
+
+				if(surface != NULL && state->convert != ConvertNone)
+				{
+					// The flags Private::DisplayFormat() converts with
+					Uint32 flags = SDL_SRCALPHA | SDL_RLEACCELOK;
+					if(state->convert == ConvertDisplay)
+						flags |= SDL_SRCCOLORKEY;
+
+					SDL_Surface *converted = NULL;
+					if(state->target)
+						converted = Private::ConvertSurface(surface, state->target->format,
+															SDL_SWSURFACE | (surface->flags & flags));
+					else
+						SDL_SetError("No video mode was set before Image::LoadAsync()");
+					SDL_FreeSurface(surface);
+					surface = converted;
+
+					if(surface != NULL && state->convert == ConvertDisplayPremultiplied)
+						Private::Premultiply(surface);
+				}
+
+				// SDL keeps the error per thread, so grab it here
+				if(surface == NULL)
+					error = SDL_GetError();
+
+				SDL_mutexP(state->mutex);
+				state->surface = surface;
+				state->error = error;
+				state->finished = true;
+				SDL_CondBroadcast(state->done);
+				SDL_mutexV(state->mutex);
+
+				SDL_Event event;
+				event.type = SDL_USEREVENT;
+				event.user.code = state->code;
+				event.user.data1 = reinterpret_cast<void *>(static_cast<size_t>(state->id));
+				event.user.data2 = NULL;
+				SDL_PushEvent(&event);
+			}
+		private:
+			// Holds a reference until the task is deleted
+			ImageLoad m_Handle;
+	};
+
+	/*!
+	 * \brief Private SDL4Cpp_image variables
+	 *
+	 * The loader pool is only started on the first LoadAsync().
+	 */
+	static MT::ThreadPool *s_LoaderPool = NULL;
+	static int s_LoaderThreads = 0;
+	static Uint32 s_LoaderID = 0;
+
+	ImageLoad::ImageLoad() : m_State(NULL)
+	{
+	}
+
+	ImageLoad::ImageLoad(State *state) : m_State(state)
+	{
+	}
+
+	ImageLoad::ImageLoad(const ImageLoad &copy) : m_State(copy.m_State)
+	{
+		if(m_State)
+		{
+			MT::Locker lock(m_State->mutex);
+			m_State->refs++;
+		}
+	}
+
+	ImageLoad::~ImageLoad()
+	{
+		Release();
+	}
+
+	ImageLoad &ImageLoad::operator =(const ImageLoad &copy)
+	{
+		if(m_State != copy.m_State)
+		{
+			Release();
+
+			m_State = copy.m_State;
+			if(m_State)
+			{
+				MT::Locker lock(m_State->mutex);
+				m_State->refs++;
+			}
+		}
+
+		return *this;
+	}
+
+	void ImageLoad::Release()
+	{
+		if(m_State == NULL)
+			return;
+
+		SDL_mutexP(m_State->mutex);
+		bool last = --m_State->refs == 0;
+		SDL_mutexV(m_State->mutex);
+
+		if(last)
+			delete m_State;
+
+		m_State = NULL;
+	}
+
+	bool ImageLoad::Valid()
+	{
+		return m_State != NULL;
+	}
+
+	bool ImageLoad::Ready()
+	{
+		if(m_State == NULL)
+			throw LogicError("ImageLoad not from Image::LoadAsync() in call to Ready()");
+
+		MT::Locker lock(m_State->mutex);
+
+		return m_State->finished;
+	}
+
+	bool ImageLoad::Wait()
+	{
+		if(m_State == NULL)
+			throw LogicError("ImageLoad not from Image::LoadAsync() in call to Wait()");
+
+		MT::Locker lock(m_State->mutex);
+
+		while(!m_State->finished)
+			SDL_CondWait(m_State->done, m_State->mutex);
+
+		return m_State->error.empty();
+	}
+
+	bool ImageLoad::Get(Image &image)
+	{
+		if(m_State == NULL)
+			throw LogicError("ImageLoad not from Image::LoadAsync() in call to Get()");
+
+		SDL_Surface *surface;
+		{
+			MT::Locker lock(m_State->mutex);
+
+			if(!m_State->finished || m_State->surface == NULL)
+				return false;
+
+			surface = m_State->surface;
+			m_State->surface = NULL;
+		}
+
+		// Surface::operator= frees whatever image had before
+		static_cast<Surface &>(image) = surface;
+
+		return true;
+	}
+
+	std::string ImageLoad::GetError()
+	{
+		if(m_State == NULL)
+			return "";
+
+		MT::Locker lock(m_State->mutex);
+
+		return m_State->error;
+	}
+
+	Uint32 ImageLoad::GetID()
+	{
+		if(m_State == NULL)
+			return 0;
+
+		return m_State->id;
+	}
+
 	Image::Image()
 	{
 	}
@@ -60,15 +313,140 @@ namespace SDL
 
 	bool Image::Load(SDL_RWops *src, int freesrc)
 	{
-		SDL_Surface *temp = IMG_Load_RW(src, freesrc);
+		bool loaded;
+
+		switch(DetectFormat(src))
+		{
+			case FormatBMP:
+				loaded = LoadBMP_RW(src);
+				break;
+			case FormatPNM:
+				loaded = LoadPNM_RW(src);
+				break;
+			case FormatXPM:
+				loaded = LoadXPM_RW(src);
+				break;
+			case FormatXCF:
+				loaded = LoadXCF_RW(src);
+				break;
+			case FormatPCX:
+				loaded = LoadPCX_RW(src);
+				break;
+			case FormatGIF:
+				loaded = LoadGIF_RW(src);
+				break;
+			case FormatJPG:
+				loaded = LoadJPG_RW(src);
+				break;
+			case FormatTIF:
+				loaded = LoadTIF_RW(src);
+				break;
+			case FormatPNG:
+				loaded = LoadPNG_RW(src);
+				break;
+			case FormatLBM:
+				loaded = LoadLBM_RW(src);
+				break;
+			default:
+			{
+				// Let SDL_image have a go, newer versions know more formats
+				SDL_Surface *temp = IMG_Load_RW(src, 0);
+
+				loaded = temp != NULL;
+				if(loaded)
+					m_Surface = temp;
+				break;
+			}
+		}
+
+		if(freesrc && src)
+			SDL_RWclose(src);
+
+		return loaded;
+	}
 
-		if(temp == NULL)
-			return false;
-		else
-			m_Surface = temp;
+	Image::Format Image::DetectFormat(RWops &src)
+	{
+		return DetectFormat(src.Get());
+	}
 
-		return true;
+	Image::Format Image::DetectFormat(SDL_RWops *src)
+	{
+		if(src == NULL)
+			return FormatUnknown;
+
+		Uint8 magic[16] = { 0 };
+		int start = SDL_RWtell(src);
+		int size = SDL_RWread(src, magic, 1, sizeof(magic));
+		SDL_RWseek(src, start, RW_SEEK_SET);
+
+		if(size < 2)
+			return FormatUnknown;
 
+		// Same signatures as SDL_image's IMG_isXXX() functions
+		if(magic[0] == 'B' && magic[1] == 'M')
+			return FormatBMP;
+
+		if(magic[0] == 0x89 && size >= 4 && memcmp(magic + 1, "PNG", 3) == 0)
+			return FormatPNG;
+
+		if(magic[0] == 0xFF && magic[1] == 0xD8)
+			return FormatJPG;
+
+		if(size >= 6 && (memcmp(magic, "GIF87a", 6) == 0 || memcmp(magic, "GIF89a", 6) == 0))
+			return FormatGIF;
+
+		if(size >= 4 && (memcmp(magic, "II*\0", 4) == 0 || memcmp(magic, "MM\0*", 4) == 0))
+			return FormatTIF;
+
+		if(size >= 3 && magic[0] == 'P' && magic[1] >= '1' && magic[1] <= '6' &&
+			isspace(magic[2]))
+			return FormatPNM;
+
+		if(size >= 9 && memcmp(magic, "/* XPM */", 9) == 0)
+			return FormatXPM;
+
+		if(size >= 9 && memcmp(magic, "gimp xcf ", 9) == 0)
+			return FormatXCF;
+
+		if(size >= 12 && memcmp(magic, "FORM", 4) == 0 &&
+			(memcmp(magic + 8, "PBM ", 4) == 0 || memcmp(magic + 8, "ILBM", 4) == 0))
+			return FormatLBM;
+
+		// ZSoft manufacturer byte, version 5 and RLE encoding
+		if(size >= 3 && magic[0] == 10 && magic[1] == 5 && magic[2] == 1)
+			return FormatPCX;
+
+		return FormatUnknown;
+	}
+
+	ImageLoad Image::LoadAsync(std::string file, Conversion convert, int code)
+	{
+		if(s_LoaderPool == NULL)
+			s_LoaderPool = new MT::ThreadPool(s_LoaderThreads);
+
+		// The video surface is only safe to look at from this thread
+		SDL_Surface *target = NULL;
+		if(convert != ConvertNone)
+			target = Private::DisplayTarget(convert != ConvertDisplay);
+
+		ImageLoad handle(new ImageLoad::State(file, convert, target, code, ++s_LoaderID));
+		s_LoaderPool->Add(new LoadTask(handle));
+
+		return handle;
+	}
+
+	void Image::SetLoaderThreads(int threads)
+	{
+		StopLoader();
+		s_LoaderThreads = threads;
+	}
+
+	void Image::StopLoader()
+	{
+		// The pool runs whatever is still queued before it goes away
+		delete s_LoaderPool;
+		s_LoaderPool = NULL;
 	}
 
 	int Image::InvertAlpha(int on)
@@ -30,21 +30,27 @@ void Extensions()
 	}
 }
 
-void DisplayTriangle(GLfloat angle)
+void DisplayTriangle(GLfloat angle, SDL::GL::Texture &texture)
 {
 	glClear(GL_COLOR_BUFFER_BIT);
 	glLoadIdentity();
 
 	glRotatef(angle, 0.0f, 0.0f, 1.0f);
 
+	texture.Bind();
+	glEnable(GL_TEXTURE_2D);
 	glBegin(GL_TRIANGLES);
 		glColor3f(1.0f, 0.0f, 0.0f);
+		glTexCoord2f(texture.GetMaxU(), texture.GetMaxV());
 		glVertex3f(0.5f,  -0.5f, 0.0f);
 		glColor3f(0.0f, 1.0f, 0.0f);
+		glTexCoord2f(texture.GetMaxU() / 2, 0.0f);
 		glVertex3f(0.0f, 0.5f, 0.0f);
 		glColor3f(0.0f, 0.0f, 1.0f);
+		glTexCoord2f(0.0f, texture.GetMaxV());
 		glVertex3f(-0.5f, -0.5f, 0.0f);
 	glEnd();
+	glDisable(GL_TEXTURE_2D);
 
 	SDL::GL::SwapBuffers();
 }
@@ -115,6 +121,19 @@ int main(int argv, char *args[])
 	Extensions();
 	std::cout  << "---------------------------------" << std::endl;
 
+	// Look up some functions once, after that they come from SDL4Cpp's table
+	const char *procs[] = { "glGenTextures", "glBindTexture", "glTexSubImage2D", NULL };
+	std::cout << "Core functions found: " << SDL::GL::LoadProcs(procs) << std::endl;
+
+	typedef const GLubyte *(APIENTRY *GetString)(GLenum);
+	GetString getstring = SDL::GL::GetProc<GetString>("glGetString");
+	if(getstring)
+		std::cout << "GL_VERSION through GetProc: " << getstring(GL_VERSION) << std::endl;
+
+	int doublebuffer = 0;
+	SDL::GL::GetAttribute(SDL_GL_DOUBLEBUFFER, doublebuffer);
+	std::cout << "Double buffered: " << doublebuffer << std::endl;
+
 	// Couple more
 	try
 	{
@@ -138,10 +157,18 @@ int main(int argv, char *args[])
 				<< e.what() << std::endl;
 	}
 
+	// A surface streamed into two textures, with only the column that
+	// changed sent each frame
+	SDL::Surface canvas(64, 64, 32);
+	SDL::Rect all = canvas.GetRect();
+	canvas.FillRect(all, 0xFFFFFF);
+	SDL::GL::Texture texture;
+	texture.FromSurface(canvas, 2);
+
 	// Ok, let's do a little bit of OpenGL fun
 	// How about a rotating triangle (ok, not as fun, but it'll
 	// give beginers an idea how to do it.
-	int now, ticks = 0;
+	int now, ticks = 0, column = 0;
 	GLfloat angle = 0;
 	while(!handler)
 	{
@@ -152,7 +179,13 @@ int main(int argv, char *args[])
 		ticks = now;
 
 		events.Poll(handler);
-		DisplayTriangle(angle);
+
+		SDL::Rect dirty(column % 64, 0, 1, 64);
+		canvas.FillRect(dirty, (column / 64) % 2 ? 0xFFFFFF : 0x404040);
+		texture.Update(canvas, dirty);
+		column++;
+
+		DisplayTriangle(angle, texture);
 		angle += 0.2f;
 	}
 
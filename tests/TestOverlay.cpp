@@ -0,0 +1,124 @@
+/*
+ * This is a demo to time YUV overlay playback. Without a hardware overlay
+ * SDL4Cpp converts the frames itself, so by default it runs under the
+ * dummy driver and prints the frame rate of a 640x480 YV12 and YUY2 video
+ * shown 1:1 and stretched, with nearest and bilinear scaling. Set
+ * SDL_VIDEODRIVER to watch it on a real display.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include "SDL4Cpp.h"
+
+/*
+ * Fill frame with moving color bars, the way a decoder would fill it.
+ */
+void FillFrame(SDL::Overlay &overlay, int frame)
+{
+	overlay.Lock();
+	SDL_Overlay *o = overlay.Get();
+
+	if(o->format == SDL_YV12_OVERLAY)
+	{
+		for(int y = 0; y < o->h; y++)
+		{
+			Uint8 *luma = o->pixels[0] + y * o->pitches[0];
+			for(int x = 0; x < o->w; x++)
+				luma[x] = static_cast<Uint8>(16 + (x + y + frame * 4) % 220);
+		}
+
+		// YV12 has V before U
+		for(int y = 0; y < o->h / 2; y++)
+		{
+			Uint8 *v = o->pixels[1] + y * o->pitches[1];
+			Uint8 *u = o->pixels[2] + y * o->pitches[2];
+			for(int x = 0; x < o->w / 2; x++)
+			{
+				u[x] = static_cast<Uint8>((x * 2 + frame) & 0xff);
+				v[x] = static_cast<Uint8>((y * 2 + frame) & 0xff);
+			}
+		}
+	}
+	else
+	{
+		// YUY2 is Y0 U Y1 V
+		for(int y = 0; y < o->h; y++)
+		{
+			Uint8 *p = o->pixels[0] + y * o->pitches[0];
+			for(int x = 0; x < o->w; x += 2, p += 4)
+			{
+				p[0] = static_cast<Uint8>(16 + (x + y + frame * 4) % 220);
+				p[1] = static_cast<Uint8>((x + frame) & 0xff);
+				p[2] = static_cast<Uint8>(16 + (x + 1 + y + frame * 4) % 220);
+				p[3] = static_cast<Uint8>((y * 2 + frame) & 0xff);
+			}
+		}
+	}
+
+	overlay.Unlock();
+}
+
+int main(int argv, char *args[])
+{
+	// The dummy driver has no hardware overlays, so SDL4Cpp converts
+	if(getenv("SDL_VIDEODRIVER") == NULL)
+		SDL_putenv(const_cast<char *>("SDL_VIDEODRIVER=dummy"));
+
+	SDL::Init(SDL_INIT_VIDEO);
+	atexit(SDL::Quit);
+
+	SDL::Screen screen;
+	if(!screen.SetVideoMode(800, 600, 32))
+	{
+		std::cerr << "Failed: " << SDL::GetError() << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	Uint32 formats[] = { SDL_YV12_OVERLAY, SDL_YUY2_OVERLAY };
+	const char *names[] = { "YV12", "YUY2" };
+	SDL::Filter filters[] = { SDL::FilterNearest, SDL::FilterBilinear };
+	const char *filternames[] = { "nearest", "bilinear" };
+
+	for(int f = 0; f < 2; f++)
+	{
+		SDL::Overlay overlay;
+		overlay.Create(640, 480, formats[f], screen.Get());
+		if(overlay.Get() == NULL)
+		{
+			std::cerr << "No " << names[f] << " overlay: " << SDL::GetError() << std::endl;
+			continue;
+		}
+
+		std::cout << names[f] << (overlay.Get()->hw_overlay ? " (hardware)" : " (SDL4Cpp)") << std::endl;
+
+		for(int i = 0; i < 3; i++)
+		{
+			// 1:1 doesn't scale, so it's only timed once
+			SDL::Filter filter = filters[i == 2 ? 1 : 0];
+			bool stretch = i != 0;
+			overlay.SetFilter(filter);
+
+			// Decoding isn't being timed, so the frames are made up front
+			FillFrame(overlay, i);
+
+			const int frames = 200;
+			Uint32 start = SDL::GetTicks();
+			for(int frame = 0; frame < frames; frame++)
+			{
+				SDL::Rect rect = stretch ? SDL::Rect(0, 0, 800, 600) : SDL::Rect(80, 60, 640, 480);
+				if(!overlay.Display(rect))
+					std::cout << "Not displayed: " << SDL::GetError() << std::endl;
+			}
+
+			Uint32 elapsed = SDL::GetTicks() - start;
+			std::cout << "\t" << (stretch ? "800x600 " : "640x480 ") << (stretch ? filternames[i - 1] : "1:1")
+					<< ": ";
+			if(elapsed)
+				std::cout << frames * 1000 / elapsed << " frames per second" << std::endl;
+			else
+				std::cout << "too fast to time" << std::endl;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,84 @@
+/*
+ * This is a demo to show off palette cycling with an IndexedSurface.
+ * The palette is rotated every frame and only the changed entries get
+ * remapped before the blit to the screen.
+ */
+
+#include <iostream>
+#include "SDL4Cpp.h"
+
+int main(int argv, char *args[])
+{
+	SDL::Event events;
+
+	class Handler : public SDL::Handle
+	{
+		private:
+			bool m_Stop;
+		public:
+			Handler() : m_Stop(false) {}
+			bool KeyPressed(SDL::KeySym &keysym)
+			{
+				if(keysym.sym == SDLK_ESCAPE)
+					m_Stop = true;
+
+				return true;
+			}
+
+			operator bool() { return m_Stop; }
+	} handler;
+
+	SDL::Init(SDL_INIT_VIDEO);
+	atexit(SDL::Quit);
+
+	SDL::Screen screen;
+	if(!screen.SetVideoMode(640, 480, 32))
+	{
+		std::cerr << "Failed: " << SDL::GetError() << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	// A blue ramp in entries 0-127 for the water to cycle through, and a
+	// fixed gray ramp in 128-255 which should never move
+	SDL::Color colors[256];
+	for(int i = 0; i < 128; i++)
+	{
+		colors[i].r = 0;
+		colors[i].g = i;
+		colors[i].b = 128 + i;
+		colors[128 + i].r = colors[128 + i].g = colors[128 + i].b = i * 2;
+	}
+
+	SDL::IndexedSurface water(640, 480);
+	water.SetColors(colors[0], 0, 256);
+
+	water.Lock();
+	SDL_Surface *surface = water.Get();
+	for(int y = 0; y < surface->h; y++)
+	{
+		Uint8 *row = static_cast<Uint8 *>(surface->pixels) + y * surface->pitch;
+		for(int x = 0; x < surface->w; x++)
+			row[x] = y < 400 ? (x + y) % 128 : 128 + x % 128;
+	}
+	water.Unlock();
+
+	Uint32 start = SDL::GetTicks();
+	int frames = 0;
+	while(!handler)
+	{
+		water.RotateColors(0, 128, 1);
+		if(!water.BlitTo(screen))
+			std::cout << "Not blitted: " << SDL::GetError() << std::endl;
+
+		screen.Flip();
+		frames++;
+
+		events.Poll(handler);
+	}
+
+	Uint32 elapsed = SDL::GetTicks() - start;
+	if(elapsed)
+		std::cout << frames * 1000 / elapsed << " frames per second" << std::endl;
+
+	return 0;
+}
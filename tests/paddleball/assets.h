@@ -0,0 +1,9 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <SDL4Cpp.h>
+
+// the images used by the game, so each bitmap is only loaded once
+SDL::AssetCache &Assets();
+
+#endif
@@ -1,10 +1,11 @@
 #include <iostream>
+#include "assets.h"
 #include "ball.h"
 
 // load the paddle image and setup the ball if called
 Ball::Ball()
 {
-	if(!m_Ball.LoadBMP("ball.bmp"))
+	if(!Assets().Load("ball.bmp", m_Ball, SDL::ConvertDisplay))
 	{
 		std::cerr << "Encountered the following error: " << SDL::GetError() << std::endl;
 		exit(1);
@@ -13,7 +14,7 @@ Ball::Ball()
 
 Ball::Ball(int x, int y, int w, int h, int vx, int vy)
 {
-	if(!m_Ball.LoadBMP("ball.bmp"))
+	if(!Assets().Load("ball.bmp", m_Ball, SDL::ConvertDisplay))
 	{
 		std::cerr << "Encountered the following error: " << SDL::GetError() << std::endl;
 		exit(1);
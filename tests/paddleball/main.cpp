@@ -1,5 +1,6 @@
 #include <iostream>
 #include <ctime>
+#include "assets.h"
 #include "ball.h"
 #include "paddle.h"
 #include "computer.h"
@@ -50,6 +51,12 @@ class HandleInput : public SDL::Handle
 		bool m_Quit;
 };
 
+SDL::AssetCache &Assets()
+{
+	static SDL::AssetCache assets;
+	return assets;
+}
+
 void Setup()
 {
 	SDL::Screen screen;
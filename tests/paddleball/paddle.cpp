@@ -1,11 +1,12 @@
 #include <iostream>
 #include <stdexcept>
+#include "assets.h"
 #include "paddle.h"
 
 // sets the default paddle
 Paddle::Paddle()
 {
-	if(!m_Paddle.LoadBMP("paddle.bmp"))
+	if(!Assets().Load("paddle.bmp", m_Paddle, SDL::ConvertDisplay))
 	{
 		std::cerr <<  "Encountered the following error: " << SDL::GetError() << std::endl;
 		exit(1);
@@ -16,7 +17,7 @@ Paddle::Paddle()
 // set the default paddle with a movement
 Paddle::Paddle(int x, int y, int w, int h)
 {
-	if(!m_Paddle.LoadBMP("paddle.bmp"))
+	if(!Assets().Load("paddle.bmp", m_Paddle, SDL::ConvertDisplay))
 	{
 		std::cerr <<  "Encountered the following error: " << SDL::GetError() << std::endl;
 		exit(1);
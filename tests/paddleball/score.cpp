@@ -1,4 +1,5 @@
 #include <iostream>
+#include "assets.h"
 #include "score.h"
 
 Score::Score()
@@ -121,7 +122,7 @@ void Score::Draw(SDL::Screen &screen, SDL::Rect &one, SDL::Rect &two)
 void Score::LoadNumbers()
 {
 	// load the bitmap or exit on error
-	if(!m_Numbers.LoadBMP("numbers.bmp"))
+	if(!Assets().Load("numbers.bmp", m_Numbers, SDL::ConvertDisplay))
 	{
 		std::cerr << "Encountered the following error: " << SDL::GetError() << std::endl;
 		exit(1);
@@ -0,0 +1,181 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with main.c; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+/*
+ * sdl4cpp-pack builds a SurfacePack out of image files, converting each one
+ * to the pixel format the game will use so loading the pack needs no work.
+ *
+ * Usage: sdl4cpp-pack [-c] [-d] [-f format] output.pack image...
+ *
+ *   -c         LZ4 compress the surfaces
+ *   -d         dither colors when the format has fewer bits than the image
+ *   -f format  pixel format to store, one of argb8888 (default), abgr8888,
+ *              xrgb8888, rgb888, rgb565 or rgb555
+ *
+ * Each surface is named after its file, without the directory or extension.
+ */
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "SDL4Cpp.h"
+#ifdef HAVE_SDL_IMAGE
+#include "SDL4Cpp_image.h"
+#endif
+
+struct Format
+{
+	const char *name;
+	int bpp;
+	Uint32 Rmask, Gmask, Bmask, Amask;
+};
+
+// Masks are for the pixel as a native integer, like SDL's
+static const Format formats[] =
+{
+	{ "argb8888", 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000 },
+	{ "abgr8888", 32, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000 },
+	{ "xrgb8888", 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0 },
+	{ "rgb888", 24, 0xFF0000, 0x00FF00, 0x0000FF, 0 },
+	{ "rgb565", 16, 0xF800, 0x07E0, 0x001F, 0 },
+	{ "rgb555", 16, 0x7C00, 0x03E0, 0x001F, 0 }
+};
+
+static void Usage()
+{
+	std::cerr << "Usage: sdl4cpp-pack [-c] [-d] [-f format] output.pack image..." << std::endl
+		<< "Formats:";
+	for(unsigned int i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+		std::cerr << " " << formats[i].name;
+	std::cerr << std::endl;
+
+	exit(EXIT_FAILURE);
+}
+
+static std::string SurfaceName(std::string file)
+{
+	file = SDL::AssetCache::NormalizePath(file);
+
+	std::string::size_type slash = file.rfind('/');
+	if(slash != std::string::npos)
+		file.erase(0, slash + 1);
+
+	std::string::size_type dot = file.rfind('.');
+	if(dot != std::string::npos && dot != 0)
+		file.erase(dot);
+
+	return file;
+}
+
+static bool LoadFile(std::string file, SDL::Surface &surface)
+{
+#ifdef HAVE_SDL_IMAGE
+	SDL::Image image;
+	if(!image.Load(file))
+		return false;
+
+	surface = SDL_ConvertSurface(image.Get(), image.Get()->format, image.Get()->flags);
+	return true;
+#else
+	return surface.LoadBMP(file);
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+	bool compress = false;
+	bool dither = false;
+	const Format *format = &formats[0];
+	int arg = 1;
+
+	for(; arg < argc && argv[arg][0] == '-'; arg++)
+	{
+		if(strcmp(argv[arg], "-c") == 0)
+			compress = true;
+		else if(strcmp(argv[arg], "-d") == 0)
+			dither = true;
+		else if(strcmp(argv[arg], "-f") == 0 && arg + 1 < argc)
+		{
+			arg++;
+			format = NULL;
+			for(unsigned int i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+			{
+				if(strcmp(argv[arg], formats[i].name) == 0)
+					format = &formats[i];
+			}
+
+			if(format == NULL)
+				Usage();
+		}
+		else
+			Usage();
+	}
+
+	if(argc - arg < 2)
+		Usage();
+
+	std::string output = argv[arg++];
+
+	if(!SDL::Init(0))
+	{
+		std::cerr << "Failed: " << SDL::GetError() << std::endl;
+		return EXIT_FAILURE;
+	}
+	atexit(SDL::Quit);
+
+	// Only used for its pixel format
+	SDL::Surface target;
+	if(!target.CreateRGB(SDL_SWSURFACE, 1, 1, format->bpp, format->Rmask,
+		format->Gmask, format->Bmask, format->Amask))
+	{
+		std::cerr << "Failed: " << SDL::GetError() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	SDL::SurfacePackWriter writer;
+	for(; arg < argc; arg++)
+	{
+		SDL::Surface loaded;
+		if(!LoadFile(argv[arg], loaded))
+		{
+			std::cerr << argv[arg] << ": " << SDL::GetError() << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		SDL::Surface surface;
+		if(!surface.Convert(loaded, *target.Get()->format, SDL_SWSURFACE, dither))
+		{
+			std::cerr << argv[arg] << ": " << SDL::GetError() << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		if(!writer.Add(SurfaceName(argv[arg]), surface))
+		{
+			std::cerr << argv[arg] << ": " << SDL::GetError() << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	if(!writer.Save(output, compress))
+	{
+		std::cerr << "Failed: " << SDL::GetError() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cout << "Wrote " << writer.GetCount() << " surfaces to " << output << std::endl;
+
+	return EXIT_SUCCESS;
+}